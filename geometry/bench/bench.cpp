@@ -0,0 +1,334 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * Benchmark suite for the library hot paths.
+ *
+ * All workloads are synthetic and deterministic (fixed seeds, analytic
+ * surfaces), so numbers are comparable between runs and releases. Every
+ * benchmark prints one machine-readable line to stdout:
+ *
+ *     geometry-bench,<name>,<ops>,<ns-per-op>,<peak-rss-kb>
+ *
+ * Peak RSS is cumulative over the process, so only the growth between
+ * consecutive lines is attributable to a single benchmark. An optional
+ * positional argument scales the workload sizes (default 1).
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <sys/resource.h>
+
+#include <boost/filesystem.hpp>
+
+#include <math/math_all.hpp>
+
+#include <geometry/mesh.hpp>
+#include <geometry/meshop.hpp>
+#include <geometry/kdtree.hpp>
+#include <geometry/bvh.hpp>
+#include <geometry/binmesh.hpp>
+
+#ifdef GEOMETRY_HAS_OPENCV
+#  include <geometry/volume.hpp>
+#endif
+
+namespace fs = boost::filesystem;
+namespace ublas = boost::numeric::ublas;
+
+namespace {
+
+long peakRssKb()
+{
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/** Times a workload and emits the result line. The workload returns a
+ *  checksum which is accumulated globally so the compiler cannot drop
+ *  the measured computation.
+ */
+double checksum(0.0);
+
+template <typename Body>
+void benchmark(const std::string &name, std::size_t ops, const Body &body)
+{
+    const auto start(std::chrono::steady_clock::now());
+    checksum += body();
+    const auto stop(std::chrono::steady_clock::now());
+
+    const double ns(std::chrono::duration_cast<std::chrono::nanoseconds>
+                    (stop - start).count());
+
+    std::cout << "geometry-bench," << name << "," << ops << ","
+              << (ops ? ns / ops : ns) << "," << peakRssKb() << std::endl;
+}
+
+/** Regular grid over [0,1]^2 with an analytic height field; 2*n*n
+ *  faces, texture coordinates included.
+ */
+geometry::Mesh gridMesh(int n)
+{
+    geometry::Mesh mesh;
+    for (int j = 0; j <= n; j++) {
+        for (int i = 0; i <= n; i++) {
+            double x(double(i) / n), y(double(j) / n);
+            mesh.vertices.emplace_back
+                (x, y, 0.1 * std::sin(8 * x) * std::cos(8 * y));
+            mesh.tCoords.emplace_back(x, y);
+        }
+    }
+
+    for (int j = 0; j < n; j++) {
+        for (int i = 0; i < n; i++) {
+            int v00(j * (n + 1) + i), v10(v00 + 1);
+            int v01(v00 + n + 1), v11(v01 + 1);
+            mesh.addFace(v00, v10, v11, v00, v10, v11);
+            mesh.addFace(v00, v11, v01, v00, v11, v01);
+        }
+    }
+    return mesh;
+}
+
+math::Points3 randomCloud(std::size_t n)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    math::Points3 points;
+    points.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+        points.emplace_back(uniform(rng), uniform(rng), uniform(rng));
+    }
+    return points;
+}
+
+/** Triangle primitive for the Bvh benchmark (Moeller-Trumbore test). */
+struct BvhTriangle : geometry::BvhPrimitive {
+    math::Point3 a, b, c;
+
+    BvhTriangle() = default;
+    BvhTriangle(const math::Point3 &a, const math::Point3 &b
+                , const math::Point3 &c)
+        : a(a), b(b), c(c)
+    {}
+
+    math::Extents3 getBBox() const {
+        math::Extents3 bbox(a, a);
+        math::update(bbox, b);
+        math::update(bbox, c);
+        return bbox;
+    }
+
+    math::Point3 getCenter() const { return (a + b + c) / 3.0; }
+
+    bool getIntersection(const geometry::Ray &ray
+                         , geometry::IntersectionInfo &intersection) const
+    {
+        const math::Point3 e1(b - a), e2(c - a);
+        const math::Point3 p(math::crossProduct(ray.direction(), e2));
+        const double det(ublas::inner_prod(e1, p));
+        if (std::abs(det) < 1e-12) { return false; }
+
+        const double invDet(1.0 / det);
+        const math::Point3 t(ray.origin() - a);
+        const double u(ublas::inner_prod(t, p) * invDet);
+        if (u < 0.0 || u > 1.0) { return false; }
+
+        const math::Point3 q(math::crossProduct(t, e1));
+        const double v(ublas::inner_prod(ray.direction(), q) * invDet);
+        if (v < 0.0 || u + v > 1.0) { return false; }
+
+        intersection.t = ublas::inner_prod(e2, q) * invDet;
+        intersection.object = this;
+        return true;
+    }
+};
+
+#ifdef GEOMETRY_HAS_OPENCV
+
+typedef geometry::ScalarField_t
+    <float, geometry::VolumeArray<float>> ScalarField;
+
+/** Signed distance of a sphere sampled on an s^3 grid. */
+ScalarField sphereField(int s)
+{
+    ScalarField field(geometry::VolumeBase_t::FPosition_s(-1, -1, -1)
+                      , geometry::VolumeBase_t::FPosition_s(1, 1, 1)
+                      , 2.0 / s, 1.f);
+
+    const double step(2.0 / s);
+    for (int i = 0; i < field.container().sizeX(); i++) {
+        for (int j = 0; j < field.container().sizeY(); j++) {
+            for (int k = 0; k < field.container().sizeZ(); k++) {
+                double x(-1 + (i + 0.5) * step);
+                double y(-1 + (j + 0.5) * step);
+                double z(-1 + (k + 0.5) * step);
+                field.set(i, j, k
+                          , float(std::sqrt(x*x + y*y + z*z) - 0.7));
+            }
+        }
+    }
+    return field;
+}
+
+#endif // GEOMETRY_HAS_OPENCV
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int scale(1);
+    if (argc > 1) { scale = std::max(1, std::atoi(argv[1])); }
+
+    // mesh workloads
+    const int gridSize(256 * scale);
+    geometry::Mesh mesh(gridMesh(gridSize));
+    const std::size_t faceCount(mesh.faces.size());
+
+#ifdef GEOMETRY_HAS_OPENMESH
+    benchmark("mesh-simplify", faceCount, [&]() {
+        auto simplified(geometry::simplify(mesh, int(faceCount / 4)));
+        return double(simplified->faces.size());
+    });
+#endif
+
+    benchmark("mesh-clip", faceCount, [&]() {
+        math::Extents3 extents(math::Point3(0.25, 0.25, -1)
+                               , math::Point3(0.75, 0.75, 1));
+        auto clipped(geometry::clip(mesh, extents));
+        return double(clipped.faces.size());
+    });
+
+    // point cloud workloads
+    const std::size_t cloudSize(1000000 * std::size_t(scale));
+    math::Points3 cloud(randomCloud(cloudSize));
+
+    {
+        // build once outside so the query benchmark can reuse it
+        geometry::KdTree<math::Point3> *kdtree(nullptr);
+
+        benchmark("kdtree-build", cloudSize, [&]() {
+            kdtree = new geometry::KdTree<math::Point3>
+                (cloud.begin(), cloud.end());
+            return double(kdtree->size());
+        });
+
+        const std::size_t queries(100000 * std::size_t(scale));
+        benchmark("kdtree-nearest", queries, [&]() {
+            double sum(0);
+            for (std::size_t i = 0; i < queries; i++) {
+                double dist2(0);
+                kdtree->nearest(cloud[i % cloudSize], dist2);
+                sum += dist2;
+            }
+            return sum;
+        });
+
+        delete kdtree;
+    }
+
+    {
+        geometry::Bvh<BvhTriangle> bvh(4);
+
+        benchmark("bvh-build", faceCount, [&]() {
+            std::vector<BvhTriangle> triangles;
+            triangles.reserve(faceCount);
+            for (const auto &face : mesh.faces) {
+                triangles.emplace_back(mesh.vertices[face.a]
+                                       , mesh.vertices[face.b]
+                                       , mesh.vertices[face.c]);
+            }
+            bvh.build(std::move(triangles));
+            return double(faceCount);
+        });
+
+        const std::size_t rays(1000000 * std::size_t(scale));
+        benchmark("bvh-raycast", rays, [&]() {
+            std::mt19937 rng(1337);
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            double sum(0);
+            for (std::size_t i = 0; i < rays; i++) {
+                geometry::Ray ray(math::Point3(uniform(rng), uniform(rng), 1)
+                                  , math::Point3(0, 0, -1));
+                geometry::IntersectionInfo intersection;
+                if (bvh.getFirstIntersection(ray, intersection)) {
+                    sum += intersection.t;
+                }
+            }
+            return sum;
+        });
+    }
+
+    // serialization workloads
+    {
+        const fs::path dir(fs::temp_directory_path()
+                           / fs::unique_path("geometry-bench-%%%%%%%%"));
+        fs::create_directories(dir);
+
+        const fs::path objPath(dir / "bench.obj");
+        geometry::saveAsObj(mesh, objPath, geometry::ObjMaterial());
+
+        benchmark("obj-load", faceCount, [&]() {
+            auto loaded(geometry::loadObj(objPath));
+            return double(loaded.faces.size());
+        });
+
+        const fs::path binPath(dir / "bench.bin");
+        const geometry::Obj obj(geometry::asObj(mesh));
+
+        benchmark("binmesh-write", faceCount, [&]() {
+            geometry::writeBinaryMesh(binPath, obj);
+            return double(fs::file_size(binPath));
+        });
+
+        fs::remove_all(dir);
+    }
+
+    // volume workload
+#ifdef GEOMETRY_HAS_OPENCV
+    {
+        const int volumeSize(128 * scale);
+        ScalarField field(sphereField(volumeSize));
+        const std::size_t voxels(std::size_t(volumeSize) * volumeSize
+                                 * volumeSize);
+
+        benchmark("marching-cubes", voxels, [&]() {
+            auto isosurface(field.isosurfaceAsMesh(0.f));
+            return double(isosurface.faces.size());
+        });
+    }
+#endif
+
+    // keep the side effects alive
+    LOG(info1) << "Benchmark checksum: " << checksum;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2017 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * Memory-mapped loader for v4 (BinMeshFormat::mmappable) binary meshes.
+ * Layout description lives in binmesh.cpp next to the writer.
+ */
+
+#include <cstring>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+#include "error.hpp"
+#include "binmesh.hpp"
+
+namespace bio = boost::iostreams;
+
+namespace geometry {
+
+namespace {
+
+const char MAGIC[8] = {'B', 'I', 'N', '.', 'M', 'E', 'S', 'H'};
+const std::size_t V4_HEADER_SIZE = 80;
+
+std::uint32_t readUint32(const char *data)
+{
+    std::uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+double readDouble(const char *data)
+{
+    double value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+MappedBinaryMesh::MappedBinaryMesh(const boost::filesystem::path &path
+                                   , BinMeshInfo *meshInfo)
+{
+    auto file(std::make_shared<bio::mapped_file_source>(path.string()));
+    if (!file->is_open()) {
+        LOGTHROW(err1, std::runtime_error)
+            << "Cannot map binary mesh file " << path << ".";
+    }
+
+    const char *data(file->data());
+    const std::size_t size(file->size());
+
+    if ((size < V4_HEADER_SIZE)
+        || std::memcmp(data, MAGIC, sizeof(MAGIC)))
+    {
+        LOGTHROW(err1, BadFileFormat)
+            << "File " << path << " is not a binary mesh file.";
+    }
+
+    const auto version(readUint32(data + 8));
+    if (version != std::uint32_t(BinMeshFormat::mmappable)) {
+        LOGTHROW(err1, VersionError)
+            << "File " << path << " has version (" << version
+            << ") not loadable via memory mapping.";
+    }
+
+    for (int i = 0; i < 3; i++) {
+        bbox_.ll(i) = readDouble(data + 16 + 8 * i);
+        bbox_.ur(i) = readDouble(data + 40 + 8 * i);
+    }
+
+    vertexCount_ = readUint32(data + 64);
+    texCoordCount_ = readUint32(data + 68);
+    faceCount_ = readUint32(data + 72);
+
+    const std::size_t expected(V4_HEADER_SIZE
+                               + sizeof(VertexRecord) * vertexCount_
+                               + sizeof(TexCoordRecord) * texCoordCount_
+                               + sizeof(FaceRecord) * faceCount_);
+    if (size < expected) {
+        LOGTHROW(err1, BadFileFormat)
+            << "File " << path << " is truncated: " << size
+            << " bytes, expected " << expected << ".";
+    }
+
+    // views into the mapped pages; dequantization happens on access
+    const char *cursor(data + V4_HEADER_SIZE);
+    vertices_ = reinterpret_cast<const VertexRecord*>(cursor);
+    cursor += sizeof(VertexRecord) * vertexCount_;
+    texCoords_ = reinterpret_cast<const TexCoordRecord*>(cursor);
+    cursor += sizeof(TexCoordRecord) * texCoordCount_;
+    faces_ = reinterpret_cast<const FaceRecord*>(cursor);
+
+    if (meshInfo) {
+        meshInfo->bbox = bbox_;
+        meshInfo->vertexCount = vertexCount_;
+        meshInfo->faceCount = faceCount_;
+        meshInfo->texCoordCount = texCoordCount_;
+    }
+
+    storage_ = std::move(file);
+}
+
+} // namespace geometry
@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <sstream>
+
+#include "utility/binaryio.hpp"
+
+#include "binmesh.hpp"
+#include "zstd-blocks.hpp"
+
+namespace geometry {
+
+void writeCompressedBinaryMesh(const boost::filesystem::path &path,
+                               const geometry::Obj &mesh
+                               , BinMeshFormat format
+                               , bool gpuOptimize
+                               , const PackedMeshOptions &packedOptions
+                               , const ZstdBlocksOptions &zstdOptions)
+{
+    // serialize into memory first; binary meshes are small and the
+    // worker pool wants the whole buffer anyway
+    std::ostringstream os;
+    writeBinaryMesh(os, mesh, format, gpuOptimize, packedOptions);
+    const auto data(os.str());
+
+    utility::ofstreambuf f(path.string());
+    writeZstdBlocks(f, data.data(), data.size(), zstdOptions);
+    f.close();
+}
+
+} // namespace geometry
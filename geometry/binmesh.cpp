@@ -23,10 +23,17 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <vector>
+
 #include "utility/binaryio.hpp"
 
 #include "error.hpp"
 #include "binmesh.hpp"
+#include "perfcounters.hpp"
+#include "forsyth.hpp"
 
 namespace bin = utility::binaryio;
 
@@ -37,6 +44,44 @@ namespace {
 const char MAGIC[8] = {'B', 'I', 'N', '.', 'M', 'E', 'S', 'H'};
 const unsigned VERSION = 1;
 
+/** v2 (BinMeshFormat::packed) layout, all offsets from file start:
+ *
+ *      0  char[8]   magic
+ *      8  uint32    version (2)
+ *     12  uint32    flags; low byte = tCoord bits per component (8/16)
+ *     16  double[6] bbox (ll, ur)
+ *     64  uint32    vertex count
+ *     68  uint32    texture coordinate count
+ *     72  uint32    face count
+ *     76  uint32    reserved (0)
+ *     80  uint16[3 * vertexCount]   quantized vertices
+ *      .  tCoords, tcBits per component (uint8 or uint16)
+ *      .  faces: 3 vertex + 3 tCoord indices per face, each index
+ *         zigzag-varint delta against the previous index of its kind
+ *
+ * The 80-byte header prefix (magic, version, bbox, counts) is shared
+ * with v4 so both formats are measurable with a single small read.
+ */
+
+/** v4 (BinMeshFormat::mmappable) layout, all offsets from file start:
+ *
+ *      0  char[8]   magic
+ *      8  uint32    version (4)
+ *     12  uint32    reserved (0)
+ *     16  double[6] bbox (ll, ur)
+ *     64  uint32    vertex count
+ *     68  uint32    texture coordinate count
+ *     72  uint32    face count
+ *     76  uint32    reserved (0)
+ *     80  VertexRecord[vertexCount]      8 bytes each, 8-aligned
+ *      .  TexCoordRecord[texCoordCount]  4 bytes each
+ *      .  FaceRecord[faceCount]          12 bytes each
+ *
+ * Records match MappedBinaryMesh::{Vertex,TexCoord,Face}Record so a mapped
+ * file can be used in place. FaceRecord indices are 16-bit, capping the
+ * format at 65535 elements per block; the writer refuses larger meshes.
+ */
+
 } // namespace
 
 void writeBinaryMesh(std::ostream &f, const geometry::Obj &mesh)
@@ -104,6 +149,472 @@ void writeBinaryMesh(const boost::filesystem::path &path,
     f.close();
 }
 
+namespace {
+
+void writeVarint(std::ostream &f, std::uint32_t value)
+{
+    while (value >= 0x80) {
+        bin::write(f, std::uint8_t((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    bin::write(f, std::uint8_t(value));
+}
+
+std::uint32_t readVarint(std::istream &f)
+{
+    std::uint32_t value(0);
+    for (int shift = 0; shift < 32; shift += 7) {
+        std::uint8_t byte;
+        bin::read(f, byte);
+        value |= std::uint32_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) { break; }
+    }
+    return value;
+}
+
+std::uint32_t zigzag(std::int32_t value)
+{
+    return (std::uint32_t(value) << 1) ^ std::uint32_t(value >> 31);
+}
+
+std::int32_t unzigzag(std::uint32_t value)
+{
+    return std::int32_t(value >> 1) ^ -std::int32_t(value & 1);
+}
+
+void writeBinaryMeshV2(std::ostream &f, const geometry::Obj &mesh
+                       , const PackedMeshOptions &options)
+{
+    if ((options.tcBits != 8) && (options.tcBits != 16)) {
+        LOGTHROW(err1, std::runtime_error)
+            << "Unsupported texture coordinate quantization ("
+            << options.tcBits << " bits).";
+    }
+
+    math::Extents3 bbox(INFINITY, INFINITY, INFINITY,
+                        -INFINITY, -INFINITY, -INFINITY);
+    for (const auto &v : mesh.vertices) {
+        update(bbox, v);
+    }
+
+    // write header
+    bin::write(f, MAGIC);
+    bin::write(f, uint32_t(BinMeshFormat::packed));
+    bin::write(f, uint32_t(options.tcBits));
+
+    for (int i = 0; i < 3; i++) {
+        bin::write(f, double(bbox.ll(i)));
+    }
+    for (int i = 0; i < 3; i++) {
+        bin::write(f, double(bbox.ur(i)));
+    }
+
+    const auto nv(mesh.vertices.size());
+    const auto ntv(mesh.texcoords.size());
+    const auto nf(mesh.facets.size());
+
+    // counts are uint32 and indices int32 zigzag deltas; anything the
+    // format cannot hold is an error, never a silent clamp
+    const auto limit(size_t(std::numeric_limits<std::int32_t>::max()));
+    if ((nv > limit) || (ntv > limit) || (nf > limit)) {
+        LOGTHROW(err1, std::runtime_error)
+            << "Mesh too large for the packed format: " << nv
+            << " vertices, " << ntv << " texture coordinates, " << nf
+            << " faces (limit is " << limit << " elements).";
+    }
+
+    bin::write(f, uint32_t(nv));
+    bin::write(f, uint32_t(ntv));
+    bin::write(f, uint32_t(nf));
+    bin::write(f, uint32_t(0));
+
+    // write vertices (as v1)
+    for (std::size_t i = 0; i < nv; i++) {
+        const auto &v(mesh.vertices[i]);
+        for (int j = 0; j < 3; j++) {
+            double coord = (v(j) - bbox.ll(j)) / (bbox.ur(j) - bbox.ll(j));
+            bin::write(f, uint16_t(round(coord * USHRT_MAX)));
+        }
+    }
+
+    // write texture coords at configured precision
+    const std::uint32_t tcMax((std::uint32_t(1) << options.tcBits) - 1);
+    for (std::size_t i = 0; i < ntv; i++) {
+        const auto &t(mesh.texcoords[i]);
+        for (int j = 0; j < 2; j++) {
+            const auto q(std::uint32_t(round(t(j) * tcMax)));
+            if (options.tcBits == 8) {
+                bin::write(f, uint8_t(q));
+            } else {
+                bin::write(f, uint16_t(q));
+            }
+        }
+    }
+
+    // write faces; indices as deltas against the previous index of the
+    // same kind (consecutive faces reference nearby elements, so the
+    // deltas are small and varints short)
+    std::int32_t prevV(0), prevT(0);
+    for (std::size_t i = 0; i < nf; i++) {
+        const auto &face(mesh.facets[i]);
+        for (int j = 0; j < 3; j++) {
+            writeVarint(f, zigzag(std::int32_t(face.v[j]) - prevV));
+            prevV = std::int32_t(face.v[j]);
+        }
+        for (int j = 0; j < 3; j++) {
+            writeVarint(f, zigzag(std::int32_t(face.t[j]) - prevT));
+            prevT = std::int32_t(face.t[j]);
+        }
+    }
+}
+
+geometry::Obj loadBinaryMeshV2(std::istream &f
+                               , const boost::filesystem::path &path
+                               , BinMeshInfo *meshInfo)
+{
+    uint32_t flags;
+    bin::read(f, flags);
+    const int tcBits(flags & 0xff);
+    if ((tcBits != 8) && (tcBits != 16)) {
+        LOGTHROW(err1, BadFileFormat)
+            << "File " << path << " has invalid texture coordinate"
+            " quantization (" << tcBits << " bits).";
+    }
+
+    math::Extents3 bbox;
+    for (int i = 0; i < 3; i++) {
+        bin::read(f, bbox.ll(i));
+    }
+    for (int i = 0; i < 3; i++) {
+        bin::read(f, bbox.ur(i));
+    }
+
+    uint32_t nv, ntv, nf, reserved;
+    bin::read(f, nv);
+    bin::read(f, ntv);
+    bin::read(f, nf);
+    bin::read(f, reserved);
+
+    geometry::Obj mesh;
+
+    // load vertices
+    mesh.vertices.reserve(nv);
+    for (uint32_t k = 0; k < nv; k++) {
+        math::Point3 vertex;
+        uint16_t coord;
+        for (int i = 0; i < 3; i++) {
+            bin::read(f, coord);
+            vertex(i) = bbox.ll(i)
+                + (double(coord) / USHRT_MAX) * (bbox.ur(i) - bbox.ll(i));
+        }
+        mesh.vertices.push_back(vertex);
+    }
+
+    // load texcoords
+    const std::uint32_t tcMax((std::uint32_t(1) << tcBits) - 1);
+    mesh.texcoords.reserve(ntv);
+    for (uint32_t k = 0; k < ntv; k++) {
+        double tc[2];
+        for (int i = 0; i < 2; i++) {
+            std::uint32_t q;
+            if (tcBits == 8) {
+                uint8_t v; bin::read(f, v); q = v;
+            } else {
+                uint16_t v; bin::read(f, v); q = v;
+            }
+            tc[i] = double(q) / tcMax;
+        }
+        mesh.texcoords.emplace_back(tc[0], tc[1], 0.0);
+    }
+
+    // load faces (delta streams, see writeBinaryMeshV2)
+    std::int32_t prevV(0), prevT(0);
+    mesh.facets.reserve(nf);
+    for (uint32_t k = 0; k < nf; k++) {
+        geometry::Obj::Facet face;
+        for (int i = 0; i < 3; i++) {
+            prevV += unzigzag(readVarint(f));
+            face.v[i] = prevV;
+        }
+        for (int i = 0; i < 3; i++) {
+            prevT += unzigzag(readVarint(f));
+            face.t[i] = prevT;
+        }
+        mesh.facets.push_back(face);
+    }
+
+    if (meshInfo) {
+        meshInfo->bbox = bbox;
+        meshInfo->vertexCount = mesh.vertices.size();
+        meshInfo->faceCount = mesh.facets.size();
+        meshInfo->texCoordCount = mesh.texcoords.size();
+    }
+
+    return mesh;
+}
+
+void writeBinaryMeshV4(std::ostream &f, const geometry::Obj &mesh)
+{
+    math::Extents3 bbox(INFINITY, INFINITY, INFINITY,
+                        -INFINITY, -INFINITY, -INFINITY);
+    for (const auto &v : mesh.vertices) {
+        update(bbox, v);
+    }
+
+    // write header
+    bin::write(f, MAGIC);
+    bin::write(f, uint32_t(BinMeshFormat::mmappable));
+    bin::write(f, uint32_t(0));
+
+    for (int i = 0; i < 3; i++) {
+        bin::write(f, double(bbox.ll(i)));
+    }
+    for (int i = 0; i < 3; i++) {
+        bin::write(f, double(bbox.ur(i)));
+    }
+
+    const auto nv(mesh.vertices.size());
+    const auto ntv(mesh.texcoords.size());
+    const auto nf(mesh.facets.size());
+
+    // FaceRecord stores 16-bit indices; a mesh beyond that cannot be
+    // represented and must not be silently truncated
+    if ((nv > size_t(USHRT_MAX)) || (ntv > size_t(USHRT_MAX))
+        || (nf > size_t(USHRT_MAX)))
+    {
+        LOGTHROW(err1, std::runtime_error)
+            << "Mesh too large for the mmappable format: " << nv
+            << " vertices, " << ntv << " texture coordinates, " << nf
+            << " faces (limit is " << USHRT_MAX << " elements).";
+    }
+
+    bin::write(f, uint32_t(nv));
+    bin::write(f, uint32_t(ntv));
+    bin::write(f, uint32_t(nf));
+    bin::write(f, uint32_t(0));
+
+    // write vertex records (fixed stride, 8 bytes)
+    for (std::size_t i = 0; i < nv; i++) {
+        const auto &v(mesh.vertices[i]);
+        MappedBinaryMesh::VertexRecord rec;
+        uint16_t *out(&rec.x);
+        for (int j = 0; j < 3; j++) {
+            double coord = (v(j) - bbox.ll(j)) / (bbox.ur(j) - bbox.ll(j));
+            out[j] = uint16_t(round(coord * USHRT_MAX));
+        }
+        rec.padding = 0;
+        bin::write(f, rec);
+    }
+
+    // write texture coordinate records
+    for (std::size_t i = 0; i < ntv; i++) {
+        const auto &t(mesh.texcoords[i]);
+        MappedBinaryMesh::TexCoordRecord rec;
+        rec.u = uint16_t(round(t(0) * USHRT_MAX));
+        rec.v = uint16_t(round(t(1) * USHRT_MAX));
+        bin::write(f, rec);
+    }
+
+    // write face records
+    for (std::size_t i = 0; i < nf; i++) {
+        const auto &face(mesh.facets[i]);
+        MappedBinaryMesh::FaceRecord rec;
+        for (int j = 0; j < 3; j++) {
+            rec.v[j] = uint16_t(face.v[j]);
+            rec.t[j] = uint16_t(face.t[j]);
+        }
+        bin::write(f, rec);
+    }
+}
+
+} // namespace
+
+geometry::Obj optimizeForGpu(const geometry::Obj &mesh)
+{
+    const auto nf(mesh.facets.size());
+    if (!nf) { return mesh; }
+
+    // gather vertex indices for the optimizer
+    std::vector<std::uint32_t> indices(3 * nf);
+    for (std::size_t i = 0; i < nf; i++) {
+        for (int j = 0; j < 3; j++) {
+            indices[3 * i + j] = mesh.facets[i].v[j];
+        }
+    }
+
+    std::vector<int> triOrder(nf);
+    if (!forsythReorder(triOrder.data(), indices.data(), int(nf)
+                        , int(mesh.vertices.size())))
+    {
+        // optimizer bailed out (e.g. a vertex shared by too many
+        // triangles); keep the input ordering
+        return mesh;
+    }
+
+    // renumber elements in first-use order of the reordered faces
+    const auto invalid(std::numeric_limits<int>::max());
+    std::vector<int> vMap(mesh.vertices.size(), invalid);
+    std::vector<int> tMap(mesh.texcoords.size(), invalid);
+    std::vector<int> nMap(mesh.normals.size(), invalid);
+
+    geometry::Obj out;
+    out.vertices.reserve(mesh.vertices.size());
+    out.texcoords.reserve(mesh.texcoords.size());
+    out.normals.reserve(mesh.normals.size());
+    out.facets.reserve(nf);
+
+    auto remap([&](int index, std::vector<int> &map
+                   , const math::Points3d &src, math::Points3d &dst) -> int
+    {
+        if ((index < 0) || (index >= int(map.size()))) { return index; }
+        auto &mapped(map[index]);
+        if (mapped == invalid) {
+            mapped = int(dst.size());
+            dst.push_back(src[index]);
+        }
+        return mapped;
+    });
+
+    for (auto t : triOrder) {
+        auto face(mesh.facets[t]);
+        for (int j = 0; j < 3; j++) {
+            face.v[j] = remap(face.v[j], vMap, mesh.vertices, out.vertices);
+            face.t[j] = remap(face.t[j], tMap, mesh.texcoords
+                              , out.texcoords);
+            face.n[j] = remap(face.n[j], nMap, mesh.normals, out.normals);
+        }
+        out.facets.push_back(face);
+    }
+
+    // keep elements not referenced by any face at the end
+    for (std::size_t i = 0; i < vMap.size(); i++) {
+        if (vMap[i] == invalid) { out.vertices.push_back(mesh.vertices[i]); }
+    }
+    for (std::size_t i = 0; i < tMap.size(); i++) {
+        if (tMap[i] == invalid) {
+            out.texcoords.push_back(mesh.texcoords[i]);
+        }
+    }
+    for (std::size_t i = 0; i < nMap.size(); i++) {
+        if (nMap[i] == invalid) { out.normals.push_back(mesh.normals[i]); }
+    }
+
+    return out;
+}
+
+void writeBinaryMesh(std::ostream &f, const geometry::Obj &mesh
+                     , BinMeshFormat format, bool gpuOptimize
+                     , const PackedMeshOptions &packedOptions)
+{
+    if (gpuOptimize) {
+        const auto optimized(optimizeForGpu(mesh));
+        writeBinaryMesh(f, optimized, format, false, packedOptions);
+        return;
+    }
+
+    switch (format) {
+    case BinMeshFormat::compact:
+        writeBinaryMesh(f, mesh);
+        return;
+
+    case BinMeshFormat::packed:
+        writeBinaryMeshV2(f, mesh, packedOptions);
+        return;
+
+    case BinMeshFormat::mmappable:
+        writeBinaryMeshV4(f, mesh);
+        return;
+    }
+
+    LOGTHROW(err1, VersionError)
+        << "Unsupported binary mesh format ("
+        << static_cast<uint32_t>(format) << ").";
+}
+
+void writeBinaryMesh(const boost::filesystem::path &path,
+                     const geometry::Obj &mesh, BinMeshFormat format
+                     , bool gpuOptimize
+                     , const PackedMeshOptions &packedOptions)
+{
+    GEOMETRY_PERF_TIMER(perf::Timer::binmeshWrite);
+
+    utility::ofstreambuf f(path.string());
+    writeBinaryMesh(f, mesh, format, gpuOptimize, packedOptions);
+    GEOMETRY_PERF_ADD(perf::Counter::bytesWritten, std::uint64_t(f.tellp()));
+    f.close();
+}
+
+BinMeshInfo measureBinaryMesh(const boost::filesystem::path &path)
+{
+    utility::ifstreambuf f(path.string());
+
+    char magic[8];
+    uint32_t version;
+    bin::read(f, magic);
+
+    // compressed container? the shared fixed header fits in the first
+    // frame, no need to decompress the rest
+    std::istringstream decompressed;
+    std::istream *in(&f);
+    if (!std::memcmp(magic, ZSTD_BLOCKS_MAGIC, sizeof(magic))) {
+#ifdef GEOMETRY_HAS_BIO
+        f.seekg(0);
+        decompressed.str(readZstdBlocksPrefix(f, 80, path));
+        in = &decompressed;
+        bin::read(*in, magic);
+#else
+        LOGTHROW(err1, VersionError) << "File " << path
+            << " is zstd-compressed; compiled without Boost.IOStreams.";
+#endif
+    }
+
+    bin::read(*in, version);
+
+    if (std::memcmp(magic, MAGIC, sizeof(MAGIC))) {
+        LOGTHROW(err1, BadFileFormat)
+            << "File " << path << " is not a binary mesh file.";
+    }
+
+    // v1 has no fixed-offset counts -> full parse
+    if (version == VERSION) {
+        f.close();
+        BinMeshInfo info;
+        loadBinaryMesh(path, &info);
+        return info;
+    }
+
+    if ((version != uint32_t(BinMeshFormat::packed))
+        && (version != uint32_t(BinMeshFormat::mmappable)))
+    {
+        LOGTHROW(err1, VersionError) << "File " << path
+            << " has unsupported version (" << version << ").";
+    }
+
+    // shared fixed header: flags/reserved, bbox, counts
+    uint32_t flags;
+    bin::read(*in, flags);
+
+    BinMeshInfo info;
+    for (int i = 0; i < 3; i++) {
+        bin::read(*in, info.bbox.ll(i));
+    }
+    for (int i = 0; i < 3; i++) {
+        bin::read(*in, info.bbox.ur(i));
+    }
+
+    uint32_t nv, ntv, nf;
+    bin::read(*in, nv);
+    bin::read(*in, ntv);
+    bin::read(*in, nf);
+
+    info.vertexCount = nv;
+    info.texCoordCount = ntv;
+    info.faceCount = nf;
+
+    f.close();
+    return info;
+}
+
 geometry::Obj loadBinaryMesh(std::istream &f
                              , const boost::filesystem::path &path
                              , BinMeshInfo *meshInfo)
@@ -119,6 +630,13 @@ geometry::Obj loadBinaryMesh(std::istream &f
         LOGTHROW(err1, BadFileFormat)
                 << "File " << path << " is not a binary mesh file.";
     }
+    if (version == uint32_t(BinMeshFormat::packed)) {
+        return loadBinaryMeshV2(f, path, meshInfo);
+    }
+    if (version == uint32_t(BinMeshFormat::mmappable)) {
+        LOGTHROW(err1, VersionError) << "File " << path
+                << " is a mmappable (v4) mesh; use MappedBinaryMesh.";
+    }
     if (version > VERSION) {
         LOGTHROW(err1, VersionError) << "File " << path
                 << " has unsupported version (" << version << ").";
@@ -192,9 +710,54 @@ geometry::Obj loadBinaryMesh(const boost::filesystem::path &path
                              , BinMeshInfo *meshInfo)
 {
     utility::ifstreambuf f(path.string());
+
+    // compressed container? decompress and parse from memory
+    char magic[8];
+    bin::read(f, magic);
+    f.seekg(0);
+    if (!std::memcmp(magic, ZSTD_BLOCKS_MAGIC, sizeof(magic))) {
+#ifdef GEOMETRY_HAS_BIO
+        std::istringstream in(readZstdBlocks(f, path));
+        f.close();
+        return loadBinaryMesh(in, path, meshInfo);
+#else
+        LOGTHROW(err1, VersionError) << "File " << path
+            << " is zstd-compressed; compiled without Boost.IOStreams.";
+#endif
+    }
+
     auto mesh(loadBinaryMesh(f, path, meshInfo));
     f.close();
     return mesh;
 }
 
+geometry::Obj MappedBinaryMesh::obj() const
+{
+    geometry::Obj mesh;
+
+    mesh.vertices.reserve(vertexCount_);
+    for (std::size_t i = 0; i < vertexCount_; i++) {
+        mesh.vertices.push_back(vertex(i));
+    }
+
+    mesh.texcoords.reserve(texCoordCount_);
+    for (std::size_t i = 0; i < texCoordCount_; i++) {
+        const auto t(texCoord(i));
+        mesh.texcoords.emplace_back(t(0), t(1), 0.0);
+    }
+
+    mesh.facets.reserve(faceCount_);
+    for (std::size_t i = 0; i < faceCount_; i++) {
+        const auto &rec(faces_[i]);
+        geometry::Obj::Facet face;
+        for (int j = 0; j < 3; j++) {
+            face.v[j] = rec.v[j];
+            face.t[j] = rec.t[j];
+        }
+        mesh.facets.push_back(face);
+    }
+
+    return mesh;
+}
+
 } // namespace geometry
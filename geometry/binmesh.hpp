@@ -26,20 +26,91 @@
 #ifndef geometry_binmesh_hpp_included_
 #define geometry_binmesh_hpp_included_
 
+#include <cstdint>
 #include <iosfwd>
+#include <memory>
 
 #include <boost/filesystem/path.hpp>
 
+#include "utility/gccversion.hpp"
+
 #include "parse-obj.hpp"
+#include "zstd-blocks.hpp"
 
 namespace geometry {
 
+/** On-disk binary mesh flavors.
+ */
+enum class BinMeshFormat : std::uint32_t {
+    /** v1: tightly packed elements; loaded element by element. */
+    compact = 1
+
+    /** v2: fixed 80-byte header (counts readable without parsing),
+     *  configurable texture coordinate quantization, delta-encoded
+     *  varint-packed face indices. Smallest on the wire. */
+    , packed = 2
+
+    /** v4: fixed-stride, 8-byte-aligned vertex/face blocks; loadable via
+     *  MappedBinaryMesh without touching element data. */
+    , mmappable = 4
+};
+
+/** Tuning knobs for BinMeshFormat::packed.
+ */
+struct PackedMeshOptions {
+    /** Texture coordinate quantization, bits per component; 8 or 16.
+     */
+    int tcBits;
+
+    PackedMeshOptions() : tcBits(16) {}
+};
+
 //! Writes an OBJ mesh in a compact binary format.
 void writeBinaryMesh(const boost::filesystem::path &path,
                      const geometry::Obj &mesh);
 
 void writeBinaryMesh(std::ostream &out, const geometry::Obj &mesh);
 
+//! Writes an OBJ mesh in given binary format version. When gpuOptimize
+//! is set the mesh is passed through optimizeForGpu() first. The
+//! packed options apply to BinMeshFormat::packed only.
+void writeBinaryMesh(const boost::filesystem::path &path,
+                     const geometry::Obj &mesh, BinMeshFormat format
+                     , bool gpuOptimize = false
+                     , const PackedMeshOptions &packedOptions
+                     = PackedMeshOptions());
+
+void writeBinaryMesh(std::ostream &out, const geometry::Obj &mesh
+                     , BinMeshFormat format, bool gpuOptimize = false
+                     , const PackedMeshOptions &packedOptions
+                     = PackedMeshOptions());
+
+/** Writes a binary mesh of given format wrapped in the zstd block
+ *  container (see zstd-blocks.hpp); blocks are compressed by a worker
+ *  pool. loadBinaryMesh() and measureBinaryMesh() detect the container
+ *  transparently, measuring decodes only the first frame.
+ */
+void writeCompressedBinaryMesh(const boost::filesystem::path &path,
+                               const geometry::Obj &mesh
+                               , BinMeshFormat format
+                               , bool gpuOptimize = false
+                               , const PackedMeshOptions &packedOptions
+                               = PackedMeshOptions()
+                               , const ZstdBlocksOptions &zstdOptions
+                               = ZstdBlocksOptions())
+#ifndef GEOMETRY_HAS_BIO
+    UTILITY_FUNCTION_ERROR("Compressed binary meshes are available only when compiled with Boost.IOStreams.")
+#endif
+    ;
+
+/** Reorders faces for vertex-cache coherence (Forsyth ordering) and then
+ *  renumbers vertices, texture coordinates and normals in first-use order
+ *  so a GPU fetches them roughly linearly. Geometry is identical, only
+ *  the ordering changes; elements not referenced by any face are kept at
+ *  the end. Returns the input unchanged if the optimizer bails out.
+ */
+geometry::Obj optimizeForGpu(const geometry::Obj &mesh);
+
 struct BinMeshInfo {
     math::Extents3 bbox;
     std::size_t vertexCount;
@@ -47,6 +118,13 @@ struct BinMeshInfo {
     std::size_t texCoordCount;
 };
 
+/** Reads BinMeshInfo (bbox + element counts) from the fixed 80-byte
+ *  header of a packed (v2) or mmappable (v4) binary mesh without
+ *  touching element data -- one small read per file. Falls back to a
+ *  full parse for v1 files, which have no fixed-offset header.
+ */
+BinMeshInfo measureBinaryMesh(const boost::filesystem::path &path);
+
 //! Loads an OBJ mesh from a compact binary format.
 geometry::Obj loadBinaryMesh(const boost::filesystem::path &path
                              , BinMeshInfo *meshInfo = nullptr);
@@ -60,6 +138,79 @@ geometry::Obj loadBinaryMesh(std::istream &in
                              = "unknown"
                              , BinMeshInfo *meshInfo = nullptr);
 
+/** Memory-mapped view of a v4 (BinMeshFormat::mmappable) binary mesh.
+ *
+ * The file is mapped read-only and the record accessors return pointers
+ * directly into the mapped pages: opening a mesh costs O(page faults), not
+ * O(elements). Coordinates stay quantized in the map and are dequantized
+ * lazily via vertex()/texCoord(), or in bulk via obj().
+ *
+ * The view (and anything pointing into it) is valid as long as this object
+ * lives.
+ */
+class MappedBinaryMesh {
+public:
+    MappedBinaryMesh(const boost::filesystem::path &path, BinMeshInfo
+                     *meshInfo = nullptr)
+#ifndef GEOMETRY_HAS_BIO
+    UTILITY_FUNCTION_ERROR("Memory-mapped binary meshes are available only when compiled with Boost.IOStreams.")
+#endif
+    ;
+
+    /** Quantized vertex, 8 bytes; coordinates normalized to bbox. */
+    struct VertexRecord { std::uint16_t x, y, z, padding; };
+
+    /** Quantized texture coordinate, 4 bytes. */
+    struct TexCoordRecord { std::uint16_t u, v; };
+
+    /** Face, 12 bytes: vertex and texture coordinate indices. Indices
+     *  are 16-bit, so the format holds at most 65535 elements per
+     *  block; the writer rejects larger meshes.
+     */
+    struct FaceRecord { std::uint16_t v[3]; std::uint16_t t[3]; };
+
+    const math::Extents3& bbox() const { return bbox_; }
+
+    std::size_t vertexCount() const { return vertexCount_; }
+    std::size_t texCoordCount() const { return texCoordCount_; }
+    std::size_t faceCount() const { return faceCount_; }
+
+    /** Raw record blocks; views into the mapped file. */
+    const VertexRecord* vertices() const { return vertices_; }
+    const TexCoordRecord* texCoords() const { return texCoords_; }
+    const FaceRecord* faces() const { return faces_; }
+
+    /** Dequantize single vertex. */
+    math::Point3 vertex(std::size_t i) const {
+        const auto &v(vertices_[i]);
+        return math::Point3
+            (bbox_.ll(0) + (double(v.x) / 0xffff) * (bbox_.ur(0) - bbox_.ll(0))
+             , bbox_.ll(1) + (double(v.y) / 0xffff) * (bbox_.ur(1) - bbox_.ll(1))
+             , bbox_.ll(2) + (double(v.z) / 0xffff) * (bbox_.ur(2) - bbox_.ll(2)));
+    }
+
+    /** Dequantize single texture coordinate. */
+    math::Point2 texCoord(std::size_t i) const {
+        const auto &t(texCoords_[i]);
+        return math::Point2(double(t.u) / 0xffff, double(t.v) / 0xffff);
+    }
+
+    /** Materialize the whole mesh (bulk dequantization). */
+    geometry::Obj obj() const;
+
+private:
+    math::Extents3 bbox_;
+    std::size_t vertexCount_ = 0;
+    std::size_t texCoordCount_ = 0;
+    std::size_t faceCount_ = 0;
+    const VertexRecord *vertices_ = nullptr;
+    const TexCoordRecord *texCoords_ = nullptr;
+    const FaceRecord *faces_ = nullptr;
+
+    /** Keeps the file mapping alive. */
+    std::shared_ptr<void> storage_;
+};
+
 } // namespace geometry
 
 #endif // geometry_binmesh_hpp_included_
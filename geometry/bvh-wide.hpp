@@ -0,0 +1,527 @@
+/**
+ * Copyright (c) 2019 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @file bvh-wide.hpp
+ *
+ * Wide (BVH4/BVH8) bounding volume hierarchy with vectorized box tests.
+ *
+ * WideBvh collapses the binary geometry::Bvh topology into nodes with up to
+ * Width children whose bounding boxes are stored transposed (one float array
+ * per box component). A traversal step then tests a single ray against all
+ * child boxes at once -- with SSE when available, otherwise with a tight
+ * scalar loop over the component arrays. Primitives keep the BvhPrimitive
+ * interface of geometry::Bvh, so existing users only swap the container.
+ */
+
+#ifndef bvh_wide_hpp_included_
+#define bvh_wide_hpp_included_
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "math/geometry.hpp"
+
+#include "bvh.hpp"
+
+#if defined(__SSE__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#  define GEOMETRY_BVH_WIDE_SSE 1
+#  include <xmmintrin.h>
+#endif
+
+namespace geometry {
+
+namespace detail {
+template <typename TBvhObject> struct BinaryBvhTopology;
+} // namespace detail
+
+/**
+ * @brief Wide bounding volume hierarchy (BVH4 by default, BVH8 with
+ *        Width == 8).
+ *
+ * TBvhObject has the same interface as for geometry::Bvh.
+ */
+template <typename TBvhObject, std::size_t Width = 4>
+class WideBvh : public boost::noncopyable {
+    static_assert(Width >= 2, "WideBvh needs at least two children per node");
+
+    /** Child slot encoding: >= 0 inner wide node index, < 0 leaf reference
+     *  (~value indexes leaves_), EMPTY_CHILD unused slot.
+     */
+    static constexpr std::int32_t EMPTY_CHILD
+        = std::numeric_limits<std::int32_t>::min();
+
+    struct WideNode {
+        /** Child boxes transposed: minX, minY, minZ, maxX, maxY, maxZ.
+         *  Unused slots hold an inverted box so every slab test fails.
+         */
+        std::array<std::array<float, Width>, 6> bounds;
+        std::array<std::int32_t, Width> children;
+    };
+
+    struct Leaf {
+        std::size_t start;
+        std::size_t objCnt;
+    };
+
+    const std::size_t leafSize_;
+    std::vector<TBvhObject> objects_;
+    std::vector<WideNode> nodes_;
+    std::vector<Leaf> leaves_;
+
+public:
+    explicit WideBvh(const std::size_t leafSize = 4)
+        : leafSize_(leafSize) {}
+
+    /// \brief Constructs the wide BVH from given set of objects.
+    ///
+    /// This erases previously stored objects.
+    void build(std::vector<TBvhObject>&& objects) {
+        // build a binary tree first, then collapse it to Width-ary nodes
+        detail::BinaryBvhTopology<TBvhObject> binary(leafSize_);
+        binary.build(std::move(objects));
+
+        objects_ = std::move(binary.objects);
+        nodes_.clear();
+        leaves_.clear();
+
+        if (binary.nodes.front().isLeaf()) {
+            // degenerate case: root itself is a leaf; wrap it in one node
+            WideNode &node(addNode());
+            setChild(node, 0, binary, 0);
+            return;
+        }
+
+        collapse(binary, 0);
+    }
+
+    /// \brief Finds the closest intersection of the ray.
+    ///
+    /// Returns true if an intersection has been found.
+    bool getFirstIntersection(const Ray& ray
+                              , IntersectionInfo& intersection) const {
+        intersection.t = INFINITY;
+        intersection.object = nullptr;
+
+        getIntersections(ray, [&intersection](IntersectionInfo& current) {
+            if (current.t < intersection.t) {
+                intersection = current;
+            }
+            return true;
+        });
+        return intersection.object != nullptr;
+    }
+
+    /// \brief Returns all intersections of the ray.
+    template<typename OutIter>
+    void getAllIntersections(const Ray& ray, OutIter iter) const {
+        getIntersections(ray, [&iter](IntersectionInfo& current) {
+            *iter = current;
+            ++iter;
+            return true;
+        });
+    }
+
+    /// \brief Returns true if the ray is occluded by some geometry
+    bool isOccluded(const Ray& ray) const {
+        bool occluded = false;
+        getIntersections(ray, [&occluded](IntersectionInfo&) {
+            occluded = true;
+            return false; // do not continue with traversal
+        });
+        return occluded;
+    }
+
+private:
+    WideNode& addNode() {
+        nodes_.emplace_back();
+        WideNode &node(nodes_.back());
+        for (std::size_t lane(0); lane < Width; ++lane) {
+            node.children[lane] = EMPTY_CHILD;
+            for (int c = 0; c < 3; ++c) {
+                node.bounds[c][lane] = INFINITY;
+                node.bounds[3 + c][lane] = -INFINITY;
+            }
+        }
+        return node;
+    }
+
+    void setBounds(WideNode &node, std::size_t lane
+                   , const math::Extents3 &bbox)
+    {
+        // conservative float rounding: never shrink the double box
+        for (int c = 0; c < 3; ++c) {
+            node.bounds[c][lane]
+                = std::nextafterf(float(bbox.ll(c)), -INFINITY);
+            node.bounds[3 + c][lane]
+                = std::nextafterf(float(bbox.ur(c)), INFINITY);
+        }
+    }
+
+    void setChild(WideNode &node, std::size_t lane
+                  , const detail::BinaryBvhTopology<TBvhObject> &binary
+                  , std::size_t binaryIdx)
+    {
+        const auto &bnode(binary.nodes[binaryIdx]);
+        setBounds(node, lane, bnode.bbox);
+
+        if (bnode.isLeaf()) {
+            node.children[lane] = ~std::int32_t(leaves_.size());
+            leaves_.push_back({ bnode.start, bnode.objCnt });
+            return;
+        }
+
+        // placeholder; fixed up by collapse() once the subtree node exists
+        const std::size_t nodeIdx(&node - nodes_.data());
+        const auto sub(collapse(binary, binaryIdx));
+        nodes_[nodeIdx].children[lane] = std::int32_t(sub);
+    }
+
+    /** Collapse binary subtree rooted at inner node binaryIdx into one wide
+     *  node (plus recursively its children); returns wide node index.
+     */
+    std::size_t collapse(const detail::BinaryBvhTopology<TBvhObject> &binary
+                         , std::size_t binaryIdx)
+    {
+        // gather up to Width binary descendants, always expanding the
+        // candidate with the most objects first
+        std::array<std::size_t, Width> slots;
+        std::size_t count(0);
+        slots[count++] = binaryIdx + 1;
+        slots[count++] = binaryIdx + binary.nodes[binaryIdx].rightOffset;
+
+        while (count < Width) {
+            std::size_t best(count);
+            std::size_t bestObjects(0);
+            for (std::size_t i(0); i < count; ++i) {
+                const auto &cand(binary.nodes[slots[i]]);
+                if (!cand.isLeaf() && (cand.objCnt > bestObjects)) {
+                    best = i;
+                    bestObjects = cand.objCnt;
+                }
+            }
+            if (best == count) { break; } // all candidates are leaves
+
+            const auto expand(slots[best]);
+            slots[best] = expand + 1;
+            slots[count++] = expand + binary.nodes[expand].rightOffset;
+        }
+
+        const std::size_t nodeIdx(nodes_.size());
+        addNode();
+        for (std::size_t i(0); i < count; ++i) {
+            setChild(nodes_[nodeIdx], i, binary, slots[i]);
+        }
+        return nodeIdx;
+    }
+
+    /** Slab test of one ray against all child boxes of a node. Returns hit
+     *  mask; t0[lane] holds the entry distance of hit lanes.
+     */
+    unsigned int intersectChildren(const WideNode &node
+                                   , const std::array<float, 3> &orig
+                                   , const std::array<float, 3> &invDir
+                                   , const std::array<int, 3> &signs
+                                   , float t0[Width]) const
+    {
+#if defined(GEOMETRY_BVH_WIDE_SSE)
+        if (Width == 4) {
+            __m128 tMin = _mm_set1_ps(-INFINITY);
+            __m128 tMax = _mm_set1_ps(INFINITY);
+            for (int c = 0; c < 3; ++c) {
+                const __m128 lo = _mm_loadu_ps
+                    (node.bounds[signs[c] ? 3 + c : c].data());
+                const __m128 hi = _mm_loadu_ps
+                    (node.bounds[signs[c] ? c : 3 + c].data());
+                const __m128 o = _mm_set1_ps(orig[c]);
+                const __m128 id = _mm_set1_ps(invDir[c]);
+                tMin = _mm_max_ps(tMin, _mm_mul_ps(_mm_sub_ps(lo, o), id));
+                tMax = _mm_min_ps(tMax, _mm_mul_ps(_mm_sub_ps(hi, o), id));
+            }
+            _mm_storeu_ps(t0, tMin);
+            const __m128 hit = _mm_and_ps
+                (_mm_cmple_ps(tMin, tMax)
+                 , _mm_cmpgt_ps(tMax, _mm_setzero_ps()));
+            return unsigned(_mm_movemask_ps(hit));
+        }
+#endif
+        unsigned int mask(0);
+        for (std::size_t lane(0); lane < Width; ++lane) {
+            float tMin(-INFINITY), tMax(INFINITY);
+            for (int c = 0; c < 3; ++c) {
+                const float lo(node.bounds[signs[c] ? 3 + c : c][lane]);
+                const float hi(node.bounds[signs[c] ? c : 3 + c][lane]);
+                tMin = std::max(tMin, (lo - orig[c]) * invDir[c]);
+                tMax = std::min(tMax, (hi - orig[c]) * invDir[c]);
+            }
+            t0[lane] = tMin;
+            if ((tMin <= tMax) && (tMax > 0.f)) { mask |= (1u << lane); }
+        }
+        return mask;
+    }
+
+    template <typename TAddIntersection>
+    void getIntersections(const Ray& ray
+                          , const TAddIntersection& addIntersection) const {
+        if (nodes_.empty()) { return; }
+
+        std::array<float, 3> orig, invDir;
+        std::array<int, 3> signs;
+        for (int c = 0; c < 3; ++c) {
+            orig[c] = float(ray.origin()(c));
+            const double d(ray.direction()(c));
+            invDir[c] = float((d == 0.) ? INFINITY : 1. / d);
+            signs[c] = int(invDir[c] < 0.f);
+        }
+
+        BvhStack<std::int32_t, 64 * Width> stack;
+        stack.pushBack(0); // add root
+
+        while (!stack.empty()) {
+            const std::int32_t ref = stack.top();
+            stack.popBack();
+
+            if (ref < 0) {
+                // leaf -> intersect stored objects
+                const Leaf &leaf(leaves_[~ref]);
+                for (std::size_t objIdx = 0; objIdx < leaf.objCnt; ++objIdx) {
+                    IntersectionInfo current;
+
+                    const TBvhObject& obj = objects_[leaf.start + objIdx];
+                    const bool hit = obj.getIntersection(ray, current);
+
+                    if (hit && current.t > 0.) {
+                        if (!addIntersection(current)) {
+                            // bailout
+                            return;
+                        }
+                    }
+                }
+                continue;
+            }
+
+            const WideNode &node(nodes_[ref]);
+            float t0[Width];
+            unsigned int mask(intersectChildren(node, orig, invDir
+                                                , signs, t0));
+
+            // push hit children sorted far-to-near so the near child is
+            // popped first
+            std::array<std::size_t, Width> hits;
+            std::size_t hitCnt(0);
+            for (std::size_t lane(0); lane < Width; ++lane) {
+                if (mask & (1u << lane)) { hits[hitCnt++] = lane; }
+            }
+            for (std::size_t i(1); i < hitCnt; ++i) {
+                const auto lane(hits[i]);
+                std::size_t j(i);
+                while (j && (t0[hits[j - 1]] < t0[lane])) {
+                    hits[j] = hits[j - 1];
+                    --j;
+                }
+                hits[j] = lane;
+            }
+            for (std::size_t i(0); i < hitCnt; ++i) {
+                stack.pushBack(node.children[hits[i]]);
+            }
+        }
+    }
+};
+
+namespace detail {
+
+/** Binary BVH build used as an intermediate stage for WideBvh; same
+ *  splitting strategy as geometry::Bvh::build().
+ */
+template <typename TBvhObject>
+struct BinaryBvhTopology {
+    struct Node {
+        math::Extents3 bbox;
+        std::size_t start;
+        std::size_t objCnt;
+        std::size_t rightOffset;
+
+        bool isLeaf() const { return rightOffset == 0; }
+        void setLeaf() { rightOffset = 0; }
+    };
+
+    const std::size_t leafSize;
+    std::vector<TBvhObject> objects;
+    std::vector<Node> nodes;
+
+    explicit BinaryBvhTopology(std::size_t leafSize) : leafSize(leafSize) {}
+
+    void build(std::vector<TBvhObject>&& input) {
+        objects = std::move(input);
+        assert(!objects.empty());
+
+        struct BuildEntry {
+            std::size_t parent;
+            std::size_t start;
+            std::size_t end;
+        };
+
+        BvhStack<BuildEntry, 128> stack;
+        constexpr std::size_t NO_PARENT_FLAG = std::size_t(-1);
+        constexpr std::size_t UNTOUCHED_FLAG = std::size_t(-1);
+
+        BuildEntry& rootEntry = stack.emplaceBack();
+        rootEntry.start = 0;
+        rootEntry.end = objects.size();
+        rootEntry.parent = NO_PARENT_FLAG;
+
+        nodes.clear();
+        nodes.reserve(2 * objects.size());
+        std::size_t nodeCnt(0);
+
+        while (!stack.empty()) {
+            const BuildEntry nodeEntry = stack.top();
+            stack.popBack();
+
+            const std::size_t start = nodeEntry.start;
+            const std::size_t end = nodeEntry.end;
+            const std::size_t objCnt = end - start;
+
+            nodeCnt++;
+            Node node;
+            node.start = start;
+            node.objCnt = objCnt;
+            node.rightOffset = UNTOUCHED_FLAG;
+
+            math::Extents3 bbox = objects[start].getBBox();
+            const math::Point3 center = objects[start].getCenter();
+            math::Extents3 boxCenter(center, center);
+            for (std::size_t i = start + 1; i < end; ++i) {
+                math::update(bbox, objects[i].getBBox());
+                math::update(boxCenter, objects[i].getCenter());
+            }
+            node.bbox = bbox;
+
+            if (objCnt <= leafSize) {
+                node.setLeaf();
+            }
+            nodes.push_back(node);
+
+            if (nodeEntry.parent != NO_PARENT_FLAG) {
+                nodes[nodeEntry.parent].rightOffset--;
+
+                if (nodes[nodeEntry.parent].rightOffset
+                    == UNTOUCHED_FLAG - 2) {
+                    nodes[nodeEntry.parent].rightOffset
+                        = nodeCnt - 1 - nodeEntry.parent;
+                }
+            }
+
+            if (node.isLeaf()) {
+                continue;
+            }
+
+            const std::size_t splitDim
+                = argMax(boxCenter.ur - boxCenter.ll);
+            const double split =
+                0.5 * (boxCenter.ll(splitDim) + boxCenter.ur(splitDim));
+
+            std::size_t mid = start;
+            for (std::size_t i = start; i < end; ++i) {
+                if (objects[i].getCenter()[splitDim] < split) {
+                    std::swap(objects[i], objects[mid]);
+                    ++mid;
+                }
+            }
+
+            if (mid == start || mid == end) {
+                mid = start + (end - start) / 2;
+            }
+
+            stack.pushBack({ nodeCnt - 1, mid, end });
+            stack.pushBack({ nodeCnt - 1, start, mid });
+        }
+    }
+
+    static int argMax(const math::Point3& v) {
+        int maxIdx = 0;
+        if (v(1) > v(maxIdx)) { maxIdx = 1; }
+        if (v(2) > v(maxIdx)) { maxIdx = 2; }
+        return maxIdx;
+    }
+};
+
+} // namespace detail
+
+/** Ready-made triangle primitive for (Wide)Bvh built over mesh faces.
+ *
+ *  Watertight enough for occlusion baking: Moller-Trumbore with branch-lean
+ *  arithmetic over locally cached coordinates.
+ */
+struct BvhTriangle : public BvhPrimitive {
+    math::Point3 a, e1, e2;
+
+    BvhTriangle() = default;
+
+    BvhTriangle(const math::Point3 &a, const math::Point3 &b
+                , const math::Point3 &c, std::size_t userData_
+                = std::size_t(-1))
+        : a(a), e1(b - a), e2(c - a)
+    {
+        userData = userData_;
+    }
+
+    bool getIntersection(const Ray &ray, IntersectionInfo &is) const {
+        const math::Point3 p(math::crossProduct(ray.direction(), e2));
+        const double det(boost::numeric::ublas::inner_prod(e1, p));
+        if (std::abs(det) < 1e-20) { return false; }
+
+        const double invDet(1. / det);
+        const math::Point3 t(ray.origin() - a);
+        const double u(boost::numeric::ublas::inner_prod(t, p) * invDet);
+        if ((u < 0.) || (u > 1.)) { return false; }
+
+        const math::Point3 q(math::crossProduct(t, e1));
+        const double v(boost::numeric::ublas::inner_prod
+                       (ray.direction(), q) * invDet);
+        if ((v < 0.) || (u + v > 1.)) { return false; }
+
+        is.t = boost::numeric::ublas::inner_prod(e2, q) * invDet;
+        is.object = this;
+        return is.t > 0.;
+    }
+
+    math::Extents3 getBBox() const {
+        math::Extents3 bbox(a, a);
+        math::update(bbox, math::Point3(a + e1));
+        math::update(bbox, math::Point3(a + e2));
+        return bbox;
+    }
+
+    math::Point3 getCenter() const {
+        return a + (e1 + e2) / 3.;
+    }
+};
+
+} // namespace geometry
+
+#endif
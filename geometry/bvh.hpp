@@ -34,7 +34,10 @@
 #define bvh_hpp_included_
 
 #include "math/geometry_core.hpp"
+#include <future>
+#include <memory>
 #include <set>
+#include <thread>
 
 namespace geometry {
 
@@ -190,6 +193,43 @@ private:
     }
 };
 
+/** Tag for Bvh::build marking input already sorted along a space
+ *  filling curve (see spatialsort.hpp). Nodes then split ranges at the
+ *  median instead of partitioning by centroid, which keeps the input
+ *  order and skips the per-node partition pass entirely.
+ */
+struct BvhPresorted {};
+
+/** Parallel build mode for Bvh::build. Node ranges are split with
+ *  binned SAH (surface area heuristic over fixed bins along the widest
+ *  centroid axis); subtree construction forks one asynchronous task
+ *  per subtree for the top log2(nThreads) levels and proceeds serially
+ *  below that, or once a subtree drops under a few thousand objects.
+ *
+ *  The build is deterministic (same input, same tree): an object's bin
+ *  is a pure function of the object, per-thread bin partials merge
+ *  with exact operations (box union, counts) in fixed chunk order and
+ *  the partition pass performs a fixed swap sequence.
+ *
+ *  nThreads == 0 means use all hardware threads.
+ */
+struct BvhParallel {
+    explicit BvhParallel(unsigned int nThreads = 0)
+        : nThreads(nThreads ? nThreads
+                   : std::max(1u, std::thread::hardware_concurrency()))
+    {}
+
+    /** Number of tree levels where subtree construction forks a task.
+     */
+    int splitDepth() const {
+        int depth(0);
+        for (unsigned int t(1); t < nThreads; t *= 2) { ++depth; }
+        return depth;
+    }
+
+    unsigned int nThreads;
+};
+
 /**
  * @brief Bounding volume hierarchy
  * @details TBvhObject must derive from \ref BvhPrimitive and implement the
@@ -235,6 +275,308 @@ public:
     ///
     /// This erased previously stored objects.
     void build(std::vector<TBvhObject>&& objects) {
+        buildTree(std::move(objects), false);
+    }
+
+    /// \brief Contructs the BVH from objects pre-sorted along a space
+    /// filling curve; see BvhPresorted.
+    void build(std::vector<TBvhObject>&& objects, const BvhPresorted&) {
+        buildTree(std::move(objects), true);
+    }
+
+    /// \brief Constructs the BVH in parallel with binned SAH splits;
+    /// see BvhParallel.
+    void build(std::vector<TBvhObject>&& objects, const BvhParallel& parallel) {
+        objects_ = std::move(objects);
+        assert(!objects_.empty());
+        nodeCnt_ = 0;
+        leafCnt_ = 0;
+
+        const auto root(buildNodeSah(0, objects_.size(), parallel
+                                     , parallel.splitDepth()));
+
+        // flatten into the traversal layout (left child adjacent,
+        // right child at rightOffset) in one deterministic depth-first
+        // pass; the pool is allocated upfront -- SAH never creates an
+        // empty child, so at most 2 * objects - 1 nodes exist
+        std::vector<BvhNode> buildNodes;
+        buildNodes.reserve(2 * objects_.size());
+        flatten(*root, buildNodes);
+        nodeCnt_ = buildNodes.size();
+        nodes_ = std::move(buildNodes);
+    }
+
+private:
+    /** Number of SAH bins per split. */
+    static constexpr int SAH_BINS = 16;
+
+    /** Subtrees smaller than this build serially even when task budget
+     *  remains; forking is not worth the latency. */
+    static constexpr std::size_t MIN_PARALLEL_OBJECTS = 4096;
+
+    /** Temporary node of the parallel build; turned into the flat
+     *  traversal layout by flatten().
+     */
+    struct BuildNode {
+        math::Extents3 bbox;
+        std::size_t start;
+        std::size_t objCnt;
+        std::unique_ptr<BuildNode> sons[2];
+
+        bool isLeaf() const { return !sons[0]; }
+    };
+
+    /** Per-bin partials of one binning pass: object bounds and
+     *  population. Merging is exact (component min/max, addition), so
+     *  partials combined in fixed chunk order reproduce the serial
+     *  pass bit for bit.
+     */
+    struct SahBins {
+        std::array<math::Extents3, SAH_BINS> bbox;
+        std::array<std::size_t, SAH_BINS> count;
+
+        SahBins() : count() {}
+
+        void add(const SahBins& o) {
+            for (int b = 0; b < SAH_BINS; ++b) {
+                if (!o.count[b]) { continue; }
+                if (count[b]) {
+                    math::update(bbox[b], o.bbox[b]);
+                } else {
+                    bbox[b] = o.bbox[b];
+                }
+                count[b] += o.count[b];
+            }
+        }
+    };
+
+    static double halfArea(const math::Extents3& e) {
+        const math::Point3 s(e.ur - e.ll);
+        return s(0) * s(1) + s(1) * s(2) + s(2) * s(0);
+    }
+
+    int binOf(const TBvhObject& object, const std::size_t splitDim
+              , const double origin, const double scale) const {
+        const int bin = int((object.getCenter()[splitDim] - origin) * scale);
+        return std::min(std::max(bin, 0), SAH_BINS - 1);
+    }
+
+    /** Bounds of objects in [start, end): geometry boxes for the node
+     *  box, centroid bounds for the split. Wide ranges fold per-thread
+     *  chunks merged in fixed chunk order (exact, see SahBins).
+     */
+    void objectBounds(const std::size_t start, const std::size_t end
+                      , const unsigned int nThreads
+                      , math::Extents3& bbox, math::Extents3& boxCenter) {
+        struct Partial {
+            math::Extents3 bbox;
+            math::Extents3 boxCenter;
+        };
+
+        const auto fold([&](std::size_t cs, std::size_t ce) -> Partial {
+            Partial p;
+            p.bbox = objects_[cs].getBBox();
+            const math::Point3 center = objects_[cs].getCenter();
+            p.boxCenter = math::Extents3(center, center);
+            for (std::size_t i = cs + 1; i < ce; ++i) {
+                math::update(p.bbox, objects_[i].getBBox());
+                math::update(p.boxCenter, objects_[i].getCenter());
+            }
+            return p;
+        });
+
+        const std::size_t objCnt = end - start;
+        if ((nThreads > 1) && (objCnt >= MIN_PARALLEL_OBJECTS)) {
+            const std::size_t chunk((objCnt + nThreads - 1) / nThreads);
+
+            std::vector<std::future<Partial>> partials;
+            for (std::size_t cs = start + chunk; cs < end; cs += chunk) {
+                partials.push_back(std::async(std::launch::async, fold
+                                              , cs, std::min(cs + chunk, end)));
+            }
+
+            // first chunk runs here, the rest merges in chunk order
+            Partial p(fold(start, std::min(start + chunk, end)));
+            for (auto& f : partials) {
+                const Partial o(f.get());
+                math::update(p.bbox, o.bbox);
+                math::update(p.boxCenter, o.boxCenter);
+            }
+            bbox = p.bbox;
+            boxCenter = p.boxCenter;
+            return;
+        }
+
+        const Partial p(fold(start, end));
+        bbox = p.bbox;
+        boxCenter = p.boxCenter;
+    }
+
+    /** Bins objects in [start, end) by centroid along splitDim; wide
+     *  ranges accumulate per-thread bins merged in fixed chunk order.
+     */
+    SahBins binObjects(const std::size_t start, const std::size_t end
+                       , const std::size_t splitDim
+                       , const double origin, const double scale
+                       , const unsigned int nThreads) {
+        const auto fold([&](std::size_t cs, std::size_t ce) -> SahBins {
+            SahBins bins;
+            for (std::size_t i = cs; i < ce; ++i) {
+                const int b = binOf(objects_[i], splitDim, origin, scale);
+                if (bins.count[b]) {
+                    math::update(bins.bbox[b], objects_[i].getBBox());
+                } else {
+                    bins.bbox[b] = objects_[i].getBBox();
+                }
+                ++bins.count[b];
+            }
+            return bins;
+        });
+
+        const std::size_t objCnt = end - start;
+        if ((nThreads > 1) && (objCnt >= MIN_PARALLEL_OBJECTS)) {
+            const std::size_t chunk((objCnt + nThreads - 1) / nThreads);
+
+            std::vector<std::future<SahBins>> partials;
+            for (std::size_t cs = start + chunk; cs < end; cs += chunk) {
+                partials.push_back(std::async(std::launch::async, fold
+                                              , cs, std::min(cs + chunk, end)));
+            }
+
+            SahBins bins(fold(start, std::min(start + chunk, end)));
+            for (auto& f : partials) {
+                bins.add(f.get());
+            }
+            return bins;
+        }
+
+        return fold(start, end);
+    }
+
+    std::unique_ptr<BuildNode> buildNodeSah(const std::size_t start
+                                            , const std::size_t end
+                                            , const BvhParallel& parallel
+                                            , const int splitDepth) {
+        const std::size_t objCnt = end - start;
+        const bool wide =
+            (splitDepth > 0) && (objCnt >= MIN_PARALLEL_OBJECTS);
+
+        std::unique_ptr<BuildNode> node(new BuildNode());
+        node->start = start;
+        node->objCnt = objCnt;
+
+        math::Extents3 bbox, boxCenter;
+        objectBounds(start, end, wide ? parallel.nThreads : 1
+                     , bbox, boxCenter);
+        node->bbox = bbox;
+
+        if (objCnt <= leafSize_) {
+            return node;
+        }
+
+        std::size_t mid = start;
+        const std::size_t splitDim = argMax(boxCenter.ur - boxCenter.ll);
+        const double extent = boxCenter.ur(splitDim) - boxCenter.ll(splitDim);
+
+        if (extent > 0.) {
+            const double origin = boxCenter.ll(splitDim);
+            const double scale = SAH_BINS / extent;
+
+            const SahBins bins(binObjects(start, end, splitDim, origin, scale
+                                          , wide ? parallel.nThreads : 1));
+
+            // SAH sweep over the SAH_BINS - 1 candidate planes:
+            // right-to-left suffix costs first, then the left-to-right
+            // prefix picks the cheapest plane (first one on ties)
+            std::array<double, SAH_BINS> rightCost;
+            {
+                math::Extents3 acc;
+                std::size_t cnt = 0;
+                for (int b = SAH_BINS - 1; b > 0; --b) {
+                    if (bins.count[b]) {
+                        if (cnt) {
+                            math::update(acc, bins.bbox[b]);
+                        } else {
+                            acc = bins.bbox[b];
+                        }
+                        cnt += bins.count[b];
+                    }
+                    rightCost[b] = cnt ? halfArea(acc) * cnt : 0.;
+                }
+            }
+
+            int bestBin = -1;
+            double bestCost = INFINITY;
+            {
+                math::Extents3 acc;
+                std::size_t cnt = 0;
+                for (int b = 0; b + 1 < SAH_BINS; ++b) {
+                    if (bins.count[b]) {
+                        if (cnt) {
+                            math::update(acc, bins.bbox[b]);
+                        } else {
+                            acc = bins.bbox[b];
+                        }
+                        cnt += bins.count[b];
+                    }
+                    const double cost = (cnt ? halfArea(acc) * cnt : 0.)
+                        + rightCost[b + 1];
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestBin = b;
+                    }
+                }
+            }
+
+            // partition: objects binned at or below the chosen plane
+            // go left; a fixed swap sequence, deterministic
+            for (std::size_t i = start; i < end; ++i) {
+                if (binOf(objects_[i], splitDim, origin, scale) <= bestBin) {
+                    std::swap(objects_[i], objects_[mid]);
+                    ++mid;
+                }
+            }
+        }
+
+        if (mid == start || mid == end) {
+            // degenerate split (coincident centroids), halve the range
+            // as the serial build does
+            mid = start + objCnt / 2;
+        }
+
+        if (wide) {
+            // fork a task for the left subtree while budget lasts
+            auto left(std::async(std::launch::async, [&]() {
+                return buildNodeSah(start, mid, parallel, splitDepth - 1);
+            }));
+            node->sons[1] = buildNodeSah(mid, end, parallel, splitDepth - 1);
+            node->sons[0] = left.get();
+        } else {
+            node->sons[0] = buildNodeSah(start, mid, parallel, 0);
+            node->sons[1] = buildNodeSah(mid, end, parallel, 0);
+        }
+        return node;
+    }
+
+    void flatten(const BuildNode& node, std::vector<BvhNode>& out) {
+        const std::size_t idx = out.size();
+        out.emplace_back();
+        out[idx].bbox = node.bbox;
+        out[idx].start = node.start;
+        out[idx].objCnt = node.objCnt;
+
+        if (node.isLeaf()) {
+            out[idx].setLeaf();
+            leafCnt_++;
+            return;
+        }
+
+        flatten(*node.sons[0], out);
+        out[idx].rightOffset = out.size() - idx;
+        flatten(*node.sons[1], out);
+    }
+
+    void buildTree(std::vector<TBvhObject>&& objects, bool presorted) {
         objects_ = std::move(objects);
         assert(!objects_.empty());
         nodeCnt_ = 0;
@@ -276,9 +618,16 @@ public:
             math::Extents3 bbox = objects_[start].getBBox();
             const math::Point3 center = objects_[start].getCenter();
             math::Extents3 boxCenter(center, center);
-            for (std::size_t i = start + 1; i < end; ++i) {
-                math::update(bbox, objects_[i].getBBox());
-                math::update(boxCenter, objects_[i].getCenter());
+            if (presorted) {
+                // centroid extents drive only the partition, not needed
+                for (std::size_t i = start + 1; i < end; ++i) {
+                    math::update(bbox, objects_[i].getBBox());
+                }
+            } else {
+                for (std::size_t i = start + 1; i < end; ++i) {
+                    math::update(bbox, objects_[i].getBBox());
+                    math::update(boxCenter, objects_[i].getCenter());
+                }
             }
             node.bbox = bbox;
 
@@ -302,20 +651,27 @@ public:
                 continue;
             }
 
-            const std::size_t splitDim = argMax(boxCenter.ur - boxCenter.ll);
-            const double split =
-                0.5 * (boxCenter.ll(splitDim) + boxCenter.ur(splitDim));
-
             std::size_t mid = start;
-            for (std::size_t i = start; i < end; ++i) {
-                if (objects_[i].getCenter()[splitDim] < split) {
-                    std::swap(objects_[i], objects_[mid]);
-                    ++mid;
+            if (presorted) {
+                // the curve order already clusters nearby objects;
+                // splitting the range at the median keeps it intact
+                mid = start + (end - start) / 2;
+            } else {
+                const std::size_t splitDim =
+                    argMax(boxCenter.ur - boxCenter.ll);
+                const double split =
+                    0.5 * (boxCenter.ll(splitDim) + boxCenter.ur(splitDim));
+
+                for (std::size_t i = start; i < end; ++i) {
+                    if (objects_[i].getCenter()[splitDim] < split) {
+                        std::swap(objects_[i], objects_[mid]);
+                        ++mid;
+                    }
                 }
-            }
 
-            if (mid == start || mid == end) {
-                mid = start + (end - start) / 2;
+                if (mid == start || mid == end) {
+                    mid = start + (end - start) / 2;
+                }
             }
 
             stack.pushBack({ nodeCnt_ - 1, mid, end });
@@ -326,6 +682,8 @@ public:
         nodes_ = std::move(buildNodes);
     }
 
+public:
+
     /// \brief Finds the closest intersection of the ray.
     ///
     /// Returns true if an intersection has been found.
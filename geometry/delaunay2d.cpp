@@ -24,14 +24,366 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "dbglog/dbglog.hpp"
+
 #include "delaunay2d.hpp"
-#include "gtsutils.hpp"
-#include "meshop.hpp"
+
+#ifdef GEOMETRY_HAS_GTS
+#  include "gtsutils.hpp"
+#endif
 
 namespace geometry {
 
 namespace {
 
+/** Native incremental Delaunay engine.
+ *
+ * Triangles live in flat arrays: three vertex indices and three
+ * neighbor triangle indices per triangle, no per-element allocation.
+ * Points are inserted in Morton order so the point-location walk starts
+ * next to its target, giving near O(1) location per insert. Insertion
+ * uses 1->3 (interior) and 2->4 (on-edge) splits followed by Lawson
+ * edge flips, so no triangles are ever deleted.
+ */
+class Delaunay2d {
+public:
+    Delaunay2d(const math::Points2 &points)
+        : nPoints_(points.size()), lastTri_(0)
+    {
+        // flat coordinates, super-triangle vertices appended at the end
+        coords_.reserve(2 * (nPoints_ + 3));
+        for (const auto &p : points) {
+            coords_.push_back(p(0));
+            coords_.push_back(p(1));
+        }
+
+        addSuperTriangle(points);
+    }
+
+    std::vector<DTriangle> operator()() {
+        for (const auto i : insertionOrder()) { insert(i); }
+
+        // collect finite triangles (none touching the super-triangle)
+        std::vector<DTriangle> triangles;
+        triangles.reserve(tri_.size() / 3);
+        for (std::size_t t(0); t < tri_.size(); t += 3) {
+            if ((tri_[t] < nPoints_) && (tri_[t + 1] < nPoints_)
+                && (tri_[t + 2] < nPoints_))
+            {
+                triangles.emplace_back(DTriangle{ tri_[t], tri_[t + 1]
+                                                  , tri_[t + 2] });
+            }
+        }
+        return triangles;
+    }
+
+private:
+    double x(unsigned v) const { return coords_[2 * v]; }
+    double y(unsigned v) const { return coords_[2 * v + 1]; }
+
+    static double orient(double ax, double ay, double bx, double by
+                         , double cx, double cy)
+    {
+        return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    }
+
+    double orient(unsigned a, unsigned b, unsigned c) const {
+        return orient(x(a), y(a), x(b), y(b), x(c), y(c));
+    }
+
+    /** Positive when d lies inside the circumcircle of CCW (a, b, c).
+     */
+    double incircle(unsigned a, unsigned b, unsigned c, unsigned d) const {
+        const double adx(x(a) - x(d)), ady(y(a) - y(d));
+        const double bdx(x(b) - x(d)), bdy(y(b) - y(d));
+        const double cdx(x(c) - x(d)), cdy(y(c) - y(d));
+
+        const double ad2(adx * adx + ady * ady);
+        const double bd2(bdx * bdx + bdy * bdy);
+        const double cd2(cdx * cdx + cdy * cdy);
+
+        return adx * (bdy * cd2 - cdy * bd2)
+            - ady * (bdx * cd2 - cdx * bd2)
+            + ad2 * (bdx * cdy - cdx * bdy);
+    }
+
+    void addSuperTriangle(const math::Points2 &points) {
+        auto extents(math::computeExtents(points.begin(), points.end()));
+        const auto center(math::center(extents));
+        const auto size(math::size(extents));
+        const double m(std::max({ size.width, size.height, 1.0 }) * 16.);
+
+        // CCW super triangle far outside the data extents
+        coords_.push_back(center(0) - 2. * m);
+        coords_.push_back(center(1) - m);
+        coords_.push_back(center(0) + 2. * m);
+        coords_.push_back(center(1) - m);
+        coords_.push_back(center(0));
+        coords_.push_back(center(1) + 2. * m);
+
+        tri_.assign({ unsigned(nPoints_), unsigned(nPoints_ + 1)
+                      , unsigned(nPoints_ + 2) });
+        adj_.assign({ -1, -1, -1 });
+    }
+
+    /** Morton-sorted insertion order keeps consecutive inserts
+     *  spatially close, so the walking point location is short.
+     */
+    std::vector<unsigned> insertionOrder() const {
+        std::vector<unsigned> order(nPoints_);
+        for (unsigned i(0); i < nPoints_; ++i) { order[i] = i; }
+        if (nPoints_ < 2) { return order; }
+
+        double llx(x(0)), lly(y(0)), urx(x(0)), ury(y(0));
+        for (unsigned i(1); i < nPoints_; ++i) {
+            llx = std::min(llx, x(i)); urx = std::max(urx, x(i));
+            lly = std::min(lly, y(i)); ury = std::max(ury, y(i));
+        }
+        const double sx((urx > llx) ? (0xffff / (urx - llx)) : 0.0);
+        const double sy((ury > lly) ? (0xffff / (ury - lly)) : 0.0);
+
+        std::vector<std::uint32_t> code(nPoints_);
+        for (unsigned i(0); i < nPoints_; ++i) {
+            code[i] = morton2(std::uint32_t((x(i) - llx) * sx)
+                              , std::uint32_t((y(i) - lly) * sy));
+        }
+
+        std::sort(order.begin(), order.end()
+                  , [&](unsigned a, unsigned b) {
+                        return code[a] < code[b];
+                    });
+        return order;
+    }
+
+    static std::uint32_t morton2(std::uint32_t mx, std::uint32_t my) {
+        auto spread([](std::uint32_t v) -> std::uint32_t {
+            v &= 0xffff;
+            v = (v | (v << 8)) & 0x00ff00ff;
+            v = (v | (v << 4)) & 0x0f0f0f0f;
+            v = (v | (v << 2)) & 0x33333333;
+            v = (v | (v << 1)) & 0x55555555;
+            return v;
+        });
+        return spread(mx) | (spread(my) << 1);
+    }
+
+    /** Walks from the last touched triangle towards the point.
+     */
+    int locate(unsigned v) const {
+        int t(lastTri_);
+        const std::size_t guard(2 * tri_.size());
+        for (std::size_t step(0); step < guard; ++step) {
+            bool moved(false);
+            for (int i(0); i < 3; ++i) {
+                const auto a(tri_[3 * t + i]);
+                const auto b(tri_[3 * t + (i + 1) % 3]);
+                if (orient(a, b, v) < 0.) {
+                    const int n(adj_[3 * t + i]);
+                    if (n < 0) { return t; }
+                    t = n;
+                    moved = true;
+                    break;
+                }
+            }
+            if (!moved) { return t; }
+        }
+
+        LOGTHROW(err2, std::runtime_error)
+            << "Delaunay point location failed to converge "
+            "(degenerate input?).";
+        throw; // never reached
+    }
+
+    /** Redirects n's neighbor pointer from oldTri to newTri.
+     */
+    void replaceNeighbor(int n, int oldTri, int newTri) {
+        if (n < 0) { return; }
+        for (int i(0); i < 3; ++i) {
+            if (adj_[3 * n + i] == oldTri) {
+                adj_[3 * n + i] = newTri;
+                return;
+            }
+        }
+    }
+
+    int edgeTo(int n, int t) const {
+        for (int i(0); i < 3; ++i) {
+            if (adj_[3 * n + i] == t) { return i; }
+        }
+        return -1;
+    }
+
+    int addTriangle(unsigned a, unsigned b, unsigned c
+                    , int nab, int nbc, int nca)
+    {
+        const int t(int(tri_.size() / 3));
+        tri_.insert(tri_.end(), { a, b, c });
+        adj_.insert(adj_.end(), { nab, nbc, nca });
+        return t;
+    }
+
+    void insert(unsigned v) {
+        const int t(locate(v));
+
+        const double o0(orient(tri_[3 * t], tri_[3 * t + 1], v));
+        const double o1(orient(tri_[3 * t + 1], tri_[3 * t + 2], v));
+        const double o2(orient(tri_[3 * t + 2], tri_[3 * t], v));
+
+        // duplicate of an existing vertex -> nothing to insert
+        if ((o0 == 0.) + (o1 == 0.) + (o2 == 0.) > 1) { return; }
+
+        if (o0 == 0.) { splitEdge(t, 0, v); }
+        else if (o1 == 0.) { splitEdge(t, 1, v); }
+        else if (o2 == 0.) { splitEdge(t, 2, v); }
+        else { splitTriangle(t, v); }
+
+        lastTri_ = int(tri_.size() / 3) - 1;
+        legalizeAll();
+    }
+
+    /** 1->3 split of triangle t = (a, b, c) by interior point v.
+     */
+    void splitTriangle(int t, unsigned v) {
+        const auto a(tri_[3 * t]), b(tri_[3 * t + 1]), c(tri_[3 * t + 2]);
+        const int nab(adj_[3 * t]), nbc(adj_[3 * t + 1])
+            , nca(adj_[3 * t + 2]);
+
+        const int t1(addTriangle(b, c, v, nbc, -1, t));
+        const int t2(addTriangle(c, a, v, nca, t, t1));
+
+        // t becomes (a, b, v)
+        tri_[3 * t + 2] = v;
+        adj_[3 * t] = nab;
+        adj_[3 * t + 1] = t1;
+        adj_[3 * t + 2] = t2;
+        adj_[3 * t1 + 1] = t2;
+
+        replaceNeighbor(nbc, t, t1);
+        replaceNeighbor(nca, t, t2);
+
+        suspect(t, 0);
+        suspect(t1, 0);
+        suspect(t2, 0);
+    }
+
+    /** 2->4 split: v lies on edge i of triangle t; splits both incident
+     *  triangles. Falls back to 1->3 when the edge is on the hull.
+     */
+    void splitEdge(int t, int i, unsigned v) {
+        const int u(adj_[3 * t + i]);
+        if (u < 0) { splitTriangle(t, v); return; }
+
+        const auto a(tri_[3 * t + i]);
+        const auto b(tri_[3 * t + (i + 1) % 3]);
+        const auto c(tri_[3 * t + (i + 2) % 3]);
+        const int nbc(adj_[3 * t + (i + 1) % 3]);
+        const int nca(adj_[3 * t + (i + 2) % 3]);
+
+        const int j(edgeTo(u, t));
+        const auto d(tri_[3 * u + (j + 2) % 3]);
+        const int nad(adj_[3 * u + (j + 1) % 3]);
+        const int ndb(adj_[3 * u + (j + 2) % 3]);
+
+        // t -> (v, b, c), u -> (v, a, d); new: (a, v, c), (b, v, d)
+        const int t2(addTriangle(a, v, c, t /*placeholder*/, t, nca));
+        const int u2(addTriangle(b, v, d, t /*placeholder*/, u, ndb));
+
+        tri_[3 * t] = v; tri_[3 * t + 1] = b; tri_[3 * t + 2] = c;
+        adj_[3 * t] = u2; adj_[3 * t + 1] = nbc; adj_[3 * t + 2] = t2;
+
+        tri_[3 * u] = v; tri_[3 * u + 1] = a; tri_[3 * u + 2] = d;
+        adj_[3 * u] = t2; adj_[3 * u + 1] = nad; adj_[3 * u + 2] = u2;
+
+        adj_[3 * t2] = u;
+        adj_[3 * u2] = t;
+
+        replaceNeighbor(nca, t, t2);
+        replaceNeighbor(ndb, u, u2);
+
+        suspect(t, 1);
+        suspect(u, 1);
+        suspect(t2, 2);
+        suspect(u2, 2);
+    }
+
+    /** Suspect edges are keyed by their vertex pair, not by edge index:
+     *  a flip rewrites both triangles' vertex order and would silently
+     *  re-target an index-based entry.
+     */
+    struct Suspect { int t; unsigned a, b; };
+
+    void suspect(int t, int i) {
+        stack_.push_back({ t, tri_[3 * t + i], tri_[3 * t + (i + 1) % 3] });
+    }
+
+    /** Lawson legalization: flip suspect edges until the Delaunay
+     *  criterion holds.
+     */
+    void legalizeAll() {
+        while (!stack_.empty()) {
+            const auto entry(stack_.back());
+            stack_.pop_back();
+
+            const int t(entry.t);
+            int i(-1);
+            for (int k(0); k < 3; ++k) {
+                if ((tri_[3 * t + k] == entry.a)
+                    && (tri_[3 * t + (k + 1) % 3] == entry.b))
+                {
+                    i = k;
+                    break;
+                }
+            }
+            // edge no longer exists (already flipped away)
+            if (i < 0) { continue; }
+
+            const int n(adj_[3 * t + i]);
+            if (n < 0) { continue; }
+
+            const auto a(entry.a);
+            const auto b(entry.b);
+            const auto v(tri_[3 * t + (i + 2) % 3]);
+
+            const int j(edgeTo(n, t));
+            const auto d(tri_[3 * n + (j + 2) % 3]);
+
+            if (incircle(a, b, v, d) <= 0.) { continue; }
+
+            // flip diagonal (a, b) -> (v, d)
+            const int tva(adj_[3 * t + (i + 2) % 3]);
+            const int tbv(adj_[3 * t + (i + 1) % 3]);
+            const int nad(adj_[3 * n + (j + 1) % 3]);
+            const int ndb(adj_[3 * n + (j + 2) % 3]);
+
+            tri_[3 * t] = a; tri_[3 * t + 1] = d; tri_[3 * t + 2] = v;
+            adj_[3 * t] = nad; adj_[3 * t + 1] = n; adj_[3 * t + 2] = tva;
+
+            tri_[3 * n] = d; tri_[3 * n + 1] = b; tri_[3 * n + 2] = v;
+            adj_[3 * n] = ndb; adj_[3 * n + 1] = tbv; adj_[3 * n + 2] = t;
+
+            replaceNeighbor(nad, n, t);
+            replaceNeighbor(tbv, t, n);
+
+            suspect(t, 0);
+            suspect(n, 0);
+        }
+    }
+
+    unsigned nPoints_;
+    std::vector<double> coords_;
+    std::vector<unsigned> tri_;
+    std::vector<int> adj_;
+    std::vector<Suspect> stack_;
+    int lastTri_;
+};
+
+#ifdef GEOMETRY_HAS_GTS
+
 const unsigned SUPER_IDX = unsigned(-1);
 
 GtsTriangle* enclosingTriangle(const math::Points2& points)
@@ -65,9 +417,7 @@ gint extractFace(GtsTriangle *t, std::vector<DTriangle>* triangles)
     return 0;
 }
 
-} // namespace
-
-std::vector<DTriangle> delaunayTriangulation2d(const math::Points2 &points)
+std::vector<DTriangle> delaunayTriangulation2dGts(const math::Points2 &points)
 {
     checkGtsInitialized();
     GtsSurface* gts = gts_surface_new(gts_surface_class(),
@@ -95,4 +445,25 @@ std::vector<DTriangle> delaunayTriangulation2d(const math::Points2 &points)
     return triangles;
 }
 
+#endif // GEOMETRY_HAS_GTS
+
+} // namespace
+
+std::vector<DTriangle> delaunayTriangulation2d(const math::Points2 &points)
+{
+    if (points.empty()) { return {}; }
+
+#ifdef GEOMETRY_HAS_GTS
+    try {
+        return Delaunay2d(points)();
+    } catch (const std::runtime_error &e) {
+        LOG(warn2) << "Native Delaunay engine failed (" << e.what()
+                   << "); falling back to GTS.";
+        return delaunayTriangulation2dGts(points);
+    }
+#else
+    return Delaunay2d(points)();
+#endif
+}
+
 } // namespace geometry
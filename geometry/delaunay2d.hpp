@@ -27,7 +27,7 @@
  * @file delaunay2d.hpp
  * @author Jakub Cerveny <jakub.cerveny@melown.com>
  *
- * Computation of 2D Delaunay triangulation using the GTS library.
+ * Computation of 2D Delaunay triangulation.
  */
 
 #ifndef geometry_delaunay_hpp_included_
@@ -38,8 +38,6 @@
 
 #include "math/geometry_core.hpp"
 
-#include "utility/gccversion.hpp"
-
 namespace geometry {
 
 typedef std::array<unsigned, 3> DTriangle;
@@ -47,12 +45,13 @@ typedef std::array<unsigned, 3> DTriangle;
 /** Calculates the 2D Delaunay triangulation of a set of points.
  *  Returns a list of (finite) triangles. Each triangle indexes three
  *  points from the original set.
+ *
+ *  Uses a native incremental engine (flat index-based triangle arrays,
+ *  Morton insertion order); when compiled with GTS the original GTS
+ *  implementation serves as a fallback for inputs the native engine
+ *  rejects.
  */
-std::vector<DTriangle> delaunayTriangulation2d(const math::Points2 &points)
-#ifndef GEOMETRY_HAS_GTS
-    UTILITY_FUNCTION_ERROR("Delaunay triangulation is available only when compiled with GTS.")
-#endif
-;
+std::vector<DTriangle> delaunayTriangulation2d(const math::Points2 &points);
 
 } // namespace geometry
 
@@ -0,0 +1,283 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/** Parallel independent-set decimater.
+ *
+ *  Drop-in replacement for OpenMesh::Decimater::DecimaterT that replaces
+ *  the single serial priority queue with rounds of independent collapses:
+ *  every round scores the collapse candidates in parallel through the
+ *  configured decimation modules, greedily picks a maximal set of
+ *  cheapest collapses whose supports (both end vertices plus their
+ *  one-rings) do not overlap, applies the whole set concurrently and
+ *  re-scores only the vertices whose neighborhood changed.
+ *
+ *  Module semantics are untouched: legality and priority go through
+ *  BaseDecimaterT::is_collapse_legal()/collapse_priority(), so locked
+ *  vertices (INNERBORDER/OUTERBORDER/CORNERS) and max_err behave exactly
+ *  as in the serial decimater. The result differs from the serial one
+ *  only in collapse order; within a round the outcome is independent of
+ *  scheduling since applied collapses never share support.
+ */
+
+#ifndef geometry_detail_parallel_decimater_hpp_included_
+#define geometry_detail_parallel_decimater_hpp_included_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <OpenMesh/Tools/Decimater/DecimaterT.hh>
+
+#include "utility/openmp.hpp"
+
+namespace geometry { namespace detail {
+
+#if OM_VERSION >= 0x60000
+
+template <class MeshT>
+class ParallelDecimaterT : public OpenMesh::Decimater::DecimaterT<MeshT>
+{
+public:
+    typedef OpenMesh::Decimater::DecimaterT<MeshT> Super;
+    typedef OpenMesh::Decimater::CollapseInfoT<MeshT> CollapseInfo;
+    typedef typename MeshT::VertexHandle VertexHandle;
+    typedef typename MeshT::HalfedgeHandle HalfedgeHandle;
+
+    explicit ParallelDecimaterT(MeshT &mesh)
+        : Super(mesh), mesh_(mesh)
+    {}
+
+    /** Decimate down to nFaces faces using nThreads worker threads.
+     *  Returns the number of performed collapses.
+     */
+    std::size_t decimateToFaces(std::size_t nFaces, int nThreads);
+
+private:
+    /** Best legal collapse of one vertex; mirrors
+     *  DecimaterT::heap_vertex() but stores the result per vertex
+     *  instead of pushing it to the shared heap.
+     */
+    void scoreVertex(int v);
+
+    /** Walks the support of a candidate collapse (end vertices plus
+     *  their one-rings) and calls op(vertex index) for every member.
+     */
+    template <typename Op>
+    void forSupport(const HalfedgeHandle &heh, const Op &op);
+
+    MeshT &mesh_;
+
+    std::vector<float> priority_;
+    std::vector<HalfedgeHandle> candidate_;
+    std::vector<char> dirty_;
+};
+
+template <class MeshT>
+void ParallelDecimaterT<MeshT>::scoreVertex(int v)
+{
+    const VertexHandle vh(v);
+
+    float best(std::numeric_limits<float>::max());
+    HalfedgeHandle bestHeh;
+
+    for (auto voh_it(mesh_.voh_iter(vh)); voh_it.is_valid(); ++voh_it) {
+        CollapseInfo ci(mesh_, *voh_it);
+        if (!this->is_collapse_legal(ci)) { continue; }
+
+        const float priority(this->collapse_priority(ci));
+        // negative priority means an illegal collapse, same as in
+        // DecimaterT::heap_vertex()
+        if ((priority >= 0.f) && (priority < best)) {
+            best = priority;
+            bestHeh = *voh_it;
+        }
+    }
+
+    priority_[v] = best;
+    candidate_[v] = bestHeh;
+}
+
+template <class MeshT>
+template <typename Op>
+void ParallelDecimaterT<MeshT>::forSupport(const HalfedgeHandle &heh
+                                           , const Op &op)
+{
+    const VertexHandle v0(mesh_.from_vertex_handle(heh));
+    const VertexHandle v1(mesh_.to_vertex_handle(heh));
+
+    op(v0.idx());
+    op(v1.idx());
+    for (auto vv_it(mesh_.vv_iter(v0)); vv_it.is_valid(); ++vv_it) {
+        op(vv_it->idx());
+    }
+    for (auto vv_it(mesh_.vv_iter(v1)); vv_it.is_valid(); ++vv_it) {
+        op(vv_it->idx());
+    }
+}
+
+template <class MeshT>
+std::size_t ParallelDecimaterT<MeshT>
+::decimateToFaces(std::size_t nFaces, int nThreads)
+{
+    const auto nv(std::int64_t(mesh_.n_vertices()));
+    if (!nv) { return 0; }
+
+    priority_.assign(nv, std::numeric_limits<float>::max());
+    candidate_.assign(nv, HalfedgeHandle());
+    dirty_.assign(nv, 1);
+
+    // live face count; garbage collection has not run yet, deleted
+    // elements are only flagged
+    std::size_t faceCount(0);
+    for (auto f_it(mesh_.faces_begin()); f_it != mesh_.faces_end(); ++f_it) {
+        if (!mesh_.status(*f_it).deleted()) { ++faceCount; }
+    }
+
+    std::vector<int> order;
+    order.reserve(nv);
+    std::vector<char> blocked(nv);
+    std::vector<HalfedgeHandle> selected;
+    std::vector<char> removesTwo;
+
+    std::size_t collapses(0);
+
+    while (faceCount > nFaces) {
+        // re-score vertices whose neighborhood changed last round
+        UTILITY_OMP(parallel for schedule(dynamic, 256)
+                    num_threads(nThreads))
+        for (std::int64_t v = 0; v < nv; ++v) {
+            if (!dirty_[v]) { continue; }
+            dirty_[v] = 0;
+
+            if (mesh_.status(VertexHandle(int(v))).deleted()) {
+                priority_[v] = std::numeric_limits<float>::max();
+                candidate_[v] = HalfedgeHandle();
+                continue;
+            }
+            scoreVertex(int(v));
+        }
+
+        // order collapse candidates by cost
+        order.clear();
+        for (int v = 0; v < nv; ++v) {
+            if (candidate_[v].is_valid()) { order.push_back(v); }
+        }
+        if (order.empty()) { break; }
+
+        std::sort(order.begin(), order.end()
+                  , [this](int a, int b) {
+                        return priority_[a] < priority_[b];
+                    });
+
+        // greedily pick a set of cheapest collapses with pairwise
+        // disjoint supports; disjoint supports guarantee that neither
+        // legality nor priority of one is affected by applying another
+        std::fill(blocked.begin(), blocked.end(), 0);
+        selected.clear();
+        removesTwo.clear();
+
+        std::size_t toRemove(faceCount - nFaces);
+        for (const auto v : order) {
+            if (!toRemove) { break; }
+
+            const auto &heh(candidate_[v]);
+            bool conflict(false);
+            forSupport(heh, [&](int i) {
+                if (blocked[i]) { conflict = true; }
+            });
+            if (conflict) { continue; }
+
+            forSupport(heh, [&](int i) { blocked[i] = 1; });
+
+            const CollapseInfo ci(mesh_, heh);
+            const std::size_t removes
+                ((ci.fl.is_valid() ? 1 : 0) + (ci.fr.is_valid() ? 1 : 0));
+            if (!removes || (removes > toRemove)) { continue; }
+
+            selected.push_back(heh);
+            removesTwo.push_back(removes == 2);
+            toRemove -= removes;
+        }
+        if (selected.empty()) { break; }
+
+        // apply the independent set; supports are disjoint so the
+        // collapses touch disjoint parts of the kernel
+        const auto nSelected(std::int64_t(selected.size()));
+
+        UTILITY_OMP(parallel for schedule(dynamic, 16)
+                    num_threads(nThreads))
+        for (std::int64_t i = 0; i < nSelected; ++i) {
+            CollapseInfo ci(mesh_, selected[i]);
+
+            this->preprocess_collapse(ci);
+            mesh_.collapse(ci.v0v1);
+            this->postprocess_collapse(ci);
+
+            // update normals of surviving faces around the remaining
+            // vertex, same as the serial decimation loop does
+            for (auto vf_it(mesh_.vf_iter(ci.v1)); vf_it.is_valid();
+                 ++vf_it)
+            {
+                if (!mesh_.status(*vf_it).deleted()) {
+                    mesh_.set_normal
+                        (*vf_it, mesh_.calc_face_normal(*vf_it));
+                }
+            }
+        }
+
+        // mark the two-ring of every surviving vertex dirty: priorities
+        // depend on the end vertices' rings, so anything further away is
+        // unaffected; serial pass, supports of distinct collapses may
+        // share two-ring vertices
+        for (const auto &heh : selected) {
+            const VertexHandle v1(mesh_.to_vertex_handle(heh));
+            dirty_[v1.idx()] = 1;
+            for (auto vv_it(mesh_.vv_iter(v1)); vv_it.is_valid(); ++vv_it)
+            {
+                dirty_[vv_it->idx()] = 1;
+                for (auto vv2_it(mesh_.vv_iter(*vv_it)); vv2_it.is_valid();
+                     ++vv2_it)
+                {
+                    dirty_[vv2_it->idx()] = 1;
+                }
+            }
+        }
+
+        for (std::size_t i(0); i < selected.size(); ++i) {
+            faceCount -= (removesTwo[i] ? 2 : 1);
+        }
+        collapses += selected.size();
+    }
+
+    return collapses;
+}
+
+#endif // OM_VERSION >= 0x60000
+
+} } // namespace geometry::detail
+
+#endif // geometry_detail_parallel_decimater_hpp_included_
@@ -0,0 +1,443 @@
+/**
+ * Copyright (c) 2017 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ *  @file geometry/detail/parse-obj-fast.hpp
+ *
+ *  High-throughput OBJ scanner (implementation).
+ *
+ *  Reads the stream in large blocks, scans lines with a hand-rolled
+ *  float/int tokenizer (no istream extraction, no locale machinery) and
+ *  delivers elements to the sink in batches via the addVertices()/
+ *  addFacets() family, so virtual dispatch leaves the per-element path.
+ *  Accepts the same input language as the Boost.Spirit grammar in
+ *  parse-obj.hpp.
+ */
+
+#ifndef geometry_detail_objparser_fast_hpp_included_
+#define geometry_detail_objparser_fast_hpp_included_
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <geometry/parse-obj.hpp>
+
+namespace geometry { namespace detail {
+
+constexpr std::size_t fastObjReadBlock = 1 << 20;
+constexpr std::size_t fastObjBatchSize = 1 << 13;
+
+inline bool fastObjSpace(char c) { return (c == ' ') || (c == '\t')
+        || (c == '\r'); }
+
+inline const char* skipSpace(const char *p, const char *end) {
+    while ((p != end) && fastObjSpace(*p)) { ++p; }
+    return p;
+}
+
+/** Parse decimal double; falls back to strtod for extreme mantissas.
+ *  Returns position past the number or nullptr on failure.
+ */
+inline const char* parseDouble(const char *p, const char *end, double &out)
+{
+    const char *start(p);
+
+    bool negative(false);
+    if ((p != end) && ((*p == '-') || (*p == '+'))) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    std::uint64_t mantissa(0);
+    int digits(0), fracDigits(0);
+
+    while ((p != end) && (*p >= '0') && (*p <= '9')) {
+        mantissa = mantissa * 10 + unsigned(*p - '0');
+        ++digits; ++p;
+    }
+
+    if ((p != end) && (*p == '.')) {
+        ++p;
+        while ((p != end) && (*p >= '0') && (*p <= '9')) {
+            mantissa = mantissa * 10 + unsigned(*p - '0');
+            ++digits; ++fracDigits; ++p;
+        }
+    }
+
+    if (!digits) { return nullptr; }
+
+    int exponent(0);
+    if ((p != end) && ((*p == 'e') || (*p == 'E'))) {
+        ++p;
+        bool expNegative(false);
+        if ((p != end) && ((*p == '-') || (*p == '+'))) {
+            expNegative = (*p == '-');
+            ++p;
+        }
+        if ((p == end) || (*p < '0') || (*p > '9')) { return nullptr; }
+        while ((p != end) && (*p >= '0') && (*p <= '9')) {
+            exponent = exponent * 10 + (*p - '0');
+            ++p;
+        }
+        if (expNegative) { exponent = -exponent; }
+    }
+
+    if (digits > 17) {
+        // mantissa overflows 64 bits; let the libc parser handle it
+        char *tail(nullptr);
+        std::string token(start, p);
+        out = std::strtod(token.c_str(), &tail);
+        return p;
+    }
+
+    double value(double(mantissa));
+    const int scale(exponent - fracDigits);
+    if (scale > 0) {
+        value *= std::pow(10.0, scale);
+    } else if (scale < 0) {
+        value /= std::pow(10.0, -scale);
+    }
+
+    out = negative ? -value : value;
+    return p;
+}
+
+/** Parse decimal (possibly negative) integer.
+ */
+inline const char* parseInt(const char *p, const char *end, int &out)
+{
+    bool negative(false);
+    if ((p != end) && ((*p == '-') || (*p == '+'))) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    if ((p == end) || (*p < '0') || (*p > '9')) { return nullptr; }
+
+    int value(0);
+    while ((p != end) && (*p >= '0') && (*p <= '9')) {
+        value = value * 10 + (*p - '0');
+        ++p;
+    }
+
+    out = negative ? -value : value;
+    return p;
+}
+
+/** Batching sink adapter: collects elements and flushes them to the parser
+ *  in input order (all pending vertices/textures/normals before facets,
+ *  everything before material statements).
+ */
+class FastObjBatcher {
+public:
+    FastObjBatcher(ObjParserBase &p) : p_(&p) {}
+
+    typedef ObjParserBase::Vector3d Vector3d;
+    typedef ObjParserBase::Facet Facet;
+
+    void vertex(const Vector3d &v) {
+        flushFacets();
+        vertices_.push_back(v);
+        if (vertices_.size() >= fastObjBatchSize) { flushVertices(); }
+    }
+
+    void texture(const Vector3d &t) {
+        flushFacets();
+        textures_.push_back(t);
+        if (textures_.size() >= fastObjBatchSize) { flushTextures(); }
+    }
+
+    void normal(const Vector3d &n) {
+        flushFacets();
+        normals_.push_back(n);
+        if (normals_.size() >= fastObjBatchSize) { flushNormals(); }
+    }
+
+    void facet(const Facet &f) {
+        flushElements();
+        facets_.push_back(f);
+        if (facets_.size() >= fastObjBatchSize) { flushFacets(); }
+    }
+
+    void materialLibrary(const std::string &l) {
+        flush();
+        p_->materialLibrary(l);
+    }
+
+    void useMaterial(const std::string &m) {
+        flush();
+        p_->useMaterial(m);
+    }
+
+    void flush() {
+        flushElements();
+        flushFacets();
+    }
+
+private:
+    void flushVertices() {
+        if (!vertices_.empty()) {
+            p_->addVertices(vertices_);
+            vertices_.clear();
+        }
+    }
+
+    void flushTextures() {
+        if (!textures_.empty()) {
+            p_->addTextures(textures_);
+            textures_.clear();
+        }
+    }
+
+    void flushNormals() {
+        if (!normals_.empty()) {
+            p_->addNormals(normals_);
+            normals_.clear();
+        }
+    }
+
+    void flushElements() {
+        flushVertices();
+        flushTextures();
+        flushNormals();
+    }
+
+    void flushFacets() {
+        if (!facets_.empty()) {
+            p_->addFacets(facets_);
+            facets_.clear();
+        }
+    }
+
+    ObjParserBase *p_;
+    std::vector<Vector3d> vertices_;
+    std::vector<Vector3d> textures_;
+    std::vector<Vector3d> normals_;
+    std::vector<Facet> facets_;
+};
+
+class FastObjParser {
+public:
+    FastObjParser(ObjParserBase &p)
+        : batcher_(p), vCount_(), tCount_(), nCount_()
+    {}
+
+    /** Process one complete line; returns false on syntax error.
+     */
+    bool line(const char *p, const char *end) {
+        p = skipSpace(p, end);
+        if ((p == end) || (*p == '#')) { return true; }
+
+        typedef ObjParserBase::Vector3d Vector3d;
+
+        if (*p == 'v') {
+            ++p;
+            if ((p != end) && (*p == 't')) {
+                // vt u [v [w]]
+                Vector3d t;
+                if (!(p = vector(p + 1, end, t, 1))) { return false; }
+                ++tCount_;
+                batcher_.texture(t);
+                return done(p, end);
+            }
+            if ((p != end) && (*p == 'n')) {
+                // vn x y z
+                Vector3d n;
+                if (!(p = vector(p + 1, end, n, 3))) { return false; }
+                ++nCount_;
+                batcher_.normal(n);
+                return done(p, end);
+            }
+
+            // v x y z
+            Vector3d v;
+            if (!(p = vector(p, end, v, 3))) { return false; }
+            ++vCount_;
+            batcher_.vertex(v);
+            return done(p, end);
+        }
+
+        if (*p == 'f') {
+            ObjParserBase::Facet f;
+            ++p;
+            for (int i = 0; i < 3; i++) {
+                if (!(p = corner(p, end, f, i))) { return false; }
+            }
+            batcher_.facet(f);
+            return done(p, end);
+        }
+
+        if (keyword(p, end, "mtllib")) {
+            std::string lib;
+            if (!token(p + 6, end, lib)) { return false; }
+            batcher_.materialLibrary(lib);
+            return true;
+        }
+
+        if (keyword(p, end, "usemtl")) {
+            std::string name;
+            if (!token(p + 6, end, name)) { return false; }
+            batcher_.useMaterial(name);
+            return true;
+        }
+
+        // unknown directive; the Spirit grammar treats this as a failure
+        return false;
+    }
+
+    void finish() { batcher_.flush(); }
+
+private:
+    bool keyword(const char *p, const char *end, const char *word) const {
+        const auto len(std::strlen(word));
+        return ((std::size_t(end - p) > len)
+                && !std::memcmp(p, word, len)
+                && fastObjSpace(p[len]));
+    }
+
+    bool done(const char *p, const char *end) const {
+        return skipSpace(p, end) == end;
+    }
+
+    const char* vector(const char *p, const char *end
+                       , ObjParserBase::Vector3d &out, int required)
+    {
+        double c[3] = { 0., 0., 0. };
+        for (int i = 0; i < 3; i++) {
+            const char *next(skipSpace(p, end));
+            if ((next == end) && (i >= required)) { break; }
+            if (!(next = parseDouble(next, end, c[i]))) {
+                if (i >= required) { break; }
+                return nullptr;
+            }
+            p = next;
+        }
+        out.x = c[0]; out.y = c[1]; out.z = c[2];
+        return p;
+    }
+
+    /** Parse one facet corner: v, v/t, v//n or v/t/n; resolves relative
+     *  (negative) and one-based indices against running element counts.
+     */
+    const char* corner(const char *p, const char *end
+                       , ObjParserBase::Facet &f, int i)
+    {
+        p = skipSpace(p, end);
+
+        int v(0), t(0), n(0);
+        if (!(p = parseInt(p, end, v))) { return nullptr; }
+
+        if ((p != end) && (*p == '/')) {
+            ++p;
+            if ((p != end) && (*p != '/')) {
+                if (!(p = parseInt(p, end, t))) { return nullptr; }
+            }
+            if ((p != end) && (*p == '/')) {
+                ++p;
+                if ((p != end) && !fastObjSpace(*p)) {
+                    if (!(p = parseInt(p, end, n))) { return nullptr; }
+                }
+            }
+        }
+
+        f.v[i] = (v < 0) ? (vCount_ + v) : (v - 1);
+        f.t[i] = (t < 0) ? (tCount_ + t) : (t - 1);
+        f.n[i] = (n < 0) ? (nCount_ + n) : (n - 1);
+        return p;
+    }
+
+    bool token(const char *p, const char *end, std::string &out) const {
+        p = skipSpace(p, end);
+        const char *start(p);
+        while ((p != end) && !fastObjSpace(*p)) { ++p; }
+        if (p == start) { return false; }
+        out.assign(start, p);
+        return true;
+    }
+
+    FastObjBatcher batcher_;
+    int vCount_;
+    int tCount_;
+    int nCount_;
+};
+
+/** Parse OBJ from stream using the block scanner.
+ */
+inline bool parseFast(std::istream &is, ObjParserBase &p)
+{
+    FastObjParser parser(p);
+
+    std::vector<char> buffer(fastObjReadBlock);
+    std::string pending;
+
+    for (;;) {
+        is.read(buffer.data(), buffer.size());
+        const std::size_t got(is.gcount());
+        if (!got) { break; }
+
+        const char *beg(buffer.data());
+        const char *end(beg + got);
+
+        // process complete lines; keep the partial tail for the next block
+        const char *lineStart(beg);
+        for (const char *c(beg); c != end; ++c) {
+            if (*c != '\n') { continue; }
+
+            if (!pending.empty()) {
+                pending.append(lineStart, c);
+                if (!parser.line(pending.data()
+                                 , pending.data() + pending.size())) {
+                    return false;
+                }
+                pending.clear();
+            } else if (!parser.line(lineStart, c)) {
+                return false;
+            }
+            lineStart = c + 1;
+        }
+        pending.append(lineStart, end);
+
+        if (is.eof()) { break; }
+    }
+
+    // last line without trailing newline
+    if (!pending.empty()
+        && !parser.line(pending.data(), pending.data() + pending.size()))
+    {
+        return false;
+    }
+
+    parser.finish();
+    return true;
+}
+
+} } // namespace geometry::detail
+
+#endif // geometry_detail_objparser_fast_hpp_included_
@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <istream>
+#include <sstream>
+
+#include <dbglog/dbglog.hpp>
+
+#include "../error.hpp"
+#include "ply.hpp"
+
+namespace geometry { namespace detail {
+
+namespace {
+
+bool parseType(const std::string &token, PlyProperty::Type &type)
+{
+    typedef PlyProperty::Type Type;
+
+    if ((token == "char") || (token == "int8")) {
+        type = Type::int8;
+    } else if ((token == "uchar") || (token == "uint8")) {
+        type = Type::uint8;
+    } else if ((token == "short") || (token == "int16")) {
+        type = Type::int16;
+    } else if ((token == "ushort") || (token == "uint16")) {
+        type = Type::uint16;
+    } else if ((token == "int") || (token == "int32")) {
+        type = Type::int32;
+    } else if ((token == "uint") || (token == "uint32")) {
+        type = Type::uint32;
+    } else if ((token == "float") || (token == "float32")) {
+        type = Type::float32;
+    } else if ((token == "double") || (token == "float64")) {
+        type = Type::float64;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::size_t PlyProperty::typeSize(Type type)
+{
+    switch (type) {
+    case Type::int8: case Type::uint8: return 1;
+    case Type::int16: case Type::uint16: return 2;
+    case Type::int32: case Type::uint32: case Type::float32: return 4;
+    case Type::float64: return 8;
+    }
+    return 0;
+}
+
+bool PlyElement::fixedSize() const
+{
+    for (const auto &property : properties) {
+        if (property.list) { return false; }
+    }
+    return true;
+}
+
+std::size_t PlyElement::recordSize() const
+{
+    std::size_t size(0);
+    for (const auto &property : properties) {
+        size += PlyProperty::typeSize(property.type);
+    }
+    return size;
+}
+
+const PlyProperty* PlyElement::property(const std::string &name) const
+{
+    for (const auto &property : properties) {
+        if (property.name == name) { return &property; }
+    }
+    return nullptr;
+}
+
+int PlyElement::propertyOffset(const std::string &name) const
+{
+    std::size_t offset(0);
+    for (const auto &property : properties) {
+        if (property.name == name) { return int(offset); }
+        if (property.list) { return -1; }
+        offset += PlyProperty::typeSize(property.type);
+    }
+    return -1;
+}
+
+const PlyElement* PlyHeader::element(const std::string &name) const
+{
+    for (const auto &element : elements) {
+        if (element.name == name) { return &element; }
+    }
+    return nullptr;
+}
+
+PlyHeader parsePlyHeader(std::istream &in
+                         , const boost::filesystem::path &path)
+{
+    PlyHeader header;
+
+    std::string line;
+    bool first(true), done(false);
+
+    while (!done) {
+        if (std::getline(in, line).eof() && line.empty()) { break; }
+
+        // tolerate files with CRLF line ends
+        if (!line.empty() && (line.back() == '\r')) { line.pop_back(); }
+
+        if (first) {
+            if (line != "ply") {
+                LOGTHROW(err2, BadFileFormat)
+                    << "File " << path << " is not a PLY file.";
+            }
+            first = false;
+            continue;
+        }
+
+        std::istringstream ls(line);
+        std::string keyword;
+        ls >> keyword;
+
+        if (keyword == "end_header") {
+            done = true;
+        } else if (keyword == "comment") {
+            // ignored
+        } else if (keyword == "format") {
+            std::string format, version;
+            ls >> format >> version;
+            if (format == "ascii") {
+                header.format = PlyHeader::Format::ascii;
+            } else if (format == "binary_little_endian") {
+                header.format = PlyHeader::Format::binaryLittleEndian;
+            } else if (format == "binary_big_endian") {
+                header.format = PlyHeader::Format::binaryBigEndian;
+            } else {
+                LOGTHROW(err2, BadFileFormat)
+                    << "File " << path << " has unknown PLY format <"
+                    << format << ">.";
+            }
+        } else if (keyword == "element") {
+            PlyElement element;
+            ls >> element.name >> element.count;
+            if (!ls) {
+                LOGTHROW(err2, BadFileFormat)
+                    << "File " << path << ": malformed element line <"
+                    << line << ">.";
+            }
+            header.elements.push_back(element);
+        } else if (keyword == "property") {
+            if (header.elements.empty()) {
+                LOGTHROW(err2, BadFileFormat)
+                    << "File " << path << ": property before element.";
+            }
+
+            PlyProperty property;
+            std::string token;
+            ls >> token;
+            if (token == "list") {
+                property.list = true;
+                std::string countType, valueType;
+                ls >> countType >> valueType >> property.name;
+                if (!ls || !parseType(countType, property.countType)
+                    || !parseType(valueType, property.type))
+                {
+                    LOGTHROW(err2, BadFileFormat)
+                        << "File " << path
+                        << ": malformed property line <" << line << ">.";
+                }
+            } else {
+                ls >> property.name;
+                if (!ls || !parseType(token, property.type)) {
+                    LOGTHROW(err2, BadFileFormat)
+                        << "File " << path
+                        << ": malformed property line <" << line << ">.";
+                }
+            }
+            header.elements.back().properties.push_back(property);
+        }
+        // unknown keywords (obj_info et al) are ignored
+    }
+
+    if (!done) {
+        LOGTHROW(err2, BadFileFormat)
+            << "File " << path << ": unterminated PLY header.";
+    }
+
+    header.size = std::size_t(in.tellg());
+    return header;
+}
+
+} } // namespace geometry::detail
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/** PLY header parser shared by the ascii reader (meshop.cpp) and the
+ *  memory-mapped binary reader (ply-mmapped.cpp).
+ */
+
+#ifndef geometry_detail_ply_hpp_included_
+#define geometry_detail_ply_hpp_included_
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+namespace geometry { namespace detail {
+
+struct PlyProperty {
+    enum class Type {
+        int8, uint8, int16, uint16, int32, uint32, float32, float64
+    };
+
+    std::string name;
+    Type type;
+
+    /** List property: per-record count of countType followed by that
+     *  many values of type.
+     */
+    bool list;
+    Type countType;
+
+    PlyProperty()
+        : type(Type::uint8), list(false), countType(Type::uint8)
+    {}
+
+    static std::size_t typeSize(Type type);
+};
+
+struct PlyElement {
+    std::string name;
+    std::size_t count;
+    std::vector<PlyProperty> properties;
+
+    PlyElement() : count(0) {}
+
+    /** No list properties -> every record has the same size. */
+    bool fixedSize() const;
+
+    /** Record size in bytes; meaningful only when fixedSize(). */
+    std::size_t recordSize() const;
+
+    /** Pointer to named property or nullptr. */
+    const PlyProperty* property(const std::string &name) const;
+
+    /** Byte offset of named property within a fixed-size record;
+     *  negative when not present or preceded by a list.
+     */
+    int propertyOffset(const std::string &name) const;
+};
+
+struct PlyHeader {
+    enum class Format { ascii, binaryLittleEndian, binaryBigEndian };
+
+    Format format;
+    std::vector<PlyElement> elements;
+
+    /** Header size in bytes, including the end_header line; element
+     *  data starts here. Byte-accurate only when the stream is open in
+     *  binary mode.
+     */
+    std::size_t size;
+
+    PlyHeader() : format(Format::ascii), size(0) {}
+
+    /** Pointer to named element or nullptr. */
+    const PlyElement* element(const std::string &name) const;
+};
+
+/** Parses a PLY header, leaving the stream right behind the end_header
+ *  line. Throws BadFileFormat when the input is not a PLY file.
+ * \param path used only for logging
+ */
+PlyHeader parsePlyHeader(std::istream &in
+                         , const boost::filesystem::path &path);
+
+} } // namespace geometry::detail
+
+#endif // geometry_detail_ply_hpp_included_
@@ -23,6 +23,10 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
 #include "estimate-point-normals.hpp"
 #include "bvh.hpp"
 #include "math/math.hpp"
@@ -56,6 +60,69 @@ Eigen::VectorXd estimateNormal(const Eigen::MatrixXd& data)
     return sgVec;//.normalized();
 }
 
+math::Point3 estimateNormal3(const double (&cov)[6])
+{
+    // scale by the largest element to keep the characteristic polynomial
+    // well conditioned
+    const double scale(std::max({ std::fabs(cov[0]), std::fabs(cov[1])
+                                , std::fabs(cov[2]), std::fabs(cov[3])
+                                , std::fabs(cov[4]), std::fabs(cov[5]) }));
+    if (scale <= 0.) {
+        // degenerate data (all neighbors identical), the normal is not
+        // determined -- return an arbitrary unit vector
+        return math::Point3(0., 0., 1.);
+    }
+
+    const double a(cov[0] / scale), b(cov[3] / scale), c(cov[5] / scale);
+    const double d(cov[1] / scale), e(cov[4] / scale), f(cov[2] / scale);
+
+    // smallest eigenvalue of [[a,d,f],[d,b,e],[f,e,c]], trigonometric
+    // method for symmetric 3x3 matrices (Smith, 1961)
+    double eigMin;
+    const double p1(d*d + f*f + e*e);
+    if (p1 < 1e-32) {
+        // already diagonal
+        eigMin = std::min({ a, b, c });
+    } else {
+        const double q((a + b + c) / 3.);
+        const double aa(a - q), bb(b - q), cc(c - q);
+        const double p(std::sqrt((aa*aa + bb*bb + cc*cc + 2.*p1) / 6.));
+        // r = det((A - qI) / p) / 2, clamped against roundoff
+        double r((aa*(bb*cc - e*e) - d*(d*cc - e*f) + f*(d*e - bb*f))
+                 / (2.*p*p*p));
+        r = std::min(std::max(r, -1.), 1.);
+        eigMin = q + 2.*p*std::cos(std::acos(r) / 3. + 2.*M_PI/3.);
+    }
+
+    // the rows of the symmetric matrix (A - eigMin*I) span the orthogonal
+    // complement of its null space, so the largest cross product of two
+    // rows points along the sought eigenvector
+    const math::Point3 r0(a - eigMin, d, f);
+    const math::Point3 r1(d, b - eigMin, e);
+    const math::Point3 r2(f, e, c - eigMin);
+
+    const math::Point3 c01(math::crossProduct(r0, r1));
+    const math::Point3 c02(math::crossProduct(r0, r2));
+    const math::Point3 c12(math::crossProduct(r1, r2));
+
+    double best(inner_prod(c01, c01));
+    math::Point3 bestVec(c01);
+    if (inner_prod(c02, c02) > best) {
+        best = inner_prod(c02, c02); bestVec = c02;
+    }
+    if (inner_prod(c12, c12) > best) {
+        best = inner_prod(c12, c12); bestVec = c12;
+    }
+
+    if (best < 1e-32) {
+        // (nearly) repeated smallest eigenvalue: isotropic data, any
+        // direction in the degenerate subspace is as good as another
+        return math::Point3(0., 0., 1.);
+    }
+
+    return bestVec / std::sqrt(best);
+}
+
 namespace {
 
     class BvhDisk : public BvhPrimitive {
@@ -205,4 +272,99 @@ void reorientNormals(const std::vector<math::Point3>& pc
     }
 }
 
+void reorientNormalsMst(const std::vector<math::Point3>& pc
+                        , std::vector<math::Point3>& normals
+                        , const double pointRadius)
+{
+    const std::size_t nPoints(pc.size());
+    if (!nPoints) { return; }
+
+    LOG(info2) << "Building kd-tree for " << nPoints << " points";
+    KdTree<math::Point3, 3> tree(pc.begin(), pc.end());
+
+    // neighborhood graph: points whose patches overlap
+    LOG(info2) << "Collecting neighborhoods";
+    std::vector<std::vector<std::uint32_t>> graph(nPoints);
+    std::vector<math::Points3::const_iterator> neighs;
+    UTILITY_OMP(parallel for private(neighs))
+    for (int64_t i = 0; i < (int64_t)nPoints; ++i) {
+        neighs.clear();
+        tree.range(pc[i], 2 * pointRadius, neighs);
+
+        auto& adj(graph[i]);
+        adj.reserve(neighs.size());
+        for (const auto& n : neighs) {
+            const std::uint32_t j = std::uint32_t(n - pc.begin());
+            if (j != std::uint32_t(i)) {
+                adj.push_back(j);
+            }
+        }
+    }
+
+    // process seeds from the top down; the topmost point of every
+    // connected component is assumed to face upward (a roof), the same
+    // assumption the ray-voting engine starts from
+    std::vector<std::uint32_t> orderZ(nPoints);
+    std::copy(boost::counting_iterator<std::uint32_t>(0)
+              , boost::counting_iterator<std::uint32_t>(nPoints)
+              , orderZ.begin());
+    std::sort(orderZ.begin(), orderZ.end()
+              , [&](std::uint32_t i1, std::uint32_t i2) { return pc[i1](2) > pc[i2](2); });
+
+    /** Edge of the neighborhood graph, ordered for a min-heap. The
+     *  weight 1 - |n_i . n_j| is invariant under flips, so it is
+     *  computed on the fly from the current normals.
+     */
+    struct Edge {
+        double weight;
+        std::uint32_t parent, child;
+
+        bool operator<(const Edge& e) const { return weight > e.weight; }
+    };
+
+    LOG(info2) << "Propagating orientation along the minimum spanning tree";
+    std::vector<uint8_t> visited(nPoints, false);
+    std::priority_queue<Edge> queue;
+    std::size_t components(0);
+
+    const auto visit([&](std::uint32_t i) {
+        visited[i] = true;
+        for (std::uint32_t j : graph[i]) {
+            if (!visited[j]) {
+                queue.push(Edge{
+                    1. - std::fabs(inner_prod(normals[i], normals[j]))
+                    , i, j });
+            }
+        }
+    });
+
+    for (std::uint32_t seed : orderZ) {
+        if (visited[seed]) { continue; }
+        ++components;
+
+        // component seed: orient upward
+        if (normals[seed](2) < 0.) {
+            normals[seed] *= -1;
+        }
+        visit(seed);
+
+        // Prim's algorithm: always attach the unvisited point whose
+        // normal agrees best with a point already in the tree and flip
+        // it to match its tree parent
+        while (!queue.empty()) {
+            const Edge edge(queue.top());
+            queue.pop();
+            if (visited[edge.child]) { continue; }
+
+            if (inner_prod(normals[edge.parent], normals[edge.child]) < 0.) {
+                normals[edge.child] *= -1;
+            }
+            visit(edge.child);
+        }
+    }
+
+    LOG(info2) << "Oriented " << nPoints << " normals in "
+               << components << " component(s)";
+}
+
 } // namespace geometry
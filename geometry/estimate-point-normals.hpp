@@ -54,6 +54,15 @@ namespace geometry {
  **/
 Eigen::VectorXd estimateNormal(const Eigen::MatrixXd& data);
 
+/**
+ * Specialized fixed-size counterpart of estimateNormal() for the 3-D case:
+ * takes the 3x3 covariance matrix as its six unique elements
+ * (xx, xy, xz, yy, yz, zz) and returns the unit eigenvector belonging to
+ * the smallest eigenvalue, computed with an analytic symmetric 3x3
+ * eigensolver -- no heap allocation and no general SVD.
+ **/
+math::Point3 estimateNormal3(const double (&cov)[6]);
+
 /**
  *  Interface to access dimension values of a point, and to calculate the
  *  difference of two points.
@@ -163,7 +172,36 @@ std::vector<T> estimateNormals(const std::vector<T>& pointCloud,
             setZeros(normal);
             continue;
         }
-        
+
+        if (K == 3) {
+            // specialized 3-D path: accumulate the 3x3 covariance over the
+            // neighbor list (simple enough for the compiler to vectorize)
+            // and hand it to the analytic eigensolver; avoids a per-point
+            // dynamic matrix and JacobiSVD
+            double mx(0.), my(0.), mz(0.);
+            for (const auto& n : neighbors) {
+                mx += A::get(n.first, 0);
+                my += A::get(n.first, 1);
+                mz += A::get(n.first, 2);
+            }
+            mx /= nNeighs; my /= nNeighs; mz /= nNeighs;
+
+            double cov[6] = { 0., 0., 0., 0., 0., 0. };
+            for (const auto& n : neighbors) {
+                const double x(A::get(n.first, 0) - mx);
+                const double y(A::get(n.first, 1) - my);
+                const double z(A::get(n.first, 2) - mz);
+                cov[0] += x * x; cov[1] += x * y; cov[2] += x * z;
+                cov[3] += y * y; cov[4] += y * z; cov[5] += z * z;
+            }
+
+            const math::Point3 n3(estimateNormal3(cov));
+            for (unsigned t = 0; t < K; ++t) {
+                A::set(normal, t, n3(t));
+            }
+            continue;
+        }
+
         Eigen::MatrixXd samples(nNeighs, K);
         for (size_t j = 0; j < nNeighs; ++j)
         {
@@ -188,6 +226,30 @@ void reorientNormals(const std::vector<math::Point3>& pointCloud
                      , std::vector<math::Point3>& normals
                      , double pointRadius);
 
+/**
+ * @brief Orients normals by propagation along a minimum spanning tree.
+ *
+ * Builds a neighborhood graph over the cloud (points whose patches
+ * overlap, i.e. within 2*pointRadius -- the same assumption
+ * reorientNormals() makes in its consistency pass), weights each edge
+ * by normal disagreement (1 - |n_i . n_j|) and propagates orientation
+ * from the topmost point of every connected component along the
+ * minimum spanning tree (Hoppe et al., 1992).
+ *
+ * One graph pass instead of per-point global ray casting: much faster
+ * on large clouds and more robust in cavities, where occlusion fools
+ * the ray vote. Open scenes with strong backface visibility may still
+ * prefer the ray-voting reorientNormals().
+ *
+ * @param pointCloud  Input point cloud
+ * @param normals     Estimated normals (with undetermined orientation) for each point
+ * @param pointRadius Radius of a patch associated with each point. Must be large enough
+ *                    for the point patches to overlap and cover the surface.
+ */
+void reorientNormalsMst(const std::vector<math::Point3>& pointCloud
+                        , std::vector<math::Point3>& normals
+                        , double pointRadius);
+
 } // geometry
 
 #endif // ESTIMATE_POINT_NORMALS_HPP_INCLUDED
@@ -160,9 +160,10 @@ const auto initialized([]() -> bool
 
 } // namespace
 
-// The main reordering function
-bool forsythReorder(int *triOrder, const ForsythVertexIndexType *indices,
-                    int nTriangles, int nVertices)
+// The main reordering function; works with any integral vertex index type
+template <typename VertexIndexType>
+bool forsythReorderImpl(int *triOrder, const VertexIndexType *indices,
+                        int nTriangles, int nVertices)
 {
     if (!initialized) { return false; }
 
@@ -353,4 +354,16 @@ bool forsythReorder(int *triOrder, const ForsythVertexIndexType *indices,
     return true;
 }
 
+bool forsythReorder(int *triOrder, const ForsythVertexIndexType *indices,
+                    int nTriangles, int nVertices)
+{
+    return forsythReorderImpl(triOrder, indices, nTriangles, nVertices);
+}
+
+bool forsythReorder(int *triOrder, const std::uint32_t *indices,
+                    int nTriangles, int nVertices)
+{
+    return forsythReorderImpl(triOrder, indices, nTriangles, nVertices);
+}
+
 } // namespace geometry
@@ -45,6 +45,10 @@ typedef std::uint16_t ForsythVertexIndexType;
 bool forsythReorder(int *triOrder, const ForsythVertexIndexType *indices
                     , int nTriangles, int nVertices);
 
+/** 32-bit index overload for meshes with more than 65535 vertices. */
+bool forsythReorder(int *triOrder, const std::uint32_t *indices
+                    , int nTriangles, int nVertices);
+
 } // namespace geometry
 
 #endif // geometry_forsyth_hpp_included
@@ -0,0 +1,341 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ *  @file kdtree-mmapped.hpp
+ *
+ *  Serialized kd-tree with instant memory-mapped reload.
+ *
+ *  The file holds the points in implicit median order: the point of a
+ *  subtree over range [lo, hi) is at lo + (hi - lo) / 2, the left
+ *  subtree occupies [lo, median), the right one (median, hi). That is
+ *  exactly the arrangement KdTree's builder produces in its scratch
+ *  array, so there are no node records and no pointers to fix up --
+ *  queries run directly on the mapped pages and loading costs one mmap
+ *  regardless of tree size.
+ *
+ *  Layout (all values little endian, native doubles):
+ *
+ *      magic[8]            "KD.TREE."
+ *      uint32              version (1)
+ *      uint32              dimensions (K)
+ *      uint64              point count
+ *      double[count * K]   points in implicit median order
+ *
+ *  Requires Boost.IOStreams (GEOMETRY_HAS_BIO).
+ */
+
+#ifndef geometry_kdtree_mmapped_hpp_included_
+#define geometry_kdtree_mmapped_hpp_included_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+#include "error.hpp"
+#include "kdtree.hpp"
+
+namespace geometry {
+
+namespace detail {
+
+const char KDTREE_MAGIC[8] = {'K', 'D', '.', 'T', 'R', 'E', 'E', '.'};
+const std::uint32_t KDTREE_VERSION = 1;
+const std::size_t KDTREE_HEADER_SIZE = 24;
+
+} // namespace detail
+
+/** Read-only kd-tree view over a memory-mapped file written by save().
+ *  Supports the same nearest/range/rangeVisit queries as KdTree; points
+ *  come out as std::array<double, K>.
+ */
+template <unsigned int K = 3>
+class MmappedKdTree {
+public:
+    typedef std::array<double, K> Point;
+    typedef std::size_t size_type;
+
+    MmappedKdTree(const boost::filesystem::path &path)
+        : file_(std::make_shared<boost::iostreams::mapped_file_source>
+                (path.string()))
+    {
+        if (!file_->is_open()) {
+            LOGTHROW(err1, std::runtime_error)
+                << "Cannot map kd-tree file " << path << ".";
+        }
+
+        const char *data(file_->data());
+        const std::size_t size(file_->size());
+
+        if ((size < detail::KDTREE_HEADER_SIZE)
+            || std::memcmp(data, detail::KDTREE_MAGIC
+                           , sizeof(detail::KDTREE_MAGIC)))
+        {
+            LOGTHROW(err1, BadFileFormat)
+                << "File " << path << " is not a kd-tree file.";
+        }
+
+        std::uint32_t version, dims;
+        std::uint64_t count;
+        std::memcpy(&version, data + 8, sizeof(version));
+        std::memcpy(&dims, data + 12, sizeof(dims));
+        std::memcpy(&count, data + 16, sizeof(count));
+
+        if (version != detail::KDTREE_VERSION) {
+            LOGTHROW(err1, VersionError)
+                << "File " << path << " has unsupported kd-tree version ("
+                << version << ").";
+        }
+        if (dims != K) {
+            LOGTHROW(err1, BadFileFormat)
+                << "File " << path << " holds a " << dims
+                << "-dimensional kd-tree, expected " << K << ".";
+        }
+        if (size < detail::KDTREE_HEADER_SIZE + count * K * sizeof(double))
+        {
+            LOGTHROW(err1, BadFileFormat)
+                << "File " << path << " is truncated.";
+        }
+
+        points_ = reinterpret_cast<const double*>
+            (data + detail::KDTREE_HEADER_SIZE);
+        size_ = count;
+    }
+
+    size_type size() const { return size_; }
+
+    /** Point at serialized position index (implicit median order). */
+    Point point(size_type index) const {
+        Point p;
+        std::memcpy(p.data(), points_ + index * K, sizeof(p));
+        return p;
+    }
+
+    /** Finds the nearest neighbor of query; dist2 is filled with the
+     *  square of the distance. Returns the index of the point, or
+     *  size() when the tree is empty.
+     */
+    template <bool IgnoreEqual = false>
+    size_type nearest(const Point &query, double &dist2) const {
+        dist2 = INFINITY;
+        size_type result(size_);
+        if (size_) { nearestImpl<IgnoreEqual>(query, 0, size_, 0
+                                              , result, dist2); }
+        return dist2 == INFINITY ? size_ : result;
+    }
+
+    /** Calls visitor(index, distance^2) for every point within radius
+     *  of query.
+     */
+    template <bool IgnoreEqual = false, typename Visitor>
+    void rangeVisit(const Point &query, double radius
+                    , Visitor &&visitor) const
+    {
+        if (size_) {
+            rangeVisitImpl<IgnoreEqual>(query, radius, 0, size_, 0
+                                        , visitor);
+        }
+    }
+
+    /** Returns all points that are within radius from query. */
+    template <bool IgnoreEqual = false>
+    std::vector<Point> range(const Point &query, double radius) const {
+        std::vector<Point> result;
+        rangeVisit<IgnoreEqual>(query, radius
+                                , [&](size_type index, double) {
+                                    result.push_back(point(index));
+                                });
+        return result;
+    }
+
+    /** Serializes points [beg, end) into the mmappable layout;
+     *  coordinates are read through getter (see GetCoordinate).
+     */
+    template <typename Iterator, typename G>
+    static void save(const boost::filesystem::path &path
+                     , Iterator beg, Iterator end, const G &getter)
+    {
+        std::vector<Point> points;
+        points.reserve(std::distance(beg, end));
+        for (Iterator i(beg); i != end; ++i) {
+            Point p;
+            for (unsigned int axis(0); axis < K; ++axis) {
+                p[axis] = getter.get(*i, axis);
+            }
+            points.push_back(p);
+        }
+
+        arrange(points.begin(), points.end(), 0);
+
+        std::ofstream file;
+        file.exceptions(std::ios::badbit | std::ios::failbit);
+        file.open(path.string(), std::ios::binary | std::ios::trunc);
+
+        const std::uint32_t version(detail::KDTREE_VERSION), dims(K);
+        const std::uint64_t count(points.size());
+        file.write(detail::KDTREE_MAGIC, sizeof(detail::KDTREE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&version)
+                   , sizeof(version));
+        file.write(reinterpret_cast<const char*>(&dims), sizeof(dims));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        if (count) {
+            file.write(reinterpret_cast<const char*>(points[0].data())
+                       , count * sizeof(Point));
+        }
+        file.close();
+    }
+
+    template <typename Iterator>
+    static void save(const boost::filesystem::path &path
+                     , Iterator beg, Iterator end)
+    {
+        typedef typename std::iterator_traits<Iterator>::value_type T;
+        save(path, beg, end, GetCoordinate<T>());
+    }
+
+private:
+    /** Places the median of every subtree at its implicit position. */
+    static void arrange(typename std::vector<Point>::iterator beg
+                        , typename std::vector<Point>::iterator end
+                        , unsigned int axis)
+    {
+        if (end - beg < 2) { return; }
+
+        auto median(beg + (end - beg) / 2);
+        std::nth_element(beg, median, end
+                         , [axis](const Point &a, const Point &b)
+                         { return a[axis] < b[axis]; });
+
+        const unsigned int next((axis + 1) % K);
+        arrange(beg, median, next);
+        arrange(median + 1, end, next);
+    }
+
+    double coord(size_type index, unsigned int axis) const {
+        return points_[index * K + axis];
+    }
+
+    double squaredDistance(const Point &query, size_type index) const {
+        double dist2(0.0);
+        for (unsigned int axis(0); axis < K; ++axis) {
+            const double d(query[axis] - coord(index, axis));
+            dist2 += d * d;
+        }
+        return dist2;
+    }
+
+    template <bool IgnoreEqual>
+    void nearestImpl(const Point &query, size_type lo, size_type hi
+                     , unsigned int axis
+                     , size_type &result, double &dist2) const
+    {
+        const size_type median(lo + (hi - lo) / 2);
+
+        double d2(squaredDistance(query, median));
+        if (IgnoreEqual && d2 == 0.0) { d2 = INFINITY; }
+        if (d2 < dist2) {
+            dist2 = d2;
+            result = median;
+        }
+
+        // leaf
+        if (hi - lo < 2) { return; }
+
+        // perpendicular distance to node boundary
+        const double perp(query[axis] - coord(median, axis));
+        const unsigned int next((axis + 1) % K);
+
+        // search the near side of the tree first
+        const bool left(perp < 0);
+        if (left ? (median > lo) : (median + 1 < hi)) {
+            if (left) {
+                nearestImpl<IgnoreEqual>(query, lo, median, next
+                                         , result, dist2);
+            } else {
+                nearestImpl<IgnoreEqual>(query, median + 1, hi, next
+                                         , result, dist2);
+            }
+
+            // no need to cross the boundary when the found distance is
+            // smaller than the perpendicular distance to it
+            if (dist2 < perp * perp) { return; }
+        }
+
+        if (left ? (median + 1 < hi) : (median > lo)) {
+            if (left) {
+                nearestImpl<IgnoreEqual>(query, median + 1, hi, next
+                                         , result, dist2);
+            } else {
+                nearestImpl<IgnoreEqual>(query, lo, median, next
+                                         , result, dist2);
+            }
+        }
+    }
+
+    template <bool IgnoreEqual, typename Visitor>
+    void rangeVisitImpl(const Point &query, double radius
+                        , size_type lo, size_type hi, unsigned int axis
+                        , Visitor &visitor) const
+    {
+        const size_type median(lo + (hi - lo) / 2);
+
+        const double dist2(squaredDistance(query, median));
+        if (dist2 <= radius * radius) {
+            if (!IgnoreEqual || dist2 > 0.0) { visitor(median, dist2); }
+        }
+
+        if (hi - lo < 2) { return; }
+
+        const double perp(query[axis] - coord(median, axis));
+        const unsigned int next((axis + 1) % K);
+
+        if ((median > lo) && (perp <= +radius)) {
+            rangeVisitImpl<IgnoreEqual>(query, radius, lo, median, next
+                                        , visitor);
+        }
+        if ((median + 1 < hi) && (perp >= -radius)) {
+            rangeVisitImpl<IgnoreEqual>(query, radius, median + 1, hi
+                                        , next, visitor);
+        }
+    }
+
+    std::shared_ptr<boost::iostreams::mapped_file_source> file_;
+    const double *points_;
+    size_type size_;
+};
+
+} // namespace geometry
+
+#endif // geometry_kdtree_mmapped_hpp_included_
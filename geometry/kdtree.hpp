@@ -39,13 +39,21 @@
 
 #include <vector>
 #include <algorithm>
+#include <array>
 #include <utility>
 #include <cmath>
+#include <cstdint>
+#include <future>
+#include <thread>
 
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include "utility/openmp.hpp"
+
+#include "perfcounters.hpp"
+
 
 namespace geometry {
 
@@ -77,6 +85,30 @@ double samplingDelta(const KdTree<T, K, G, C> &tree
 
 struct IntrusiveKdTree {};
 
+/** Parallel bulk-build mode. The tree is built by task-based recursion over
+ *  subtrees: the top log2(nThreads) levels fork one asynchronous task per
+ *  subtree, deeper levels build serially. Median selection uses
+ *  std::nth_element instead of a full sort at every node.
+ *
+ *  nThreads == 0 means use all hardware threads.
+ */
+struct KdTreeParallel {
+    explicit KdTreeParallel(unsigned int nThreads = 0)
+        : nThreads(nThreads ? nThreads
+                   : std::max(1u, std::thread::hardware_concurrency()))
+    {}
+
+    /** Number of tree levels where subtree construction forks a task.
+     */
+    int splitDepth() const {
+        int depth(0);
+        for (unsigned int t(1); t < nThreads; t *= 2) { ++depth; }
+        return depth;
+    }
+
+    unsigned int nThreads;
+};
+
 namespace detail {
 
 /**
@@ -161,6 +193,108 @@ public:
         }
     }
 
+    KdTreeNode(typename Indirect::iterator beg
+               , typename Indirect::iterator end
+               , const KdTreeParallel &parallel
+               , int depth = 0, int splitDepth = -1)
+        : sons { nullptr, nullptr }
+    {
+        if (splitDepth < 0) { splitDepth = parallel.splitDepth(); }
+
+        // trivial case - just one point
+        if (beg + 1 >= end) {
+            point = *beg;
+            return;
+        }
+
+        // place the median by one of the coordinates; no need to fully sort
+        unsigned int axis = depth % K;
+        auto count(std::distance(beg, end));
+        auto median(beg + count / 2);
+        std::nth_element(beg, median, end
+                         , [axis, this](const iterator &a, const iterator &b)
+                         { return (this->G::get(*a, axis)
+                                   < this->G::get(*b, axis)); });
+        point = *median;
+
+        // create two subtrees (points smaller and larger than the median);
+        // fork a task for the first subtree while budget lasts
+        if (splitDepth > 0) {
+            std::future<KdTreeNode*> left;
+            if (median > beg) {
+                left = std::async(std::launch::async, [&]() {
+                    return new KdTreeNode(beg, median, parallel
+                                          , depth + 1, splitDepth - 1);
+                });
+            }
+            if (median + 1 < end) {
+                sons[1] = new KdTreeNode(median + 1, end, parallel
+                                         , depth + 1, splitDepth - 1);
+            }
+            if (left.valid()) { sons[0] = left.get(); }
+            return;
+        }
+
+        if (median > beg) {
+            sons[0] = new KdTreeNode(beg, median, parallel, depth + 1, 0);
+        }
+        if (median + 1 < end) {
+            sons[1] = new KdTreeNode(median + 1, end, parallel, depth + 1, 0);
+        }
+    }
+
+    KdTreeNode(mutable_iterator beg, mutable_iterator end
+               , const IntrusiveKdTree &intrusive
+               , const KdTreeParallel &parallel
+               , int depth = 0, int splitDepth = -1)
+        : sons { nullptr, nullptr }
+    {
+        if (splitDepth < 0) { splitDepth = parallel.splitDepth(); }
+
+        // trivial case - just one point
+        if (beg + 1 >= end) {
+            point = beg;
+            return;
+        }
+
+        // place the median by one of the coordinates; no need to fully sort
+        unsigned int axis = depth % K;
+        auto count(std::distance(beg, end));
+        auto median(beg + count / 2);
+        std::nth_element(beg, median, end
+                         , [axis, this](const T &a, const T &b)
+                         { return (this->G::get(a, axis)
+                                   < this->G::get(b, axis)); });
+        point = median;
+
+        // create two subtrees (points smaller and larger than the median);
+        // fork a task for the first subtree while budget lasts
+        if (splitDepth > 0) {
+            std::future<KdTreeNode*> left;
+            if (median > beg) {
+                left = std::async(std::launch::async, [&]() {
+                    return new KdTreeNode(beg, median, intrusive, parallel
+                                          , depth + 1, splitDepth - 1);
+                });
+            }
+            if (median + 1 < end) {
+                sons[1] = new KdTreeNode(median + 1, end, intrusive, parallel
+                                         , depth + 1, splitDepth - 1);
+            }
+            if (left.valid()) { sons[0] = left.get(); }
+            return;
+        }
+
+        if (median > beg) {
+            sons[0] = new KdTreeNode(beg, median, intrusive, parallel
+                                     , depth + 1, 0);
+        }
+        if (median + 1 < end) {
+            sons[1] = new KdTreeNode(median + 1, end, intrusive, parallel
+                                     , depth + 1, 0);
+        }
+    }
+
     /**
      *  Finds the nearest neighbor of the point "query" (this is a general point
      *  which doesn't need to be in the tree). Returns the closest point from
@@ -172,6 +306,7 @@ public:
         const
     {
         // calculate the squared distance between query and us
+        GEOMETRY_PERF_ADD(perf::Counter::kdtreeNodesVisited, 1);
         difference_type diff(G::diff(query, *point));
         dist2 = inner_prod(diff, diff);
 
@@ -224,6 +359,63 @@ public:
         return result;
     }
 
+    /**
+     *  Finds the k nearest neighbors of "query". "heap" is kept as a
+     *  max-heap (by distance^2) of at most k (point, distance^2) pairs;
+     *  passing it in lets callers reuse its storage between queries.
+     */
+    template<bool IgnoreEqual>
+    void knn(const T& query, std::size_t k
+             , std::vector<std::pair<T, double> > &heap
+             , unsigned int axis = 0) const
+    {
+        const auto heapCmp([](const std::pair<T, double> &l
+                              , const std::pair<T, double> &r)
+                           { return l.second < r.second; });
+
+        // calculate the squared distance between query and us
+        GEOMETRY_PERF_ADD(perf::Counter::kdtreeNodesVisited, 1);
+        difference_type diff(G::diff(query, *point));
+        double dist2 = inner_prod(diff, diff);
+
+        if (!IgnoreEqual || dist2 > 0.0) {
+            if (heap.size() < k) {
+                heap.emplace_back(*point, dist2);
+                std::push_heap(heap.begin(), heap.end(), heapCmp);
+            } else if (dist2 < heap.front().second) {
+                std::pop_heap(heap.begin(), heap.end(), heapCmp);
+                heap.back() = std::make_pair(*point, dist2);
+                std::push_heap(heap.begin(), heap.end(), heapCmp);
+            }
+        }
+
+        // if this is a leaf, we're done
+        if (!sons[0] && !sons[1]) { return; }
+
+        // perpendicular distance to node boundary
+        double perp = G::get(query, axis) - G::get(*point, axis);
+
+        // change axis
+        if (++axis >= K) {
+            axis = 0;
+        }
+
+        // search the near side of the tree first
+        unsigned int side = (perp < 0) ? 0 : 1;
+        if (sons[side]) {
+            sons[side]->template knn<IgnoreEqual>(query, k, heap, axis);
+        }
+
+        // the far side can be skipped once we hold k neighbors all closer
+        // than the boundary
+        side ^= 1;
+        if (sons[side]
+            && ((heap.size() < k) || (perp * perp < heap.front().second)))
+        {
+            sons[side]->template knn<IgnoreEqual>(query, k, heap, axis);
+        }
+    }
+
     /**
      *  Returns all points that are within "radius" from "query".
      */
@@ -232,6 +424,7 @@ public:
                std::vector<T>& result, unsigned int axis = 0) const
     {
         // return point if it is within radius
+        GEOMETRY_PERF_ADD(perf::Counter::kdtreeNodesVisited, 1);
         difference_type diff(G::diff(query, *point));
         double dist2 = inner_prod(diff, diff);
         if (dist2 <= radius*radius) {
@@ -265,7 +458,8 @@ public:
               std::vector<iterator>& result, unsigned int axis = 0) const
     {
        // return point if it is within radius
-       difference_type diff(G::diff(query, *point));
+        GEOMETRY_PERF_ADD(perf::Counter::kdtreeNodesVisited, 1);
+        difference_type diff(G::diff(query, *point));
        double dist2 = inner_prod(diff, diff);
        if (dist2 <= radius*radius) {
            if (!IgnoreEqual || dist2 > 0.0)
@@ -299,6 +493,7 @@ public:
                , unsigned int axis = 0) const
     {
         // return point if it is within radius
+        GEOMETRY_PERF_ADD(perf::Counter::kdtreeNodesVisited, 1);
         difference_type diff(G::diff(query, *point));
         double dist2 = inner_prod(diff, diff);
         if (dist2 <= radius*radius) {
@@ -323,6 +518,43 @@ public:
         }
     }
 
+    /**
+     *  Calls visitor(point, distance^2) for every point within "radius"
+     *  from "query". Nothing is materialized, so folds over a
+     *  neighborhood (counting, averaging) run without allocation.
+     */
+    template<bool IgnoreEqual, typename Visitor>
+    void rangeVisit(const T& query, double radius
+                    , Visitor &visitor, unsigned int axis = 0) const
+    {
+        // visit point if it is within radius
+        GEOMETRY_PERF_ADD(perf::Counter::kdtreeNodesVisited, 1);
+        difference_type diff(G::diff(query, *point));
+        double dist2 = inner_prod(diff, diff);
+        if (dist2 <= radius*radius) {
+            if (!IgnoreEqual || dist2 > 0.0)
+                visitor(*point, dist2);
+        }
+
+        // perpendicular distance to node boundary
+        double perp = G::get(query, axis) - G::get(*point, axis);
+
+        // change axis
+        if (++axis >= K) {
+            axis = 0;
+        }
+
+        // recurse to sub-trees if they are within radius
+        if (sons[0] && perp <= +radius) {
+            sons[0]->template rangeVisit<IgnoreEqual>(query, radius
+                                                      , visitor, axis);
+        }
+        if (sons[1] && perp >= -radius) {
+            sons[1]->template rangeVisit<IgnoreEqual>(query, radius
+                                                      , visitor, axis);
+        }
+    }
+
     ~KdTreeNode() {
         delete sons[0];
         delete sons[1];
@@ -348,6 +580,11 @@ protected:
 
 } // namespace detail
 
+/** Default coordinate accessor. Scalar-generic: value_type and
+ *  difference_type follow the point type, so double and float points
+ *  (e.g. FloatMesh vertices) work alike with no runtime dispatch;
+ *  distance accumulation always happens in double (see inner_prod).
+ */
 template <typename T>
 struct GetCoordinate {
     typedef typename T::value_type value_type;
@@ -412,6 +649,36 @@ public:
         root_.reset(new node_type(beg, end, intrusive));
     }
 
+    /** Parallel bulk build; see KdTreeParallel.
+     */
+    KdTree(const iterator &beg, const iterator &end
+           , const KdTreeParallel &parallel)
+        : begin_(beg), end_(end), size_(std::distance(beg, end))
+    {
+        if (!size_) { return; }
+
+        typename node_type::Indirect indirect;
+        indirect.reserve(std::distance(beg, end));
+        for (iterator i(beg) ; i != end; ++i) {
+            indirect.push_back(i);
+        }
+
+        root_.reset(new node_type(indirect.begin(), indirect.end()
+                                  , parallel));
+    }
+
+    /** Parallel bulk build of intrusive tree; see KdTreeParallel.
+     */
+    KdTree(const mutable_iterator &beg, const mutable_iterator &end
+           , const IntrusiveKdTree &intrusive
+           , const KdTreeParallel &parallel)
+        : begin_(beg), end_(end), size_(std::distance(beg, end))
+    {
+        if (!size_) { return; }
+
+        root_.reset(new node_type(beg, end, intrusive, parallel));
+    }
+
     iterator begin() const { return begin_; }
     iterator end() const { return end_; }
 
@@ -427,6 +694,55 @@ public:
         return root_->template nearest<IgnoreEqual>(query, dist2);
     }
 
+    /** Find k nearest neighbors of query.
+     *
+     *  Result is cleared and filled with (point, distance^2) pairs sorted by
+     *  ascending distance; its storage doubles as the traversal heap so a
+     *  buffer reused between calls makes the query allocation-free.
+     */
+    template<bool IgnoreEqual = false>
+    void nearest(const T& query, size_type k, Neighbors &result) const
+    {
+        result.clear();
+        if (!root_ || !k) { return; }
+
+        root_->template knn<IgnoreEqual>(query, k, result);
+        std::sort_heap(result.begin(), result.end()
+                       , [](const Neighbor &l, const Neighbor &r)
+                       { return l.second < r.second; });
+    }
+
+    /** Batched k-nearest-neighbor queries.
+     *
+     *  Fills results[i] with the k nearest neighbors of queries[i] (same
+     *  format as single-query nearest(query, k, result)). Queries are
+     *  processed in order sorted along the first axis so consecutive
+     *  queries walk similar tree paths; the loop is parallelized via
+     *  OpenMP when enabled. Per-query result buffers keep their capacity,
+     *  i.e. a results vector reused between batches is allocation-free.
+     */
+    template<bool IgnoreEqual = false>
+    void nearestBatch(const std::vector<T> &queries, size_type k
+                      , std::vector<Neighbors> &results) const
+    {
+        results.resize(queries.size());
+
+        // process queries sorted along the first axis: consecutive queries
+        // then visit overlapping parts of the tree while they are hot
+        std::vector<std::size_t> order(queries.size());
+        for (std::size_t i(0); i != order.size(); ++i) { order[i] = i; }
+        std::sort(order.begin(), order.end()
+                  , [&queries](std::size_t a, std::size_t b)
+                  { return (G().get(queries[a], 0)
+                            < G().get(queries[b], 0)); });
+
+        UTILITY_OMP(parallel for schedule(dynamic, 1024))
+        for (std::int64_t oi = 0; oi < std::int64_t(order.size()); ++oi) {
+            const auto qi(order[oi]);
+            nearest<IgnoreEqual>(queries[qi], k, results[qi]);
+        }
+    }
+
     template<bool IgnoreEqual = false>
     std::vector<T> range(const T& query, double radius) const {
         std::vector<T> result;
@@ -465,6 +781,57 @@ public:
         return root_->template range<IgnoreEqual>(query, radius, result);
     }
 
+    /** Visitor-based range query: calls visitor(point, distance^2) for
+     *  every point within radius of query, without materializing a
+     *  result vector.
+     */
+    template<bool IgnoreEqual = false, typename Visitor>
+    void rangeVisit(const T& query, double radius, Visitor &&visitor) const
+    {
+        if (!root_) { return; }
+        root_->template rangeVisit<IgnoreEqual>(query, radius, visitor);
+    }
+
+    /** Number of points within radius of query.
+     */
+    template<bool IgnoreEqual = false>
+    size_type rangeCount(const T& query, double radius) const
+    {
+        size_type count(0);
+        rangeVisit<IgnoreEqual>(query, radius
+                                , [&count](const T&, double) { ++count; });
+        return count;
+    }
+
+    /** Centroid of the points within radius of query, one coordinate per
+     *  axis. Returns the number of points folded in; centroid is left
+     *  untouched when it is zero.
+     */
+    template<bool IgnoreEqual = false>
+    size_type rangeCentroid(const T& query, double radius
+                            , std::array<double, K> &centroid) const
+    {
+        std::array<double, K> sum;
+        sum.fill(0.0);
+
+        size_type count(0);
+        rangeVisit<IgnoreEqual>(query, radius
+                                , [&sum, &count](const T &point, double) {
+            G g;
+            for (unsigned int axis(0); axis < K; ++axis) {
+                sum[axis] += g.get(point, axis);
+            }
+            ++count;
+        });
+
+        if (count) {
+            for (unsigned int axis(0); axis < K; ++axis) {
+                centroid[axis] = sum[axis] / count;
+            }
+        }
+        return count;
+    }
+
 private:
     boost::shared_ptr<node_type> root_;
     iterator begin_;
@@ -484,8 +851,11 @@ inline double samplingDelta(const KdTree<T, K, G, C> &tree
         distances.push_back(tree.template nearest<true>(point).second);
     }
 
-    std::sort(distances.begin(), distances.end());
-    return std::sqrt(distances[distances.size() * bulkThreshold]);
+    // only the bulkThreshold quantile is needed, not the full ordering
+    auto nth(distances.begin()
+             + std::size_t(distances.size() * bulkThreshold));
+    std::nth_element(distances.begin(), nth, distances.end());
+    return std::sqrt(*nth);
 }
 
 } // namespace geometry
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+#include "utility/openmp.hpp"
+
+#include "mesh-adjacency.hpp"
+
+namespace geometry {
+
+void MeshAdjacency::build(const Face::list &faces)
+{
+    const std::size_t nh(3 * faces.size());
+
+    heEdge_.assign(nh, 0);
+    edgeStart_.clear();
+    edgeHalfedges_.assign(nh, 0);
+
+    if (!nh) { return; }
+
+    // pack both endpoints of every halfedge into one sortable key; the
+    // key order matches lexicographic (lower, higher) vertex pair order
+    std::vector<std::uint64_t> keys(nh);
+
+    UTILITY_OMP(parallel for schedule( static ))
+    for (std::ptrdiff_t f = 0; f < std::ptrdiff_t(faces.size()); ++f)
+    {
+        const auto &face(faces[f]);
+        const index_type v[3] = { face.a, face.b, face.c };
+        for (int i(0); i < 3; ++i) {
+            const index_type v1(std::min(v[i], v[(i + 1) % 3]));
+            const index_type v2(std::max(v[i], v[(i + 1) % 3]));
+            keys[3 * f + i] = (std::uint64_t(v1) << 32) | v2;
+        }
+    }
+
+    // halfedges ordered by key; ties keep face order, making the whole
+    // structure deterministic
+    std::vector<index_type> order(nh);
+    std::iota(order.begin(), order.end(), index_type(0));
+    std::sort(order.begin(), order.end()
+              , [&keys](index_type a, index_type b) {
+                  return (keys[a] != keys[b])
+                      ? (keys[a] < keys[b]) : (a < b);
+              });
+
+    // group runs of equal keys into undirected edges
+    std::uint64_t last(keys[order[0]] + 1);
+    for (std::size_t i(0); i < nh; ++i) {
+        const auto h(order[i]);
+        if (keys[h] != last) {
+            edgeStart_.push_back(index_type(i));
+            last = keys[h];
+        }
+        heEdge_[h] = index_type(edgeStart_.size() - 1);
+        edgeHalfedges_[i] = h;
+    }
+    edgeStart_.push_back(index_type(nh));
+}
+
+} // namespace geometry
@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ *  @file mesh-adjacency.hpp
+ *
+ *  Compact edge adjacency of a triangle mesh.
+ *
+ *  Several mesh operations (skirting, manifold repair, refinement) need
+ *  to know which faces share an edge; each used to derive that from
+ *  scratch with its own map. MeshAdjacency computes it once into flat
+ *  index arrays and is cached on the mesh, see meshAdjacency().
+ */
+
+#ifndef geometry_mesh_adjacency_hpp_included_
+#define geometry_mesh_adjacency_hpp_included_
+
+#include <memory>
+#include <vector>
+
+#include "mesh.hpp"
+
+namespace geometry {
+
+/** Edge adjacency of a triangle mesh in flat arrays.
+ *
+ * A halfedge is one directed edge of one face, numbered 3 * face +
+ * corner where corner 0 is edge a-b, 1 is b-c and 2 is c-a. Halfedges
+ * sharing an undirected edge are grouped; undirected edges are numbered
+ * in lexicographic order of their (lower, higher) vertex index pair.
+ *
+ * The structure holds face and vertex indices only and stays valid
+ * until the mesh topology changes.
+ */
+class MeshAdjacency {
+public:
+    typedef Face::index_type index_type;
+
+    MeshAdjacency() {}
+
+    template <typename T>
+    explicit MeshAdjacency(const BasicMesh<T> &mesh) { build(mesh.faces); }
+
+    /** (Re)builds adjacency from mesh faces.
+     */
+    template <typename T>
+    void build(const BasicMesh<T> &mesh) { build(mesh.faces); }
+
+    /** (Re)builds adjacency from a face list; the structure only ever
+     *  looks at indices, so it is shared by all storage scalars.
+     */
+    void build(const Face::list &faces);
+
+    /** Number of undirected edges.
+     */
+    std::size_t edgeCount() const {
+        return edgeStart_.empty() ? 0 : (edgeStart_.size() - 1);
+    }
+
+    /** Undirected edge id of the i-th edge (0: a-b, 1: b-c, 2: c-a) of
+     *  a face.
+     */
+    index_type edge(index_type face, int i) const {
+        return heEdge_[3 * face + i];
+    }
+
+    /** Halfedges sharing undirected edge e, in face order.
+     */
+    const index_type* begin(index_type e) const {
+        return edgeHalfedges_.data() + edgeStart_[e];
+    }
+
+    const index_type* end(index_type e) const {
+        return edgeHalfedges_.data() + edgeStart_[e + 1];
+    }
+
+    /** Number of faces incident with undirected edge e.
+     */
+    int faceCount(index_type e) const {
+        return int(edgeStart_[e + 1] - edgeStart_[e]);
+    }
+
+    bool boundary(index_type e) const { return faceCount(e) == 1; }
+
+    bool nonManifold(index_type e) const { return faceCount(e) > 2; }
+
+    static index_type halfedgeFace(index_type h) { return h / 3; }
+
+    static int halfedgeCorner(index_type h) { return int(h % 3); }
+
+private:
+    /** halfedge -> undirected edge id */
+    std::vector<index_type> heEdge_;
+
+    /** CSR offsets of undirected edges into edgeHalfedges_ */
+    std::vector<index_type> edgeStart_;
+
+    /** halfedges grouped by undirected edge */
+    std::vector<index_type> edgeHalfedges_;
+};
+
+/** Returns the adjacency attached to the mesh, building it on first
+ *  use. The cache is dropped by Mesh::addFace(); code mutating the face
+ *  list directly must reset mesh.adjacency itself.
+ */
+template <typename T>
+std::shared_ptr<const MeshAdjacency> meshAdjacency(const BasicMesh<T> &mesh)
+{
+    if (!mesh.adjacency) {
+        mesh.adjacency = std::make_shared<MeshAdjacency>(mesh);
+    }
+    return mesh.adjacency;
+}
+
+} // namespace geometry
+
+#endif // geometry_mesh_adjacency_hpp_included_
@@ -0,0 +1,268 @@
+/**
+ * Copyright (c) 2017 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @file mesh-soa.cpp
+ *
+ * Structure-of-arrays mesh: conversions and SoA ports of meshop hot loops.
+ */
+
+#include <limits>
+#include <unordered_map>
+
+#include "mesh-soa.hpp"
+#include "triclip.hpp"
+
+namespace geometry {
+
+SoaMesh soaMesh(const Mesh &mesh)
+{
+    SoaMesh soa;
+
+    soa.reserveVertices(mesh.vertices.size());
+    for (const auto &v : mesh.vertices) {
+        soa.vx.push_back(v(0));
+        soa.vy.push_back(v(1));
+        soa.vz.push_back(v(2));
+    }
+
+    soa.reserveTCoords(mesh.tCoords.size());
+    for (const auto &t : mesh.tCoords) {
+        soa.tu.push_back(t(0));
+        soa.tv.push_back(t(1));
+    }
+
+    soa.reserveFaces(mesh.faces.size());
+    for (const auto &f : mesh.faces) {
+        soa.fa.push_back(f.a); soa.fb.push_back(f.b); soa.fc.push_back(f.c);
+        soa.fta.push_back(f.ta); soa.ftb.push_back(f.tb);
+        soa.ftc.push_back(f.tc);
+        soa.faceImageId.push_back(f.imageId);
+    }
+
+    return soa;
+}
+
+Mesh mesh(const SoaMesh &soa)
+{
+    Mesh out;
+
+    out.vertices.reserve(soa.vertexCount());
+    for (std::size_t i(0), e(soa.vertexCount()); i != e; ++i) {
+        out.vertices.emplace_back(soa.vx[i], soa.vy[i], soa.vz[i]);
+    }
+
+    out.tCoords.reserve(soa.tCoordCount());
+    for (std::size_t i(0), e(soa.tCoordCount()); i != e; ++i) {
+        out.tCoords.emplace_back(soa.tu[i], soa.tv[i]);
+    }
+
+    out.faces.reserve(soa.faceCount());
+    for (std::size_t i(0), e(soa.faceCount()); i != e; ++i) {
+        out.addFace(soa.fa[i], soa.fb[i], soa.fc[i]
+                    , soa.fta[i], soa.ftb[i], soa.ftc[i]
+                    , soa.faceImageId[i]);
+    }
+
+    return out;
+}
+
+void append(SoaMesh &mesh, const SoaMesh &added)
+{
+    // remember indexing shifts and append vertex/tc component arrays
+    const auto vShift(SoaMesh::index_type(mesh.vertexCount()));
+    mesh.vx.insert(mesh.vx.end(), added.vx.begin(), added.vx.end());
+    mesh.vy.insert(mesh.vy.end(), added.vy.begin(), added.vy.end());
+    mesh.vz.insert(mesh.vz.end(), added.vz.begin(), added.vz.end());
+
+    const auto tcShift(SoaMesh::index_type(mesh.tCoordCount()));
+    mesh.tu.insert(mesh.tu.end(), added.tu.begin(), added.tu.end());
+    mesh.tv.insert(mesh.tv.end(), added.tv.begin(), added.tv.end());
+
+    // append faces with shifts applied; each index array is one tight loop
+    const auto fShift(mesh.faceCount());
+    mesh.reserveFaces(fShift + added.faceCount());
+
+    for (auto i : added.fa) { mesh.fa.push_back(i + vShift); }
+    for (auto i : added.fb) { mesh.fb.push_back(i + vShift); }
+    for (auto i : added.fc) { mesh.fc.push_back(i + vShift); }
+    for (auto i : added.fta) { mesh.fta.push_back(i + tcShift); }
+    for (auto i : added.ftb) { mesh.ftb.push_back(i + tcShift); }
+    for (auto i : added.ftc) { mesh.ftc.push_back(i + tcShift); }
+    mesh.faceImageId.insert(mesh.faceImageId.end()
+                            , added.faceImageId.begin()
+                            , added.faceImageId.end());
+}
+
+SoaMesh removeIsolatedVertices(const SoaMesh &imesh)
+{
+    typedef SoaMesh::index_type index_type;
+    const auto invalid(std::numeric_limits<index_type>::max());
+
+    SoaMesh out;
+
+    // old index -> new index; flat arrays instead of a std::map since we
+    // touch every face index anyway
+    std::vector<index_type> vertexMap(imesh.vertexCount(), invalid);
+    std::vector<index_type> tCoordMap(imesh.tCoordCount(), invalid);
+
+    const bool hasTc(imesh.tCoordCount() > 0);
+
+    out.reserveFaces(imesh.faceCount());
+    for (std::size_t f(0), e(imesh.faceCount()); f != e; ++f) {
+        index_type vindices[3] { imesh.fa[f], imesh.fb[f], imesh.fc[f] };
+        index_type tindices[3] { imesh.fta[f], imesh.ftb[f], imesh.ftc[f] };
+
+        for (unsigned int i(0); i < 3; ++i) {
+            auto &vm(vertexMap[vindices[i]]);
+            if (vm == invalid) {
+                vm = out.addVertex(imesh.vx[vindices[i]]
+                                   , imesh.vy[vindices[i]]
+                                   , imesh.vz[vindices[i]]);
+            }
+            vindices[i] = vm;
+
+            if (hasTc) {
+                auto &tm(tCoordMap[tindices[i]]);
+                if (tm == invalid) {
+                    tm = out.addTCoord(imesh.tu[tindices[i]]
+                                       , imesh.tv[tindices[i]]);
+                }
+                tindices[i] = tm;
+            }
+        }
+
+        out.addFace(vindices[0], vindices[1], vindices[2]
+                    , tindices[0], tindices[1], tindices[2]
+                    , imesh.faceImageId[f]);
+    }
+
+    return out;
+}
+
+namespace {
+
+/** Exact-coordinate vertex key used to weld clipper output.
+ */
+struct ClipVertexKey {
+    double x, y, z;
+
+    bool operator==(const ClipVertexKey &o) const {
+        return (x == o.x) && (y == o.y) && (z == o.z);
+    }
+};
+
+struct ClipVertexHash {
+    std::size_t operator()(const ClipVertexKey &k) const {
+        std::hash<double> h;
+        std::size_t seed(h(k.x));
+        seed ^= h(k.y) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= h(k.z) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
+void clipImpl(const SoaMesh &imesh, SoaMesh &out
+              , const std::vector<ClipPlane> &planes)
+{
+    ClipTriangle::list clipped;
+    clipped.reserve(imesh.faceCount());
+    for (std::size_t f(0), e(imesh.faceCount()); f != e; ++f) {
+        clipped.emplace_back(imesh.vertex(imesh.fa[f])
+                             , imesh.vertex(imesh.fb[f])
+                             , imesh.vertex(imesh.fc[f]));
+    }
+
+    std::vector<double> tinfos;
+    for (const auto &plane : planes) {
+        clipped = clipTriangles(clipped, plane, tinfos);
+    }
+
+    typedef SoaMesh::index_type Index;
+    std::unordered_map<ClipVertexKey, Index, ClipVertexHash> pMap;
+    pMap.reserve(3 * clipped.size());
+
+    out.reserveFaces(clipped.size());
+    for (const auto &triangle : clipped) {
+        Index indices[3];
+        for (int i = 0; i < 3; i++) {
+            const auto &p(triangle.pos[i]);
+            const ClipVertexKey key{p(0), p(1), p(2)};
+            auto pair(pMap.insert(std::make_pair
+                                  (key, Index(out.vertexCount()))));
+            if (pair.second) {
+                out.addVertex(key.x, key.y, key.z);
+            }
+            indices[i] = pair.first->second;
+        }
+
+        // do not add degenerated faces
+        if ((indices[0] != indices[1]) && (indices[1] != indices[2])
+            && (indices[0] != indices[2]))
+        {
+            out.addFace(indices[0], indices[1], indices[2]);
+        }
+    }
+}
+
+std::vector<ClipPlane> clipPlanes(const math::Extents2 &extents)
+{
+    std::vector<ClipPlane> planes;
+    planes.emplace_back(+1.,  0., 0., extents.ll[0]);
+    planes.emplace_back(-1.,  0., 0., -extents.ur[0]);
+    planes.emplace_back(0.,  +1., 0., extents.ll[1]);
+    planes.emplace_back(0.,  -1., 0., -extents.ur[1]);
+    return planes;
+}
+
+std::vector<ClipPlane> clipPlanes(const math::Extents3 &extents)
+{
+    std::vector<ClipPlane> planes;
+    planes.emplace_back(+1.,  0., 0., extents.ll[0]);
+    planes.emplace_back(-1.,  0., 0., -extents.ur[0]);
+    planes.emplace_back(0.,  +1., 0., extents.ll[1]);
+    planes.emplace_back(0.,  -1., 0., -extents.ur[1]);
+    planes.emplace_back(0.,  0., +1., extents.ll[2]);
+    planes.emplace_back(0.,  0., -1., -extents.ur[2]);
+    return planes;
+}
+
+} // namespace
+
+SoaMesh clip(const SoaMesh &mesh, const math::Extents2 &extents)
+{
+    SoaMesh out;
+    clipImpl(mesh, out, clipPlanes(extents));
+    return out;
+}
+
+SoaMesh clip(const SoaMesh &mesh, const math::Extents3 &extents)
+{
+    SoaMesh out;
+    clipImpl(mesh, out, clipPlanes(extents));
+    return out;
+}
+
+} // namespace geometry
@@ -0,0 +1,205 @@
+/**
+ * Copyright (c) 2017 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @file mesh-soa.hpp
+ *
+ * Structure-of-arrays counterpart of geometry::Mesh.
+ *
+ * geometry::Mesh stores vertices as math::Points3, i.e. one heap-allocated
+ * ublas vector per point. Per-face loops (area, barycenter, normal, clipping)
+ * then chase a pointer per coordinate access which dominates runtime on
+ * multi-million-face meshes. SoaMesh keeps each coordinate component in its
+ * own contiguous array so the same loops run over plain doubles.
+ */
+
+#ifndef geometry_mesh_soa_hpp_included_
+#define geometry_mesh_soa_hpp_included_
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "math/geometry_core.hpp"
+
+#include "mesh.hpp"
+
+namespace geometry {
+
+/** Structure-of-arrays triangle mesh.
+ *
+ * Semantically equivalent to geometry::Mesh: vertex I has coordinates
+ * (vx[I], vy[I], vz[I]) and texture coordinates (tu[I], tv[I]); face F is the
+ * triangle (fa[F], fb[F], fc[F]) with texture indices (fta[F], ftb[F],
+ * ftc[F]) and material faceImageId[F].
+ */
+struct SoaMesh {
+    typedef Face::index_type index_type;
+
+    /** vertex coordinates, one contiguous array per component */
+    std::vector<double> vx, vy, vz;
+
+    /** per-vertex texture coordinates */
+    std::vector<double> tu, tv;
+
+    /** face vertex indices */
+    std::vector<index_type> fa, fb, fc;
+
+    /** face texture coordinate indices */
+    std::vector<index_type> fta, ftb, ftc;
+
+    /** per-face image (material) identifier */
+    std::vector<unsigned int> faceImageId;
+
+    std::size_t vertexCount() const { return vx.size(); }
+    std::size_t tCoordCount() const { return tu.size(); }
+    std::size_t faceCount() const { return fa.size(); }
+
+    void reserveVertices(std::size_t n) {
+        vx.reserve(n); vy.reserve(n); vz.reserve(n);
+    }
+
+    void reserveTCoords(std::size_t n) {
+        tu.reserve(n); tv.reserve(n);
+    }
+
+    void reserveFaces(std::size_t n) {
+        fa.reserve(n); fb.reserve(n); fc.reserve(n);
+        fta.reserve(n); ftb.reserve(n); ftc.reserve(n);
+        faceImageId.reserve(n);
+    }
+
+    index_type addVertex(double x, double y, double z) {
+        vx.push_back(x); vy.push_back(y); vz.push_back(z);
+        return index_type(vx.size() - 1);
+    }
+
+    index_type addTCoord(double u, double v) {
+        tu.push_back(u); tv.push_back(v);
+        return index_type(tu.size() - 1);
+    }
+
+    void addFace(index_type a, index_type b, index_type c
+                 , index_type ta = 0, index_type tb = 0, index_type tc = 0
+                 , unsigned int imageId = 0)
+    {
+        fa.push_back(a); fb.push_back(b); fc.push_back(c);
+        fta.push_back(ta); ftb.push_back(tb); ftc.push_back(tc);
+        faceImageId.push_back(imageId);
+    }
+
+    /** Materialize single vertex. Meant for boundary code; hot loops should
+     *  read the component arrays directly.
+     */
+    math::Point3 vertex(std::size_t i) const {
+        return math::Point3(vx[i], vy[i], vz[i]);
+    }
+
+    /** Face normal (not normalized when the face is degenerate).
+     */
+    math::Point3 normal(std::size_t face) const;
+
+    /** Face area (in 3D space).
+     */
+    double area(std::size_t face) const;
+
+    /** Face barycenter.
+     */
+    math::Point3 barycenter(std::size_t face) const;
+
+    /** Is given face not a triangle?
+     */
+    bool degenerate(std::size_t face) const {
+        return ((fa[face] == fb[face]) || (fb[face] == fc[face])
+                || (fc[face] == fa[face]));
+    }
+};
+
+/** Convert AoS mesh to SoA layout. Single pass, no per-point allocations in
+ *  the result.
+ */
+SoaMesh soaMesh(const Mesh &mesh);
+
+/** Convert SoA mesh back to the classic representation.
+ */
+Mesh mesh(const SoaMesh &soa);
+
+/** SoA port of meshop append(): appends added to mesh with indices shifted.
+ */
+void append(SoaMesh &mesh, const SoaMesh &added);
+
+/** SoA port of meshop removeIsolatedVertices().
+ */
+SoaMesh removeIsolatedVertices(const SoaMesh &mesh);
+
+/** SoA port of meshop clip(): clip mesh by vertical prism around extents.
+ */
+SoaMesh clip(const SoaMesh &mesh, const math::Extents2 &extents);
+
+/** SoA port of meshop clip(): clip mesh by box.
+ */
+SoaMesh clip(const SoaMesh &mesh, const math::Extents3 &extents);
+
+// inlines
+
+inline math::Point3 SoaMesh::normal(std::size_t face) const
+{
+    const auto a(fa[face]), b(fb[face]), c(fc[face]);
+    const double ux(vx[b] - vx[a]), uy(vy[b] - vy[a]), uz(vz[b] - vz[a]);
+    const double wx(vx[c] - vx[b]), wy(vy[c] - vy[b]), wz(vz[c] - vz[b]);
+
+    const double nx(uy * wz - uz * wy);
+    const double ny(uz * wx - ux * wz);
+    const double nz(ux * wy - uy * wx);
+
+    const double len(std::sqrt(nx * nx + ny * ny + nz * nz));
+    if (!len) { return math::Point3(nx, ny, nz); }
+    return math::Point3(nx / len, ny / len, nz / len);
+}
+
+inline double SoaMesh::area(std::size_t face) const
+{
+    const auto a(fa[face]), b(fb[face]), c(fc[face]);
+    const double ux(vx[b] - vx[a]), uy(vy[b] - vy[a]), uz(vz[b] - vz[a]);
+    const double wx(vx[c] - vx[b]), wy(vy[c] - vy[b]), wz(vz[c] - vz[b]);
+
+    const double nx(uy * wz - uz * wy);
+    const double ny(uz * wx - ux * wz);
+    const double nz(ux * wy - uy * wx);
+
+    return std::sqrt(nx * nx + ny * ny + nz * nz) / 2.0;
+}
+
+inline math::Point3 SoaMesh::barycenter(std::size_t face) const
+{
+    const auto a(fa[face]), b(fb[face]), c(fc[face]);
+    return math::Point3((vx[a] + vx[b] + vx[c]) / 3.0
+                        , (vy[a] + vy[b] + vy[c]) / 3.0
+                        , (vz[a] + vz[b] + vz[c]) / 3.0);
+}
+
+} // namespace geometry
+
+#endif // geometry_mesh_soa_hpp_included_
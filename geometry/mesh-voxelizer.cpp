@@ -28,6 +28,7 @@
 
 #include "geometry/meshop.hpp"
 #include "geometry/mesh-voxelizer.hpp"
+#include "geometry/perfcounters.hpp"
 #include "math/geometry_core.hpp"
 #include "imgproc/scanconversion.hpp"
 
@@ -37,6 +38,7 @@
 #include <boost/numeric/ublas/vector.hpp>
 
 #include <algorithm>
+#include <thread>
 //#define RASTERIZE_MESH_DEBUG
 
 
@@ -52,6 +54,8 @@ void MeshVoxelizer::add( geometry::Mesh & mesh ){
 }
 
 void MeshVoxelizer::voxelize(){
+    GEOMETRY_PERF_TIMER(perf::Timer::voxelize);
+
     if(meshes.size()<=0){
         LOG( warn2 )<<"Zero meshes to voxelize. Skipping voxelization.";
         return;
@@ -135,18 +139,125 @@ void MeshVoxelizer::voxelize(){
     }
 
     LOG( info2 )<<"Rasterizing meshes";
+
+    const int nThreads( params_.nThreads
+                        ? int(params_.nThreads)
+                        : std::max(1, int(std::thread::hardware_concurrency())));
+
     //rasterize mesh using generated projection matrices
     for(uint p=0; p<projections.size(); ++p){
-        LayeredZBuffer buffer(projections[p].viewportSize);
-        for(auto & mesh: meshes){
-            rasterizeMesh(*mesh, projections[p].transformation, buffer);
+        const math::Size2i viewport(projections[p].viewportSize);
+
+        // split meshes into fixed-size face chunks rasterized into
+        // per-thread z-buffers; dynamic scheduling keeps all threads
+        // busy no matter how uneven the chunks turn out to be
+        struct Job { const geometry::Mesh *mesh
+                   ; const std::vector<cv::Point3f> *projected
+                   ; std::size_t begin, end; };
+        std::vector<Job> jobs;
+
+        // vertices of each mesh are batch-projected once up front
+        // and shared by all its jobs
+        std::vector<std::vector<cv::Point3f>> projectedMeshes;
+        projectedMeshes.reserve(meshes.size() + seals.size());
+
+        auto addJobs([&](const geometry::Mesh &mesh) {
+            projectedMeshes.emplace_back();
+            projectVertices(mesh, projections[p].transformation
+                            , projectedMeshes.back());
+
+            const std::size_t chunk(params_.rasterizeChunkSize);
+            for (std::size_t b(0); b < mesh.faces.size(); b += chunk) {
+                jobs.push_back({ &mesh, &projectedMeshes.back(), b
+                               , std::min(b + chunk
+                                          , mesh.faces.size()) });
+            }
+        });
+        for (auto & mesh: meshes) { addJobs(*mesh); }
+        for (auto & mesh: seals) { addJobs(mesh); }
+
+        // the memory budget tiles the viewport into vertical strips; only
+        // strip-sized uncompressed z-buffers ever exist, results go
+        // straight into the compressed representation
+        int stripWidth(viewport.width);
+        if (params_.zBufferMemLimit > 0) {
+            // transient bytes per viewport column; the payload term
+            // assumes a few layers per pixel, the typical depth
+            // complexity of a sealed mesh
+            const long long perColumn
+                ( (long long) viewport.height
+                  * (sizeof(std::vector<float>) + 8 * sizeof(float))
+                  * ((nThreads > 1) ? (nThreads + 1) : 1) );
+            stripWidth = (int) std::max<long long>
+                ( 1, std::min<long long>( viewport.width
+                                        , params_.zBufferMemLimit
+                                          / perColumn));
         }
-        for(auto & mesh: seals){
-            rasterizeMesh(mesh, projections[p].transformation, buffer);
+
+        LOG(info2) << "rasterizing " << jobs.size() << " jobs using "
+                   << nThreads << " threads in "
+                   << (viewport.width + stripWidth - 1) / stripWidth
+                   << " strip(s)";
+
+        CompressedLayeredZBuffer compressed(viewport);
+
+        for (int xBegin(0); xBegin < viewport.width
+                 ; xBegin += stripWidth)
+        {
+            const int xEnd(std::min(xBegin + stripWidth, viewport.width));
+            math::Size2i stripSize(xEnd - xBegin, viewport.height);
+            LayeredZBuffer buffer(stripSize);
+
+            if (nThreads > 1) {
+                std::vector<LayeredZBuffer> threadBuffers;
+                threadBuffers.reserve(nThreads);
+                for (int t(0); t < nThreads; ++t) {
+                    threadBuffers.emplace_back(stripSize);
+                }
+
+                UTILITY_OMP(parallel num_threads(nThreads))
+                {
+                    int tid(0);
+#ifdef _OPENMP
+                    tid = omp_get_thread_num();
+#endif
+                    UTILITY_OMP(for schedule(dynamic))
+                    for (std::ptrdiff_t j = 0
+                             ; j < std::ptrdiff_t(jobs.size()); ++j)
+                    {
+                        rasterizeMesh(*jobs[j].mesh
+                                      , *jobs[j].projected
+                                      , threadBuffers[tid]
+                                      , jobs[j].begin, jobs[j].end
+                                      , xBegin, xEnd);
+                    }
+                }
+
+                // concatenate per-thread cells; the sortCells pass below
+                // makes the result independent of the merge order
+                UTILITY_OMP(parallel for schedule(dynamic, 16)
+                            num_threads(nThreads))
+                for (int x = 0; x < buffer.size.width; ++x) {
+                    for (int y = 0; y < buffer.size.height; ++y) {
+                        auto &cell(buffer.data[x][y]);
+                        for (auto &tb : threadBuffers) {
+                            cell.insert(cell.end(), tb.data[x][y].begin()
+                                        , tb.data[x][y].end());
+                        }
+                    }
+                }
+            } else {
+                for (const auto &job : jobs) {
+                    rasterizeMesh(*job.mesh, *job.projected, buffer
+                                  , job.begin, job.end, xBegin, xEnd);
+                }
+            }
+            buffer.sortCells();
+            compressed.append(buffer);
         }
-        buffer.sortCells();
+
         results.push_back(ProjectionResult( projections[p].transformation
-                                      , CompressedLayeredZBuffer(buffer)));
+                                          , std::move(compressed)));
     }
 
 #ifdef RASTERIZE_MESH_DEBUG
@@ -214,7 +325,7 @@ void MeshVoxelizer::voxelize(){
         << volMem/1024.0/1024.0/1024.0 << " GB.";
 
     long long mem = 0;
-    for(auto res : results){
+    for(const auto &res : results){
         mem += res.buffer.mem();
     }
 
@@ -224,9 +335,8 @@ void MeshVoxelizer::voxelize(){
 
     uint progress = 0;
     LOG( info2 )<<"Voxelization progress: "<<progress;
-#ifdef _OPENMP
-    #pragma omp parallel for schedule( dynamic, 10 )
-#endif
+    UTILITY_OMP(parallel for schedule( dynamic, 10 )
+                num_threads(nThreads))
     for(int x=0; x< vSize.width; ++x){
         for(int y=0; y< vSize.height; ++y){
             for(int z=0; z< vSize.depth; ++z){
@@ -434,6 +544,8 @@ geometry::Mesh MeshVoxelizer::sealOfMesh(geometry::Mesh & mesh){
 
 void MeshVoxelizer::fillVolumeFromSeal(){
     math::Size3i vSize = volume_->cSize();
+    // z-columns are independent of each other
+    UTILITY_OMP(parallel for schedule( dynamic, 16 ))
     for(int x = 0;x<vSize.width; ++x){
         for(int y = 0;y<vSize.height; ++y){
             //find first full voxel from the direction of seal
@@ -455,19 +567,68 @@ void MeshVoxelizer::fillVolumeFromSeal(){
 void MeshVoxelizer::rasterizeMesh( const Mesh &mesh
                                  , const math::Matrix4 &projMat
                                  , LayeredZBuffer & lZBuffer){
-    std::vector<imgproc::Scanline> scanlines;
-
     LOG(info2) << "rasterizing " << mesh.faces.size() << " triangles";
 
-    // draw all faces into the zBuffer
-    for (const auto &face : mesh.faces)
-    {
-        cv::Point3f tri[3];
+    rasterizeMesh(mesh, projMat, lZBuffer, 0, mesh.faces.size());
+}
+
+void MeshVoxelizer::rasterizeMesh( const Mesh &mesh
+                                 , const math::Matrix4 &projMat
+                                 , LayeredZBuffer & lZBuffer
+                                 , std::size_t faceBegin
+                                 , std::size_t faceEnd){
+    std::vector<cv::Point3f> projected;
+    projectVertices(mesh, projMat, projected);
+    rasterizeMesh(mesh, projected, lZBuffer, faceBegin, faceEnd
+                  , 0, lZBuffer.size.width);
+}
+
+void MeshVoxelizer::projectVertices( const Mesh &mesh
+                                   , const math::Matrix4 &projMat
+                                   , std::vector<cv::Point3f> &projected){
+    // flat row-major 3x4 affine part; the projections used here are
+    // orthographic, so the bottom matrix row plays no role
+    float m[12];
+    for (int r(0); r < 3; ++r) {
+        for (int c(0); c < 4; ++c) {
+            m[r * 4 + c] = float(projMat(r, c));
+        }
+    }
+
+    const std::size_t count(mesh.vertices.size());
+    projected.resize(count);
+    for (std::size_t v(0); v < count; ++v) {
+        const auto &point(mesh.vertices[v]);
+        const float x(float(point(0))), y(float(point(1)))
+                  , z(float(point(2)));
+        projected[v] = { m[0] * x + m[1] * y + m[2]  * z + m[3]
+                       , m[4] * x + m[5] * y + m[6]  * z + m[7]
+                       , m[8] * x + m[9] * y + m[10] * z + m[11] };
+    }
+}
 
-        int i(0);
-        for (auto it(mesh.begin(face)); it != mesh.end(face); ++it, ++i) {
-            math::Point3d pt(transform(projMat, *it));
-            tri[i] = {float(pt(0)), float(pt(1)), float(pt(2))};
+void MeshVoxelizer::rasterizeMesh( const Mesh &mesh
+                                 , const std::vector<cv::Point3f> &projected
+                                 , LayeredZBuffer & lZBuffer
+                                 , std::size_t faceBegin
+                                 , std::size_t faceEnd
+                                 , int xBegin
+                                 , int xEnd){
+    std::vector<imgproc::Scanline> scanlines;
+
+    // draw given faces into the zBuffer
+    for (std::size_t f(faceBegin); f < faceEnd; ++f)
+    {
+        const auto &face(mesh.faces[f]);
+        cv::Point3f tri[3] = { projected[face.a]
+                             , projected[face.b]
+                             , projected[face.c] };
+
+        // skip faces that cannot touch this strip (1 px rounding margin)
+        const float minX(std::min(tri[0].x, std::min(tri[1].x, tri[2].x)));
+        const float maxX(std::max(tri[0].x, std::max(tri[1].x, tri[2].x)));
+        if ((maxX < float(xBegin) - 1.f) || (minX > float(xEnd) + 1.f)) {
+            continue;
         }
 
         scanlines.clear();
@@ -475,14 +636,12 @@ void MeshVoxelizer::rasterizeMesh( const Mesh &mesh
 
         for (const auto& sl : scanlines)
         {
-            imgproc::processScanline(sl, 0, lZBuffer.size.width,
+            imgproc::processScanline(sl, xBegin, xEnd,
                 [&](int x, int y, float z) {
-                    lZBuffer.data[x][y].push_back(z);
+                    lZBuffer.data[x - xBegin][y].push_back(z);
                 } );
         }
     }
-
-
 }
 
 bool MeshVoxelizer::isInside( const math::Point3 & position
@@ -43,6 +43,7 @@
 #include "geometry/volume.hpp"
 
 #include <memory>
+#include <utility>
 
 #include <boost/filesystem.hpp>
 
@@ -74,6 +75,16 @@ public:
         bool shaveVolume; // turn hack on or off
         // if provided, expected to be compatible with voxel size
         math::Extents3 overrideExtents;
+        // number of worker threads used for rasterization and volume
+        // filling (0 = all hardware threads, 1 = serial)
+        uint nThreads;
+        // number of faces per rasterization job; smaller chunks balance
+        // better, larger chunks have less scheduling overhead
+        uint rasterizeChunkSize;
+        // budget (bytes) for the transient uncompressed z-buffers of one
+        // projection; when a whole viewport would exceed it the viewport
+        // is rasterized and compressed in vertical strips (0 = unlimited)
+        long long zBufferMemLimit;
 
         Parameters():
             voxelSize(0.25)
@@ -83,6 +94,9 @@ public:
           , method(Method::PARITY_COUNT)
           , shaveVolume(true)
           , overrideExtents(math::InvalidExtents{})
+          , nThreads(0)
+          , rasterizeChunkSize(4096)
+          , zBufferMemLimit(0)
          {};
     };
 
@@ -171,32 +185,43 @@ private:
 
         CompressedLayeredZBuffer():size(math::Size2(0,0)){}
 
-        CompressedLayeredZBuffer(LayeredZBuffer &lzBuffer){
-            this->size = lzBuffer.size;
+        /** Empty buffer of given viewport size; columns are filled in
+         *  by successive append() calls. */
+        explicit CompressedLayeredZBuffer(const math::Size2i &size)
+            : size(size)
+        {
             colStart.reserve(size.width);
-            rowpos.reserve(size.width*size.height);
-            count.reserve(size.width*size.height);
+            rowpos.reserve((std::size_t)size.width*size.height);
+            count.reserve((std::size_t)size.width*size.height);
+        }
+
+        CompressedLayeredZBuffer(LayeredZBuffer &lzBuffer)
+            : CompressedLayeredZBuffer(lzBuffer.size)
+        {
+            append(lzBuffer);
+        }
 
-            std::size_t size = 0;
-            for( auto &col : lzBuffer.data){
-                colStart.push_back(size);
+        /** Appends columns of a vertical viewport strip; strip height
+         *  must match the viewport height. */
+        void append(LayeredZBuffer &strip){
+            std::size_t dataSize(data.size());
+            for( auto &col : strip.data){
+                colStart.push_back(dataSize);
                 for( auto &cell : col){
                     count.push_back(cell.size());
-                    rowpos.push_back(size-colStart.back());
-                    size+=cell.size();
+                    rowpos.push_back(dataSize-colStart.back());
+                    dataSize+=cell.size();
                 }
             }
-            data.reserve(size);
-            for( auto &col : lzBuffer.data){
+            data.reserve(dataSize);
+            for( auto &col : strip.data){
                 for( auto &cell : col){
-                    for( auto &zval : cell){
-                        data.push_back(zval);
-                    }
+                    data.insert(data.end(), cell.begin(), cell.end());
                 }
             }
         }
 
-        long long mem(){
+        long long mem() const {
             return data.size()*sizeof(float) + rowpos.size()*sizeof(uint)
                 + colStart.size()*sizeof(size_t)
                 + count.size()*sizeof(unsigned short);
@@ -236,7 +261,7 @@ private:
 
         ProjectionResult( math::Matrix4 transformation
                         , CompressedLayeredZBuffer buffer):
-            transformation(transformation), buffer(buffer){};
+            transformation(transformation), buffer(std::move(buffer)){};
     };
 
     typedef std::vector<ProjectionResult> ProjectionResults;
@@ -264,6 +289,40 @@ private:
                        , const math::Matrix4 & projMat
                        , LayeredZBuffer & lZBuffer);
 
+    /**
+     * @brief Rasterizes only faces [faceBegin, faceEnd) of the mesh --
+     * one rasterization job of the parallel voxelization path.
+     */
+    void rasterizeMesh( const geometry::Mesh & mesh
+                       , const math::Matrix4 & projMat
+                       , LayeredZBuffer & lZBuffer
+                       , std::size_t faceBegin
+                       , std::size_t faceEnd);
+
+    /**
+     * @brief Projects all mesh vertices with the affine part of projMat
+     * in one batch. The flat single-precision loop vectorizes, and a
+     * vertex shared by several faces is projected once instead of once
+     * per incident face.
+     */
+    static void projectVertices( const geometry::Mesh & mesh
+                               , const math::Matrix4 & projMat
+                               , std::vector<cv::Point3f> & projected);
+
+    /**
+     * @brief Rasterizes faces [faceBegin, faceEnd) from pre-projected
+     * vertices; the projected array is shared by all jobs of one mesh.
+     * The z-buffer covers viewport columns [xBegin, xEnd) only, so a
+     * wide viewport can be processed in strips of bounded memory.
+     */
+    void rasterizeMesh( const geometry::Mesh & mesh
+                       , const std::vector<cv::Point3f> & projected
+                       , LayeredZBuffer & lZBuffer
+                       , std::size_t faceBegin
+                       , std::size_t faceEnd
+                       , int xBegin
+                       , int xEnd);
+
     /**
      * @brief Determines if point on given position is inside.
      * From each projection it determines if the voxel is inside or outside
@@ -23,8 +23,10 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
 #include <stdexcept>
 #include <fstream>
+#include <limits>
 
 #include <boost/serialization/vector.hpp>
 #include <boost/archive/binary_iarchive.hpp>
@@ -32,142 +34,250 @@
 
 #include <dbglog/dbglog.hpp>
 
+#include <utility/openmp.hpp>
+
 #include "mesh.hpp"
+#include "mesh-adjacency.hpp"
 
 namespace fs = boost::filesystem;
 
 
 namespace geometry {
 
-void Mesh::skirt( const math::Point3 & down ) {
+template <typename T>
+void BasicMesh<T>::skirt( const Vertex & down ) {
     typedef std::size_t Index;
-
-    enum class Status {
-            FW, BW, BI
-    };
-
-    struct Edge {
-        Index v1, v2;
-        Index t1, t2;
-        mutable Status status;
-
-        Edge(Index pv1, Index pv2, Index pt1, Index pt2)
-            : v1( std::min( pv1, pv2 ) ), v2( std::max( pv1, pv2 ) ),
-              t1( pv1 <= pv2 ? pt1 : pt2 ), t2( pv1 <= pv2 ? pt2 : pt1 ),
-              status( pv1 <= pv2 ? Status::FW : Status::BW ) {}
-
-        void update( Index pv1, Index pv2 ) const {
-
-            if ( pv1 <= pv2 && status == Status::BW ) status = Status::BI;
-            if ( pv1 > pv2 && status == Status::FW ) status = Status::BI;
-        }
-
-
-        bool operator < ( const Edge & edge ) const {
-
-            return v1 < edge.v1 || ( v1 == edge.v1 && v2 < edge.v2 );
-        }
-
-    };
-
-
-    typedef std::set<Edge> Edges;
     typedef std::map<Index, Index> DownMap;
 
-    Edges edges;
-    DownMap vdownmap, tdownmap;
-
-    // find odd edges
-    for ( Face f : faces ) {
+    // shared edge adjacency; edges come out ordered by (lower, higher)
+    // vertex pair, matching the edge set ordering used before
+    const auto padj(meshAdjacency(*this));
+    const auto &adj(*padj);
 
-        edges.insert( Edge(f.a,f.b,f.ta,f.tb) ).first->update(f.a,f.b);
-        edges.insert( Edge(f.b,f.c,f.tb,f.tc) ).first->update(f.b,f.c);
-        edges.insert( Edge(f.c,f.a,f.tc,f.ta) ).first->update(f.c,f.a);
-    }
+    DownMap vdownmap, tdownmap;
 
     // iterate through edges
     int evenc(0), oddc(0);
 
-    for ( Edge edge : edges )
-        if ( edge.status != Status::BI ) {
+    for (std::size_t e(0); e < adj.edgeCount(); ++e) {
 
-            // add new vertexes and tcoords
-            if ( vdownmap.find( edge.v1 ) == vdownmap.end() ) {
+        // scan halfedges: the first one defines the edge's orientation
+        // and texture indices, an opposite one makes the edge even
+        bool fw(false), bw(false), firstFw(false);
+        Index v1(0), v2(0), t1(0), t2(0);
+        bool first(true);
 
-                vertices.push_back( vertices[edge.v1]  + down );
-                vdownmap[edge.v1] = vertices.size()-1;
+        for (const auto *ih(adj.begin(e)); ih != adj.end(e); ++ih) {
+            const auto &f(faces[MeshAdjacency::halfedgeFace(*ih)]);
+
+            Index pv1, pv2, pt1, pt2;
+            switch (MeshAdjacency::halfedgeCorner(*ih)) {
+            case 0: pv1 = f.a; pv2 = f.b; pt1 = f.ta; pt2 = f.tb; break;
+            case 1: pv1 = f.b; pv2 = f.c; pt1 = f.tb; pt2 = f.tc; break;
+            default: pv1 = f.c; pv2 = f.a; pt1 = f.tc; pt2 = f.ta; break;
             }
 
-            if ( tdownmap.find( edge.t1 ) == tdownmap.end() ) {
+            if ( pv1 <= pv2 ) { fw = true; } else { bw = true; }
 
-                tCoords.push_back( tCoords[edge.t1] );
-                tdownmap[edge.t1] = tCoords.size()-1;
+            if (first) {
+                v1 = std::min( pv1, pv2 );
+                v2 = std::max( pv1, pv2 );
+                t1 = ( pv1 <= pv2 ) ? pt1 : pt2;
+                t2 = ( pv1 <= pv2 ) ? pt2 : pt1;
+                firstFw = ( pv1 <= pv2 );
+                first = false;
             }
+        }
 
-            if ( vdownmap.find( edge.v2 ) == vdownmap.end() ) {
+        if ( fw && bw ) {
 
-                vertices.push_back( vertices[edge.v2]  + down );
-                vdownmap[edge.v2] = vertices.size()-1;
-            }
+            evenc++;
+            continue;
+        }
 
-            if ( tdownmap.find( edge.t2 ) == tdownmap.end() ) {
+        // add new vertexes and tcoords
+        if ( vdownmap.find( v1 ) == vdownmap.end() ) {
 
-                tCoords.push_back( tCoords[edge.t2] );
-                tdownmap[edge.t2] = tCoords.size()-1;
-            }
+            vertices.push_back( vertices[v1]  + down );
+            vdownmap[v1] = vertices.size()-1;
+        }
 
-            // add new faces
-            if ( edge.status == Status::FW ) {
+        if ( tdownmap.find( t1 ) == tdownmap.end() ) {
 
-                faces.emplace_back( vdownmap[edge.v1], edge.v2, edge.v1,
-                           tdownmap[edge.t1], edge.t2, edge.t1 );
-                faces.emplace_back( vdownmap[edge.v1], vdownmap[edge.v2], edge.v2,
-                           tdownmap[edge.t1], tdownmap[edge.t2], edge.t2 );
-            }
+            tCoords.push_back( tCoords[t1] );
+            tdownmap[t1] = tCoords.size()-1;
+        }
 
-            if ( edge.status == Status::BW ) {
+        if ( vdownmap.find( v2 ) == vdownmap.end() ) {
 
-                faces.emplace_back( vdownmap[edge.v1], edge.v1, edge.v2,
-                           tdownmap[edge.t1], edge.t1, edge.t2 );
-                faces.emplace_back( vdownmap[edge.v1], edge.v2, vdownmap[edge.v2],
-                           tdownmap[edge.t1], edge.t2, tdownmap[edge.t2] );
-            }
+            vertices.push_back( vertices[v2]  + down );
+            vdownmap[v2] = vertices.size()-1;
+        }
+
+        if ( tdownmap.find( t2 ) == tdownmap.end() ) {
+
+            tCoords.push_back( tCoords[t2] );
+            tdownmap[t2] = tCoords.size()-1;
+        }
 
-            oddc++;
+        // add new faces
+        if ( firstFw ) {
 
+            faces.emplace_back( vdownmap[v1], v2, v1,
+                       tdownmap[t1], t2, t1 );
+            faces.emplace_back( vdownmap[v1], vdownmap[v2], v2,
+                       tdownmap[t1], tdownmap[t2], t2 );
         } else {
 
-            evenc++;
+            faces.emplace_back( vdownmap[v1], v1, v2,
+                       tdownmap[t1], t1, t2 );
+            faces.emplace_back( vdownmap[v1], v2, vdownmap[v2],
+                       tdownmap[t1], t2, tdownmap[t2] );
         }
 
+        oddc++;
+    }
+
+    // the skirt changed the topology
+    adjacency.reset();
+
     LOG( info1 ) << evenc << " even, " << oddc << " odd.";
 }
 
-double Mesh::area(const Face &face) const
+template <typename T>
+double BasicMesh<T>::area(const Face &face) const
 {
     return (norm_2(math::crossProduct(b(face) - a(face)
                                      , c(face) - a(face)))
             * 0.5);
 }
 
-double Mesh::txArea(const Face &face) const
+template <typename T>
+double BasicMesh<T>::txArea(const Face &face) const
 {
-    return (std::abs(math::crossProduct(math::Point2(tb(face) - ta(face))
-                                        , math::Point2(tc(face) - ta(face)))
+    return (std::abs(math::crossProduct(TCoord(tb(face) - ta(face))
+                                        , TCoord(tc(face) - ta(face)))
                      * 0.5));
 }
 
-math::Point3 Mesh::barycenter(const Face &face) const
+template <typename T>
+typename BasicMesh<T>::Vertex BasicMesh<T>::barycenter(const Face &face) const
 {
     const auto &va(a(face));
     const auto &vb(b(face));
     const auto &vc(c(face));
 
-    return {
-        (va(0) + vb(0) + vc(0)) / 3.0
-        , (va(1) + vb(1) + vc(1)) / 3.0
-        , (va(2) + vb(2) + vc(2)) / 3.0
-    };
+    return Vertex((va(0) + vb(0) + vc(0)) / T(3)
+                  , (va(1) + vb(1) + vc(1)) / T(3)
+                  , (va(2) + vb(2) + vc(2)) / T(3));
+}
+
+Mesh MeshView::materialize() const
+{
+    Mesh out;
+    if (!parent_) { return out; }
+
+    const auto &vertices(parent_->vertices);
+    const auto &tCoords(parent_->tCoords);
+
+    const auto invalid(std::numeric_limits<Face::index_type>::max());
+    std::vector<Face::index_type> vertexMap(vertices.size(), invalid);
+    std::vector<Face::index_type> tCoordMap(tCoords.size(), invalid);
+
+    const auto mapVertex([&](Face::index_type v) -> Face::index_type {
+        if (vertexMap[v] == invalid) {
+            vertexMap[v] = out.vertices.size();
+            out.vertices.push_back(vertices[v]);
+        }
+        return vertexMap[v];
+    });
+
+    const auto mapTCoord([&](Face::index_type t) -> Face::index_type {
+        if (tCoords.empty()) { return 0; }
+        if (tCoordMap[t] == invalid) {
+            tCoordMap[t] = out.tCoords.size();
+            out.tCoords.push_back(tCoords[t]);
+        }
+        return tCoordMap[t];
+    });
+
+    out.faces.reserve(faces_.size());
+    for (const auto &face : faces_) {
+        out.addFace(mapVertex(face.a), mapVertex(face.b), mapVertex(face.c)
+                    , mapTCoord(face.ta), mapTCoord(face.tb)
+                    , mapTCoord(face.tc), face.imageId);
+    }
+
+    return out;
 }
 
+void MeshStats::add(const MeshStats &other)
+{
+    faceCount += other.faceCount;
+    degenerateFaces += other.degenerateFaces;
+    area += other.area;
+    txArea += other.txArea;
+    extents = math::unite(extents, other.extents);
+    for (const auto &item : other.facesPerImageId) {
+        facesPerImageId[item.first] += item.second;
+    }
+}
+
+std::ostream& operator<<(std::ostream &os, const MeshStats &stats)
+{
+    os << stats.faceCount << " faces (" << stats.degenerateFaces
+       << " degenerate), area " << stats.area
+       << ", txArea " << stats.txArea
+       << ", extents " << stats.extents;
+    for (const auto &item : stats.facesPerImageId) {
+        os << ", imageId " << item.first << ": " << item.second << " faces";
+    }
+    return os;
+}
+
+MeshStats meshStats(const Mesh &mesh)
+{
+    const auto &faces(mesh.faces);
+    const bool hasTx(!mesh.tCoords.empty());
+
+    // fixed-size chunks reduced independently and merged in chunk
+    // order: the result is the same whatever the thread count
+    const std::size_t chunkSize(4096);
+    const std::size_t chunks((faces.size() + chunkSize - 1) / chunkSize);
+    std::vector<MeshStats> partials(chunks);
+
+    UTILITY_OMP(parallel for schedule(dynamic))
+    for (std::ptrdiff_t c = 0; c < std::ptrdiff_t(chunks); ++c) {
+        auto &stats(partials[c]);
+        const std::size_t begin(c * chunkSize);
+        const std::size_t end(std::min(begin + chunkSize, faces.size()));
+
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto &face(faces[i]);
+
+            ++stats.faceCount;
+            ++stats.facesPerImageId[face.imageId];
+            if (mesh.degenerate(face)) { ++stats.degenerateFaces; }
+
+            stats.area += mesh.area(face);
+            if (hasTx) { stats.txArea += mesh.txArea(face); }
+
+            math::update(stats.extents, mesh.a(face));
+            math::update(stats.extents, mesh.b(face));
+            math::update(stats.extents, mesh.c(face));
+        }
+    }
+
+    MeshStats stats;
+    for (const auto &partial : partials) {
+        stats.add(partial);
+    }
+    return stats;
+}
+
+// the two supported storage scalars; float covers locally-shifted
+// tiles where double precision is wasted on memory and bandwidth
+template struct BasicMesh<double>;
+template struct BasicMesh<float>;
+
 } //namespace geometry
@@ -33,6 +33,7 @@
 #ifndef geometry_mesh_hpp_included_
 #define geometry_mesh_hpp_included_
 
+#include <map>
 #include <memory>
 #include <vector>
 #include <string>
@@ -46,6 +47,8 @@
 
 namespace geometry {
 
+class MeshAdjacency;
+
 /** Face in a mesh.
  */
 struct Face {
@@ -81,9 +84,13 @@ struct Face {
         return abc[idx];
     }
 
-    /** Calculate normal of this face.
+    /** Calculate normal of this face. The normal keeps the scalar type
+     *  of the vertex array.
      */
-    math::Point3 normal(const math::Points3 &vertices) const {
+    template <typename T>
+    math::Point3_<T> normal(const std::vector<math::Point3_<T> > &vertices)
+        const
+    {
         return math::normalize
             (math::crossProduct(vertices[b] - vertices[a]
                                 , vertices[c] - vertices[b]));
@@ -105,82 +112,98 @@ struct Face {
     bool operator<(const Face &f) const;
 };
 
-/** Textured 3D mesh representation.
+/** Textured 3D mesh representation, parameterized by vertex scalar type.
  *
  * Vertices and texture coordinates are held in two arrays. Vertex at index I
  * has vertex coordinates at vertices[I] and texture coordinates at tCoords[I].
  *
  * Faces are defined as 3 indices to vertices and 3 indices to tCoords.
+ *
+ * T selects the coordinate storage scalar; Mesh (double) is the default
+ * used throughout, FloatMesh halves memory and bandwidth where float
+ * precision suffices (locally-shifted tiles). The choice is purely a
+ * compile-time one, all operations stay branch-free over the scalar.
  */
-struct Mesh {
-    typedef std::shared_ptr<Mesh> pointer;
-    typedef std::vector<Mesh> list;
+template <typename T>
+struct BasicMesh {
+    typedef T value_type;
+    typedef math::Point3_<T> Vertex;
+    typedef std::vector<Vertex> Vertices;
+    typedef math::Point2_<T> TCoord;
+    typedef std::vector<TCoord> TCoords;
+
+    typedef std::shared_ptr<BasicMesh> pointer;
+    typedef std::vector<BasicMesh> list;
 
     /** vertices */
     std::vector <int> vertecesClass;
-    math::Points3 vertices;
+    Vertices vertices;
 
     /** per-vertex texture coordinates */
-    math::Points2 tCoords;
+    TCoords tCoords;
 
     /** Faces (triplets of indices to vertices and texture coordinates) */
     Face::list faces;
 
+    /** Lazily built edge adjacency (see mesh-adjacency.hpp), shared by
+     *  topology-aware operations. Built on first use via
+     *  meshAdjacency(), dropped by addFace(); code mutating the face
+     *  list directly must reset it itself.
+     */
+    mutable std::shared_ptr<const MeshAdjacency> adjacency;
+
     /** Face normal. */
-    math::Point3 normal(const Face &face) const {
+    Vertex normal(const Face &face) const {
         return face.normal(vertices);
     }
 
     /** Add new face.
      */
-    void addFace(math::Points3::size_type a, math::Points3::size_type b
-                 , math::Points3::size_type c);
+    void addFace(std::size_t a, std::size_t b, std::size_t c);
 
-    void addFace(math::Points3::size_type a, math::Points3::size_type b
-                 , math::Points3::size_type c, unsigned int imageId);
+    void addFace(std::size_t a, std::size_t b, std::size_t c
+                 , unsigned int imageId);
 
-    void addFace(math::Points3::size_type a, math::Points3::size_type b
-                 , math::Points3::size_type c, math::Points2::size_type ta
-                 , math::Points2::size_type tb, math::Points2::size_type tc );
+    void addFace(std::size_t a, std::size_t b, std::size_t c
+                 , std::size_t ta, std::size_t tb, std::size_t tc);
 
-    void addFace(math::Points3::size_type a, math::Points3::size_type b
-                 , math::Points3::size_type c, math::Points2::size_type ta
-                 , math::Points2::size_type tb, math::Points2::size_type tc
+    void addFace(std::size_t a, std::size_t b, std::size_t c
+                 , std::size_t ta, std::size_t tb, std::size_t tc
                  , unsigned int imageId);
 
     /** First face point.
     */
-    const math::Point3& a(const Face &face) const {
+    const Vertex& a(const Face &face) const {
         return vertices[face.a];
     }
 
     /** Second face point.
      */
-    const math::Point3& b(const Face &face) const {
+    const Vertex& b(const Face &face) const {
         return vertices[face.b];
     }
 
     /** Third face point.
      */
-    const math::Point3& c(const Face &face) const {
+    const Vertex& c(const Face &face) const {
         return vertices[face.c];
     }
 
     /** First face texture point.
     */
-    const math::Point2& ta(const Face &face) const {
+    const TCoord& ta(const Face &face) const {
         return tCoords[face.ta];
     }
 
     /** Second face texture point.
      */
-    const math::Point2& tb(const Face &face) const {
+    const TCoord& tb(const Face &face) const {
         return tCoords[face.tb];
     }
 
     /** Third face texture point.
      */
-    const math::Point2& tc(const Face &face) const {
+    const TCoord& tc(const Face &face) const {
         return tCoords[face.tc];
     }
 
@@ -204,7 +227,7 @@ struct Mesh {
      * @details skirt is a set quads pointing in the direction of the given
      * vector and attached to odd edges (edges adjacent to a single face).
      */
-    void skirt( const math::Point3 & down = math::Point3( 0.0, 0.0, -1.0 ) );
+    void skirt( const Vertex & down = Vertex( 0.0, 0.0, -1.0 ) );
 
     void sortFacesByImageId();
 
@@ -229,45 +252,151 @@ struct Mesh {
 
     /** Calculate face barycenter.
      */
-    math::Point3 barycenter(const Face &face) const;
+    Vertex barycenter(const Face &face) const;
 };
 
+/** Double-precision mesh; the representation every mesh operation takes
+ *  and returns unless said otherwise.
+ */
+typedef BasicMesh<double> Mesh;
+
+/** Single-precision mesh for memory/bandwidth-bound pipelines.
+ */
+typedef BasicMesh<float> FloatMesh;
+
+/** Read-only view into a mesh.
+ *
+ * Shares the (immutable) vertex and texture coordinate buffers of a
+ * parent mesh and owns only a face list whose indices point into the
+ * shared buffers. Any number of views over one parent can therefore be
+ * read concurrently with no copies and no locks; the parent must not be
+ * modified while views exist.
+ *
+ * Operations that need a standalone mutable mesh promote the view via
+ * materialize(), which copies just the vertices the view's faces
+ * reference.
+ */
+class MeshView {
+public:
+    typedef std::vector<MeshView> list;
+
+    MeshView() {}
+
+    /** View of the whole parent mesh.
+     */
+    explicit MeshView(const std::shared_ptr<const Mesh> &parent)
+        : parent_(parent), faces_(parent->faces)
+    {}
+
+    /** View of selected faces of the parent mesh; face indices must
+     *  point into the parent's buffers.
+     */
+    MeshView(const std::shared_ptr<const Mesh> &parent, Face::list faces)
+        : parent_(parent), faces_(std::move(faces))
+    {}
+
+    const math::Points3& vertices() const { return parent_->vertices; }
+    const math::Points2& tCoords() const { return parent_->tCoords; }
+    const Face::list& faces() const { return faces_; }
+
+    /** Promotes the view to a standalone Mesh holding only the vertices
+     *  (and texture coordinates) its faces reference; indices are
+     *  remapped accordingly.
+     */
+    Mesh materialize() const;
+
+private:
+    std::shared_ptr<const Mesh> parent_;
+    Face::list faces_;
+};
+
+/** Aggregate mesh statistics; see meshStats().
+ */
+struct MeshStats {
+    /** Number of faces.
+     */
+    std::size_t faceCount;
+
+    /** Faces for which Mesh::degenerate() holds.
+     */
+    std::size_t degenerateFaces;
+
+    /** Total face area in 3D space.
+     */
+    double area;
+
+    /** Total face area in UV space; zero when the mesh carries no
+     *  texture coordinates.
+     */
+    double txArea;
+
+    /** Extents of all vertices referenced by at least one face.
+     */
+    math::Extents3 extents;
+
+    /** Face count per Face::imageId.
+     */
+    std::map<unsigned int, std::size_t> facesPerImageId;
+
+    MeshStats()
+        : faceCount(), degenerateFaces(), area(), txArea()
+        , extents(math::InvalidExtents{})
+    {}
+
+    /** Merges another partial in; every combination is associative.
+     */
+    void add(const MeshStats &other);
+};
+
+std::ostream& operator<<(std::ostream &os, const MeshStats &stats);
+
+/** Computes all the statistics above in one parallel pass over the
+ *  faces: the face list is cut into fixed-size chunks reduced into
+ *  per-chunk partials which merge associatively in chunk order, so the
+ *  result does not depend on the number of threads. One memory pass no
+ *  matter how many of the statistics the caller needs.
+ */
+MeshStats meshStats(const Mesh &mesh);
+
 // inlines
 
-inline void Mesh::addFace(math::Points3::size_type a
-                          , math::Points3::size_type b
-                          , math::Points3::size_type c
-                          , unsigned int imageId)
+template <typename T>
+inline void BasicMesh<T>::addFace(std::size_t a, std::size_t b, std::size_t c
+                                  , unsigned int imageId)
 {
     faces.emplace_back(a, b, c, imageId);
+    adjacency.reset();
 }
 
-inline void Mesh::addFace(math::Points3::size_type a
-                          , math::Points3::size_type b
-                          , math::Points3::size_type c)
+template <typename T>
+inline void BasicMesh<T>::addFace(std::size_t a, std::size_t b, std::size_t c)
 {
     faces.emplace_back(a, b, c);
+    adjacency.reset();
 }
 
+template <typename T>
 inline void
-Mesh::addFace(math::Points3::size_type a, math::Points3::size_type b
-              , math::Points3::size_type c, math::Points2::size_type ta
-              , math::Points2::size_type tb, math::Points2::size_type tc)
+BasicMesh<T>::addFace(std::size_t a, std::size_t b, std::size_t c
+                      , std::size_t ta, std::size_t tb, std::size_t tc)
 {
     faces.emplace_back(a, b, c, ta, tb, tc);
+    adjacency.reset();
 }
 
+template <typename T>
 inline void
-Mesh::addFace(math::Points3::size_type a, math::Points3::size_type b
-              , math::Points3::size_type c, math::Points2::size_type ta
-              , math::Points2::size_type tb, math::Points2::size_type tc
-              , unsigned int imageId)
+BasicMesh<T>::addFace(std::size_t a, std::size_t b, std::size_t c
+                      , std::size_t ta, std::size_t tb, std::size_t tc
+                      , unsigned int imageId)
 {
     faces.emplace_back(a, b, c, ta, tb, tc, imageId);
+    adjacency.reset();
 }
 
 
-inline void Mesh::sortFacesByImageId()
+template <typename T>
+inline void BasicMesh<T>::sortFacesByImageId()
 {
     std::sort(faces.begin(), faces.end()
               , [](const Face &l, const Face &r) {
@@ -275,14 +404,15 @@ inline void Mesh::sortFacesByImageId()
               });
 }
 
-struct Mesh::FaceVertexConstIterator {
+template <typename T>
+struct BasicMesh<T>::FaceVertexConstIterator {
     FaceVertexConstIterator() : face_(), vertices_(), index_() {}
 
-    FaceVertexConstIterator(const Mesh &mesh, const Face &face)
+    FaceVertexConstIterator(const BasicMesh &mesh, const Face &face)
         : face_(&face), vertices_(&mesh.vertices), index_()
     {}
 
-    const math::Point3& operator*() const {
+    const Vertex& operator*() const {
         switch (index_) {
         case 0: return (*vertices_)[face_->a];
         case 1: return (*vertices_)[face_->b];
@@ -290,7 +420,7 @@ struct Mesh::FaceVertexConstIterator {
         }
     }
 
-    const math::Point3* operator->() const {
+    const Vertex* operator->() const {
         switch (index_) {
         case 0: return &(*vertices_)[face_->a];
         case 1: return &(*vertices_)[face_->b];
@@ -322,21 +452,26 @@ struct Mesh::FaceVertexConstIterator {
 
 private:
     const Face *face_;
-    const math::Points3 *vertices_;
+    const Vertices *vertices_;
     unsigned int index_;
 };
 
-inline Mesh::FaceVertexConstIterator Mesh::begin(const Face &face) const {
+template <typename T>
+inline typename BasicMesh<T>::FaceVertexConstIterator
+BasicMesh<T>::begin(const Face &face) const {
     return FaceVertexConstIterator(*this, face);
 }
 
-inline Mesh::FaceVertexConstIterator Mesh::end(const Face&) const {
+template <typename T>
+inline typename BasicMesh<T>::FaceVertexConstIterator
+BasicMesh<T>::end(const Face&) const {
     return FaceVertexConstIterator();
 }
 
-class Mesh::FaceVertexConstIteratorRange {
+template <typename T>
+class BasicMesh<T>::FaceVertexConstIteratorRange {
 public:
-    FaceVertexConstIteratorRange(const Mesh &mesh, const Face &face)
+    FaceVertexConstIteratorRange(const BasicMesh &mesh, const Face &face)
         : begin_(mesh, face), end_()
     {}
 
@@ -348,7 +483,9 @@ private:
     FaceVertexConstIterator end_;
 };
 
-inline Mesh::FaceVertexConstIteratorRange Mesh::face(const Face &face) const
+template <typename T>
+inline typename BasicMesh<T>::FaceVertexConstIteratorRange
+BasicMesh<T>::face(const Face &face) const
 {
     return { *this, face };
 }
@@ -24,10 +24,13 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <sstream>
+
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 
 #include "meshop.hpp"
+#include "zstd-blocks.hpp"
 
 namespace bio = boost::iostreams;
 
@@ -59,4 +62,33 @@ void saveAsGzippedObj(const Mesh &mesh, const boost::filesystem::path &filepath
     gzipped.flush();
 }
 
+void saveAsZstdObj(const Mesh &mesh, const boost::filesystem::path &filepath
+                   , const ObjMaterial &mtl
+                   , const ObjStreamSetup &streamSetup
+                   , const ZstdBlocksOptions &zstdOptions)
+{
+    LOG(info2) << "Saving zstd-compressed mesh to file <"
+               << filepath << ">.";
+
+    // serialize the OBJ text into memory; the worker pool compresses
+    // the blocks independently
+    std::ostringstream os;
+    saveAsObj(mesh, os, mtl, filepath, streamSetup);
+    const auto data(os.str());
+
+    std::ofstream f;
+    f.exceptions(std::ios::badbit | std::ios::failbit);
+    try {
+        f.open(filepath.string()
+               , std::ios_base::out | std::ios_base::trunc
+               | std::ios_base::binary);
+    } catch (const std::exception&) {
+        LOGTHROW(err3, std::runtime_error)
+            << "Unable to save mesh to <" << filepath << ">.";
+    }
+
+    writeZstdBlocks(f, data.data(), data.size(), zstdOptions);
+    f.close();
+}
+
 } // namespace geometry
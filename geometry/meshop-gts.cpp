@@ -30,6 +30,9 @@
  * simplification with Lindstrom-Turk algorithm from GTS library
  */
 
+#include <cstdint>
+#include <unordered_map>
+
 #include "gtsutils.hpp"
 #include "meshop.hpp"
 #include "utility/openmp.hpp"
@@ -39,18 +42,21 @@ namespace geometry {
 // Looks for an existing gts edge.
 // if it is found then return it
 // If it is not found -> insert into a map of edges and return it
+// The table is hashed on the packed vertex index pair -- a tree lookup
+// per face edge was measurable on multi-million face meshes
 // Just a helper
-GtsEdge * get_gts_edge (std::map <std::pair<int, int>, GtsEdge *> &edges
+GtsEdge * get_gts_edge (std::unordered_map <std::uint64_t, GtsEdge *> &edges
     , const std::vector <GtsVertex *> &vertices
     , int v1
     , int v2)
 {
     int vmin = std::min (v1, v2);
     int vmax = std::max (v1, v2);
-    auto e_lookup = edges.find(std::make_pair (vmin, vmax));
+    std::uint64_t key = (std::uint64_t (vmin) << 32) | std::uint64_t (vmax);
+    auto e_lookup = edges.find(key);
     if (e_lookup == edges.end()) {
         GtsEdge *e = gts_edge_new (gts_edge_class (), vertices[vmin], vertices[vmax]);
-        edges.emplace (std::make_pair (vmin, vmax), e);
+        edges.emplace (key, e);
         return e;
     }
     return e_lookup->second;
@@ -66,7 +72,9 @@ void toGTSMesh(const geometry::Mesh &mesh, GtsSurface &s)
         gts_vertices.push_back(vx);
     }
 
-    std::map <std::pair<int, int>, GtsEdge *> gts_edges;
+    std::unordered_map <std::uint64_t, GtsEdge *> gts_edges;
+    // roughly 1.5 edges per face on a manifold mesh
+    gts_edges.reserve (mesh.faces.size() * 3 / 2);
     // create GTS faces
     for (const geometry::Face& face : mesh.faces)
     {
@@ -171,38 +179,6 @@ geometry::Mesh::pointer simplify_gts(const geometry::Mesh &mesh
     return newMesh;
 }
 
-gint getSubSurface (void *ee, gpointer *data)
-{
-    GtsSurface *s_sub = (GtsSurface *) data[1];
-
-    math::Extents2 *cellExtents = (math::Extents2 *) data[0];
-
-    GtsFace *f = (GtsFace *) ee;
-    GtsVertex *v1, *v2, *v3;
-    gts_triangle_vertices (GTS_TRIANGLE (f), &v1, &v2, &v3);
-
-    gint result = 1;
-
-    gdouble midx = GTS_POINT (v1) -> x + GTS_POINT (v2)->x + GTS_POINT (v3) ->x;
-    midx /= 3;
-    gdouble midy = GTS_POINT (v1) -> y + GTS_POINT (v2)->y + GTS_POINT (v3) ->y;
-    midy /= 3;
-    if (midx < cellExtents->ll(0)) {
-        result = 0;
-    } else if (midx > cellExtents->ur(0)) {
-        result = 0;
-    } else if (midy < cellExtents->ll(1)) {
-        result = 0;
-    } else if (midy > cellExtents->ur(1)) {
-        result = 0;
-    }
-    if (result) {
-        gts_surface_add_face (s_sub, f);
-    }
-
-    return {};
-}
-
 gint getSubSurfaces (GtsFace *f, gpointer *data)
 {
     std::vector <std::vector <GtsSurface *>> *subSurfaces = (std::vector <std::vector <GtsSurface *>> *) data[0];
@@ -274,19 +250,27 @@ geometry::Mesh::pointer simplify_gts_in_grid(const geometry::Mesh &mesh
 
 
     if (!inParallel) {
-        for (unsigned int row = 0 ; row < rows; row+=1)
-        for (unsigned int column = 0 ; column < columns; column+=1)
-        {
+        // Bin all faces into their cells in one pass over the surface;
+        // re-scanning the whole surface per cell used to cost
+        // O(cells * faces) before any simplification started
+        std::vector<std::vector <GtsSurface *>> subSurfaces(rows);
+        for (unsigned int row = 0; row < rows ; ++row)
+        for (unsigned int column = 0; column < columns ; ++column) {
             GtsSurface *subSurface = gts_surface_new (gts_surface_class (),
                     gts_face_class (),
                     gts_edge_class (),
                     gts_vertex_class ());
-            gpointer subParams[2];
-            subParams[0] = &gridCells[row][column].extent;
-            subParams[1] = subSurface;
+            subSurfaces[row].push_back (subSurface);
+        }
+        gpointer subParams[2];
+        subParams[0] = &subSurfaces;
+        subParams[1] = &getGridCell;
+        gts_surface_foreach_face (s, (GtsFunc) getSubSurfaces, &subParams);
 
-            // Fill the sub surface with faces from this cell and calculate mesh_area in cells
-            gts_surface_foreach_face (s, (GtsFunc) getSubSurface, &subParams);
+        for (unsigned int row = 0 ; row < rows; row+=1)
+        for (unsigned int column = 0 ; column < columns; column+=1)
+        {
+            GtsSurface *subSurface = subSurfaces[row][column];
             oneCellProcess (row, column, subSurface);
             gts_object_destroy (GTS_OBJECT (subSurface));
         }
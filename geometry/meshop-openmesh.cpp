@@ -31,6 +31,7 @@
  */
 
 #include <numeric>
+#include <thread>
 
 #include <OpenMesh/Core/IO/MeshIO.hh>
 #include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
@@ -43,8 +44,12 @@
 
 #include "math/math.hpp"
 
+#include "utility/openmp.hpp"
+
 #include "meshop.hpp"
 #include "detail/hybrid-decimater.hpp"
+#include "detail/parallel-decimater.hpp"
+#include "perfcounters.hpp"
 
 namespace geometry {
 
@@ -450,6 +455,41 @@ void prepareDecimator(Decimator &decimator
     }
 }
 
+/** Runs the decimation configured by prepareDecimator(). When the options
+ *  ask for more than one thread the serial priority-queue decimater is
+ *  swapped for rounds of independent collapse sets applied in parallel;
+ *  the modules (and thus locking and maxError semantics) are shared
+ *  between both modes.
+ */
+void decimateToFaces(OMMesh &omMesh, int faceCount
+                     , const SimplifyOptions &options)
+{
+    GEOMETRY_PERF_TIMER(perf::Timer::simplify);
+
+#if OM_VERSION >= 0x60000
+    if (options.nThreads() && (*options.nThreads() != 1)) {
+        int nThreads(int(*options.nThreads()));
+        if (!nThreads) {
+            nThreads = int(std::max
+                           (1u, std::thread::hardware_concurrency()));
+        }
+
+        detail::ParallelDecimaterT<OMMesh> decimator(omMesh);
+        prepareDecimator(decimator, options);
+        decimator.initialize();
+        GEOMETRY_PERF_ADD(perf::Counter::collapsesApplied
+                          , decimator.decimateToFaces(faceCount, nThreads));
+        return;
+    }
+#endif
+
+    Decimator decimator(omMesh);
+    prepareDecimator(decimator, options);
+    decimator.initialize();
+    GEOMETRY_PERF_ADD(perf::Counter::collapsesApplied
+                      , decimator.decimate_to_faces(0, faceCount));
+}
+
 } // namespace
 
 Mesh::pointer simplify(const Mesh &mesh, int faceCount
@@ -458,11 +498,7 @@ Mesh::pointer simplify(const Mesh &mesh, int faceCount
     OMMesh omMesh;
     prepareMesh(omMesh, mesh, options);
 
-    Decimator decimator(omMesh);
-    prepareDecimator(decimator, options);
-    decimator.initialize();
-
-    decimator.decimate_to_faces(0, faceCount);
+    decimateToFaces(omMesh, faceCount, options);
     omMesh.garbage_collection();
 
     auto newMesh(std::make_shared<geometry::Mesh>());
@@ -470,15 +506,70 @@ Mesh::pointer simplify(const Mesh &mesh, int faceCount
     return newMesh;
 }
 
+struct SimplifyContext::Impl {
+    Impl(const Mesh &mesh, const SimplifyOptions &options)
+        : decimator(omMesh)
+    {
+        prepareMesh(omMesh, mesh, options);
+
+        prepareDecimator(decimator, options);
+        decimator.initialize();
+    }
+
+    OMMesh omMesh;
+    Decimator decimator;
+};
+
+SimplifyContext::SimplifyContext(const Mesh &mesh
+                                 , const SimplifyOptions &options)
+    : impl_(new Impl(mesh, options))
+{}
+
+SimplifyContext::~SimplifyContext() = default;
+
+Mesh::pointer SimplifyContext::simplify(int faceCount)
+{
+    // continue collapsing the held mesh; quadrics accumulated by earlier
+    // calls stay valid since decimation only ever merges them
+    impl_->decimator.decimate_to_faces(0, faceCount);
+
+    // snapshot live elements only; deliberately no garbage collection,
+    // it would shuffle the mesh under the decimator between calls
+    const auto &omMesh(impl_->omMesh);
+    auto newMesh(std::make_shared<geometry::Mesh>());
+
+    std::vector<int> vMap(omMesh.n_vertices(), -1);
+    for (auto v_it = omMesh.vertices_begin();
+              v_it != omMesh.vertices_end();
+              ++v_it)
+    {
+        if (omMesh.status(v_it.handle()).deleted()) { continue; }
+        vMap[v_it.handle().idx()] = int(newMesh->vertices.size());
+        const auto& pt = omMesh.point(v_it.handle());
+        newMesh->vertices.emplace_back(pt[0], pt[1], pt[2]);
+    }
+
+    for (auto f_it = omMesh.faces_begin();
+              f_it != omMesh.faces_end();
+              ++f_it)
+    {
+        if (omMesh.status(f_it.handle()).deleted()) { continue; }
+        auto fv_it(omMesh.cfv_iter(f_it.handle()));
+        int index[3], *p = index;
+        for ( ; fv_it; ++fv_it) {
+            *p++ = vMap[fv_it.handle().idx()];
+        }
+        newMesh->faces.emplace_back(index[0], index[1], index[2]);
+    }
+
+    return newMesh;
+}
+
 void simplifyInPlace(Mesh& mesh, int faceCount, const SimplifyOptions& options) {
     OMMesh omMesh;
     prepareMesh(omMesh, std::move(mesh), options);
 
-    Decimator decimator(omMesh);
-    prepareDecimator(decimator, options);
-    decimator.initialize();
-
-    decimator.decimate_to_faces(0, faceCount);
+    decimateToFaces(omMesh, faceCount, options);
     omMesh.garbage_collection();
 
     mesh.vertices.clear();
@@ -994,6 +1085,104 @@ math::Extents2 FacesPerCell::cellExtents(std::size_t index) const
                           , origin_(1) + (j + 1) * cellSize_.height);
 }
 
+namespace {
+
+/** Parallel grid simplification: every cell submesh is clipped out of the
+ *  input, simplified independently with its border ring locked
+ *  (INNERBORDER) and the results are merged in cell order with exact
+ *  vertex welding along the shared cuts, which makes the output
+ *  independent of scheduling. Cells are dispatched with dynamic
+ *  scheduling since per-cell face counts are highly skewed.
+ */
+Mesh::pointer simplifyInGridParallel(const Mesh &mesh
+                                     , const math::Point2 &alignment
+                                     , const math::Size2f &cellSize
+                                     , const FacesPerCell::Functor
+                                     &facesPerCell
+                                     , const SimplifyOptions &options)
+{
+    // calculate the same grid as the serial path
+    math::Extents2 me(INFINITY, INFINITY, -INFINITY, -INFINITY);
+    for (const auto &v : mesh.vertices) {
+        update(me, math::Point2(v(0), v(1)));
+    }
+
+    const auto ge(gridExtents(me, alignment, cellSize));
+    const auto gorigin(ge.ll);
+    const math::Size2ll gsize
+        ((long long) (std::round(((ge.ur(0) - ge.ll(0)) / cellSize.width)))
+         , (long long)(std::round((ge.ur(1) - ge.ll(1)) / cellSize.width)));
+
+    LOG(info2) << "[simplify] mesh extents: " << me;
+    LOG(info2) << "[simplify] gridded mesh extents: "
+               << std::setprecision(15) << ge;
+    LOG(info2) << "[simplify] grid size: " << gsize;
+    LOG(info2) << "[simplify] grid origin: " << gorigin;
+
+    FacesPerCell fpc(gsize, gorigin, cellSize);
+    facesPerCell(fpc);
+
+    auto cellOptions(options);
+    cellOptions.flags(options.flags() | SimplifyOption::INNERBORDER);
+    // cells already run in parallel, keep per-cell decimation serial
+    cellOptions.nThreads(1);
+
+    int nThreads(int(*options.nThreads()));
+    if (!nThreads) {
+        nThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    const auto cells(std::int64_t(fpc.size()));
+    std::vector<Mesh> cellMeshes(fpc.size());
+
+    UTILITY_OMP(parallel for schedule(dynamic) num_threads(nThreads))
+    for (std::int64_t i = 0; i < cells; ++i) {
+        auto cellMesh(clip(mesh, fpc.cellExtents(i)));
+        if (cellMesh.faces.size() > fpc[i]) {
+            simplifyInPlace(cellMesh, int(fpc[i]), cellOptions);
+        }
+        cellMeshes[i] = std::move(cellMesh);
+    }
+
+    // deterministic merge in cell order; border vertices produced by
+    // clipping are bit-identical between neighboring cells -> weld them
+    auto pmesh(std::make_shared<geometry::Mesh>());
+    auto &out(*pmesh);
+
+    typedef math::Points3::size_type Index;
+    std::map<math::Point3, Index> vMap;
+
+    for (const auto &cellMesh : cellMeshes) {
+        for (const auto &face : cellMesh.faces) {
+            Index indices[3];
+            const math::Point3 *points[3] = {
+                &cellMesh.vertices[face.a]
+                , &cellMesh.vertices[face.b]
+                , &cellMesh.vertices[face.c]
+            };
+
+            for (int j = 0; j < 3; j++) {
+                auto pair(vMap.insert(std::make_pair
+                                      (*points[j], out.vertices.size())));
+                if (pair.second) {
+                    out.vertices.push_back(*points[j]);
+                }
+                indices[j] = pair.first->second;
+            }
+
+            if ((indices[0] != indices[1]) && (indices[1] != indices[2])
+                && (indices[0] != indices[2]))
+            {
+                out.addFace(indices[0], indices[1], indices[2]);
+            }
+        }
+    }
+
+    return pmesh;
+}
+
+} // namespace
+
 Mesh::pointer simplifyInGrid(const Mesh &mesh, const math::Point2 &alignment
                              , const math::Size2f &cellSize
                              , const FacesPerCell::Functor &facesPerCell
@@ -1003,6 +1192,11 @@ Mesh::pointer simplifyInGrid(const Mesh &mesh, const math::Point2 &alignment
                << std::setprecision(15) << alignment;
     LOG(info2) << "[simplify] cellSize: " << cellSize;
 
+    if (options.nThreads() && (*options.nThreads() != 1)) {
+        return simplifyInGridParallel(mesh, alignment, cellSize
+                                      , facesPerCell, options);
+    }
+
     // convert to openmesh structure
     OMMesh omMesh;
     math::Extents2 me(prepareMesh(omMesh, mesh, options));
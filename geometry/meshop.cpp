@@ -30,15 +30,22 @@
  * 3D mesh operations
  */
 
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
 
+#include "mesh-adjacency.hpp"
 #include "meshop.hpp"
+#include "perfcounters.hpp"
 #include "parse-obj.hpp"
 #include "triclip.hpp"
+#include "detail/ply.hpp"
 
 #include "utility/expect.hpp"
-#include "utility/small_list.hpp"
 
 #include <set>
 #include <boost/numeric/ublas/vector.hpp>
@@ -90,6 +97,10 @@ Obj asObj(const Mesh &mesh)
 
 Mesh::pointer asMesh(const Obj &obj){
     auto newMesh(std::make_shared<geometry::Mesh>());
+    newMesh->vertices.reserve(obj.vertices.size());
+    newMesh->tCoords.reserve(obj.texcoords.size());
+    newMesh->faces.reserve(obj.facets.size());
+
     for( const auto&v : obj.vertices ){
         newMesh->vertices.push_back(v);
     }
@@ -119,49 +130,183 @@ void addMtl(std::ostream &out, const ObjMaterial &mtl, unsigned int imageId)
     out << "usemtl " << mtl.name(imageId) << '\n';
 }
 
-} // namespace
+/** Staging buffer for the fast OBJ serialization path. Tokens are
+ *  formatted into a 1 MB buffer flushed with plain write() calls, so
+ *  downstream filters (e.g. the gzip compressor) are fed in large
+ *  blocks and no per-token sentry/locale machinery of operator<< runs.
+ *  Floats are written shortest-round-trip with '.' as the decimal
+ *  point regardless of the global locale.
+ */
+class ObjWriteBuffer {
+public:
+    explicit ObjWriteBuffer(std::ostream &out)
+        : out_(out), buf_(new char[capacity]), size_(0)
+        , decimalPoint_(*std::localeconv()->decimal_point)
+    {}
+
+    ~ObjWriteBuffer() { flush(); }
+
+    void flush() {
+        GEOMETRY_PERF_ADD(perf::Counter::bytesWritten, size_);
+        if (size_) {
+            out_.write(buf_.get(), size_);
+            size_ = 0;
+        }
+    }
 
-void saveAsObj(const Mesh &mesh, std::ostream &out
-               , const ObjMaterial &mtl
-               , const boost::filesystem::path &filepath
-               , const ObjStreamSetup &streamSetup)
-{
-    for (const auto &lib : mtl.libs) {
-        out << "mtllib " << lib << '\n';
+    void put(char c) {
+        reserve(1);
+        buf_[size_++] = c;
+    }
+
+    void write(const char *data, std::size_t length) {
+        reserve(length);
+        std::memcpy(buf_.get() + size_, data, length);
+        size_ += length;
+    }
+
+    /** Shortest representation that parses back to the same double. */
+    void number(double value) {
+        char tmp[32];
+        int length(0);
+        for (int precision(15); precision <= 17; ++precision) {
+            length = std::snprintf(tmp, sizeof(tmp), "%.*g"
+                                   , precision, value);
+            if (std::strtod(tmp, nullptr) == value) { break; }
+        }
+
+        // snprintf honors the global locale; the OBJ format does not
+        if (decimalPoint_ != '.') {
+            for (int i(0); i < length; ++i) {
+                if (tmp[i] == decimalPoint_) { tmp[i] = '.'; }
+            }
+        }
+
+        write(tmp, length);
     }
 
-    if (!streamSetup.vertex(out)) {
-        out.setf(std::ios::scientific, std::ios::floatfield);
+    /** Shortest representation that parses back to the same float.
+     *  Keeps float meshes from ballooning into 17-digit doubles. */
+    void number(float value) {
+        char tmp[32];
+        int length(0);
+        for (int precision(6); precision <= 9; ++precision) {
+            length = std::snprintf(tmp, sizeof(tmp), "%.*g"
+                                   , precision, value);
+            if (std::strtof(tmp, nullptr) == value) { break; }
+        }
+
+        if (decimalPoint_ != '.') {
+            for (int i(0); i < length; ++i) {
+                if (tmp[i] == decimalPoint_) { tmp[i] = '.'; }
+            }
+        }
+
+        write(tmp, length);
     }
 
-    for (const auto &vertex : mesh.vertices) {
-        out << "v " << vertex(0) << ' ' << vertex(1) << ' '  << vertex(2)
-            << '\n';
+    void number(unsigned int value) {
+        char tmp[16];
+        char *end(tmp + sizeof(tmp)), *p(end);
+        do {
+            *--p = char('0' + (value % 10));
+            value /= 10;
+        } while (value);
+        write(p, end - p);
     }
 
-    if (!streamSetup.tx(out)) {
-        out.setf(std::ios::scientific, std::ios::floatfield);
+private:
+    void reserve(std::size_t length) {
+        if (size_ + length > capacity) { flush(); }
     }
 
-    for (const auto &tCoord : mesh.tCoords) {
-        out << "vt " << tCoord(0) << ' ' << tCoord(1) << '\n';
+    static const std::size_t capacity = std::size_t(1) << 20;
+
+    std::ostream &out_;
+    std::unique_ptr<char[]> buf_;
+    std::size_t size_;
+    char decimalPoint_;
+};
+
+/** Shared writer behind the Mesh, FloatMesh and MeshView saveAsObj
+ *  overloads; vertex components are formatted at their own precision. */
+template <typename Vertices, typename TCoords>
+void saveAsObjImpl(const Vertices &vertices
+                   , const TCoords &tCoords
+                   , const Face::list &faces
+                   , std::ostream &out
+                   , const ObjMaterial &mtl
+                   , const boost::filesystem::path &filepath
+                   , const ObjStreamSetup &streamSetup)
+{
+    for (const auto &lib : mtl.libs) {
+        out << "mtllib " << lib << '\n';
+    }
+
+    ObjWriteBuffer buffer(out);
+
+    // custom stream formatting falls back to the per-token ostream path;
+    // the default takes the buffered shortest-round-trip formatter
+    if (streamSetup.vertex(out)) {
+        for (const auto &vertex : vertices) {
+            out << "v " << vertex(0) << ' ' << vertex(1) << ' '
+                << vertex(2) << '\n';
+        }
+    } else {
+        for (const auto &vertex : vertices) {
+            buffer.write("v ", 2);
+            buffer.number(vertex(0));
+            buffer.put(' ');
+            buffer.number(vertex(1));
+            buffer.put(' ');
+            buffer.number(vertex(2));
+            buffer.put('\n');
+        }
+        buffer.flush();
+    }
+
+    if (streamSetup.tx(out)) {
+        for (const auto &tCoord : tCoords) {
+            out << "vt " << tCoord(0) << ' ' << tCoord(1) << '\n';
+        }
+    } else {
+        for (const auto &tCoord : tCoords) {
+            buffer.write("vt ", 3);
+            buffer.number(tCoord(0));
+            buffer.put(' ');
+            buffer.number(tCoord(1));
+            buffer.put('\n');
+        }
+        buffer.flush();
     }
 
     unsigned int currentImageId(static_cast<unsigned int>(-1));
 
-    for (const auto &face : mesh.faces) {
+    for (const auto &face : faces) {
         if (face.degenerate()) {
             continue;
         }
         if (face.imageId != currentImageId) {
+            buffer.flush();
             addMtl(out, mtl, face.imageId);
             currentImageId = face.imageId;
         }
 
-        out << "f " << face.a + 1 << '/' << face.ta + 1 << "/ "
-            << face.b + 1 << '/' << face.tb + 1 << "/ "
-            << face.c + 1 << '/' << face.tc + 1 << "/\n";
+        buffer.write("f ", 2);
+        buffer.number(face.a + 1);
+        buffer.put('/');
+        buffer.number(face.ta + 1);
+        buffer.write("/ ", 2);
+        buffer.number(face.b + 1);
+        buffer.put('/');
+        buffer.number(face.tb + 1);
+        buffer.write("/ ", 2);
+        buffer.number(face.c + 1);
+        buffer.put('/');
+        buffer.number(face.tc + 1);
+        buffer.write("/\n", 2);
     }
+    buffer.flush();
 
     if (!out) {
         LOGTHROW(err3, std::runtime_error)
@@ -169,6 +314,37 @@ void saveAsObj(const Mesh &mesh, std::ostream &out
     }
 }
 
+} // namespace
+
+void saveAsObj(const Mesh &mesh, std::ostream &out
+               , const ObjMaterial &mtl
+               , const boost::filesystem::path &filepath
+               , const ObjStreamSetup &streamSetup)
+{
+    saveAsObjImpl(mesh.vertices, mesh.tCoords, mesh.faces
+                  , out, mtl, filepath, streamSetup);
+}
+
+void saveAsObj(const MeshView &view, std::ostream &out
+               , const ObjMaterial &mtl
+               , const boost::filesystem::path &filepath
+               , const ObjStreamSetup &streamSetup)
+{
+    // the shared buffers are written wholesale (OBJ tolerates unused
+    // vertices), so no per-view vertex compaction is needed
+    saveAsObjImpl(view.vertices(), view.tCoords(), view.faces()
+                  , out, mtl, filepath, streamSetup);
+}
+
+void saveAsObj(const FloatMesh &mesh, std::ostream &out
+               , const ObjMaterial &mtl
+               , const boost::filesystem::path &filepath
+               , const ObjStreamSetup &streamSetup)
+{
+    saveAsObjImpl(mesh.vertices, mesh.tCoords, mesh.faces
+                  , out, mtl, filepath, streamSetup);
+}
+
 void saveAsObj(const Mesh &mesh, std::ostream &out
                , const ObjMaterial &mtl
                , const boost::filesystem::path &filepath
@@ -203,6 +379,42 @@ void saveAsObj(const Mesh &mesh, const boost::filesystem::path &filepath
     saveAsObj(mesh, f, mtl, filepath, streamSetup);
 }
 
+void saveAsObj(const MeshView &view
+               , const boost::filesystem::path &filepath
+               , const ObjMaterial &mtl, const ObjStreamSetup &streamSetup)
+{
+    LOG(info2) << "Saving mesh view to file <" << filepath << ">.";
+
+    std::ofstream f;
+    f.exceptions(std::ios::badbit | std::ios::failbit);
+    try {
+        f.open(filepath.string(), std::ios_base::out | std::ios_base::trunc);
+    } catch (const std::exception&) {
+        LOGTHROW(err3, std::runtime_error)
+            << "Unable to save mesh to <" << filepath << ">.";
+    }
+
+    saveAsObj(view, f, mtl, filepath, streamSetup);
+}
+
+void saveAsObj(const FloatMesh &mesh
+               , const boost::filesystem::path &filepath
+               , const ObjMaterial &mtl, const ObjStreamSetup &streamSetup)
+{
+    LOG(info2) << "Saving mesh to file <" << filepath << ">.";
+
+    std::ofstream f;
+    f.exceptions(std::ios::badbit | std::ios::failbit);
+    try {
+        f.open(filepath.string(), std::ios_base::out | std::ios_base::trunc);
+    } catch (const std::exception&) {
+        LOGTHROW(err3, std::runtime_error)
+            << "Unable to save mesh to <" << filepath << ">.";
+    }
+
+    saveAsObj(mesh, f, mtl, filepath, streamSetup);
+}
+
 void saveAsPly( const Mesh &mesh, const boost::filesystem::path &filepath){
     LOG(info2) << "Saving mesh to file <" << filepath << ">.";
 
@@ -253,7 +465,7 @@ void saveAsPly( const Mesh &mesh, const boost::filesystem::path &filepath){
 
 Mesh loadPly( const boost::filesystem::path &filename )
 {
-    std::ifstream f(filename.native());
+    std::ifstream f(filename.native(), std::ios::binary);
     if (!f.good()) {
         LOGTHROW(err2, std::runtime_error)
                 << "Can't open " << filename;
@@ -262,33 +474,45 @@ Mesh loadPly( const boost::filesystem::path &filename )
     f.exceptions(std::ios::badbit | std::ios::failbit);
 
     // read header
-    std::string line;
-    int nvert = -1, ntris = -1;
-    do {
-        if (getline(f, line).eof()) break;
-        sscanf(line.c_str(), "element vertex %d", &nvert);
-        sscanf(line.c_str(), "element face %d", &ntris);
-    } while (line != "end_header");
+    const auto header(detail::parsePlyHeader(f, filename));
+
+    if (header.format == detail::PlyHeader::Format::binaryLittleEndian) {
+#ifdef GEOMETRY_HAS_BIO
+        // binary fast path: bulk-map the element data
+        f.close();
+        return loadBinaryPly(filename);
+#else
+        LOGTHROW(err2, std::runtime_error)
+            << filename << ": binary PLY support is available only"
+            " when compiled with Boost.IOStreams.";
+#endif
+    }
+    if (header.format != detail::PlyHeader::Format::ascii) {
+        LOGTHROW(err2, std::runtime_error)
+            << filename << ": big-endian PLY files are not supported.";
+    }
 
-    if (nvert < 0 || ntris < 0) {
+    const auto *vertexElement(header.element("vertex"));
+    const auto *faceElement(header.element("face"));
+    if (!vertexElement || !faceElement) {
         LOGTHROW(err2, std::runtime_error)
                 << filename << ": unknown PLY format.";
     }
 
     Mesh mesh;
-    mesh.vertices.reserve(nvert);
+    mesh.vertices.reserve(vertexElement->count);
 
     // load points
-    for (int i = 0; i < nvert; i++) {
+    for (std::size_t i = 0; i < vertexElement->count; i++) {
         double x, y, z;
         f >> x >> y >> z;
         mesh.vertices.emplace_back(x, y, z);
     }
 
-    mesh.faces.reserve(ntris);
+    mesh.faces.reserve(faceElement->count);
 
     // load triangles
-    for (int i = 0; i < ntris; i++) {
+    for (std::size_t i = 0; i < faceElement->count; i++) {
         int n, a, b, c;
         f >> n >> a >> b >> c;
         utility::expect(n == 3, "Only triangles are supported in PLY files.");
@@ -300,6 +524,75 @@ Mesh loadPly( const boost::filesystem::path &filename )
 
 const unsigned int imageIdLimit(1<<16);
 
+namespace {
+
+/** Vertex/texcoord/facet record counts of an OBJ file, gathered by a
+ *  cheap block-wise pre-scan so the mesh containers can be reserved
+ *  before the parse proper.
+ */
+struct ObjRecordCounts {
+    std::size_t vertices = 0;
+    std::size_t texcoords = 0;
+    std::size_t facets = 0;
+};
+
+ObjRecordCounts countObjRecords(const boost::filesystem::path &filename)
+{
+    std::ifstream file;
+    file.exceptions(std::ios::badbit);
+    file.open(filename.string(), std::ios::binary);
+
+    ObjRecordCounts counts;
+
+    // tiny state machine over line prefixes; everything after the
+    // matched (or rejected) prefix is skipped until the next newline
+    enum class State { lineStart, sawV, sawVt, sawF, skip };
+    State state(State::lineStart);
+
+    const std::size_t blockSize(std::size_t(1) << 20);
+    std::unique_ptr<char[]> block(new char[blockSize]);
+
+    while (file) {
+        file.read(block.get(), blockSize);
+        const std::size_t size(file.gcount());
+
+        for (std::size_t b(0); b < size; ++b) {
+            const char c(block[b]);
+            if (c == '\n') { state = State::lineStart; continue; }
+
+            switch (state) {
+            case State::lineStart:
+                if (c == 'v') { state = State::sawV; }
+                else if (c == 'f') { state = State::sawF; }
+                else { state = State::skip; }
+                break;
+
+            case State::sawV:
+                if ((c == ' ') || (c == '\t')) { ++counts.vertices; }
+                else if (c == 't') { state = State::sawVt; break; }
+                state = State::skip;
+                break;
+
+            case State::sawVt:
+                if ((c == ' ') || (c == '\t')) { ++counts.texcoords; }
+                state = State::skip;
+                break;
+
+            case State::sawF:
+                if ((c == ' ') || (c == '\t')) { ++counts.facets; }
+                state = State::skip;
+                break;
+
+            case State::skip: break;
+            }
+        }
+    }
+
+    return counts;
+}
+
+} // namespace
+
 void loadObj( ObjParserBase &parser
             , const boost::filesystem::path &filename)
 {
@@ -362,6 +655,12 @@ Mesh loadObj(const boost::filesystem::path &filename, ObjMaterial *mtl)
         int namedCount;
     } parser_;
 
+    // pre-scan record counts so the mesh is built without reallocation
+    const auto counts(countObjRecords(filename));
+    parser_.mesh.vertices.reserve(counts.vertices);
+    parser_.mesh.tCoords.reserve(counts.texcoords);
+    parser_.mesh.faces.reserve(counts.facets);
+
     loadObj(parser_, filename);
 
     std::vector<std::string> materials;
@@ -390,27 +689,45 @@ Mesh loadObj(const boost::filesystem::path &filename, ObjMaterial *mtl)
 
 namespace {
 
-void clipImpl(const Mesh &omesh, Mesh &mesh
-              , const std::vector<ClipPlane> &planes)
+/** Clip triangle corner: clipping always runs in double regardless of
+ *  mesh storage scalar. */
+inline math::Point3 clipPoint(const math::Point3 &p) { return p; }
+
+inline math::Point3 clipPoint(const math::Point3_<float> &p)
 {
-    ClipTriangle::list clipped;
-    for (const auto &face : omesh.faces) {
+    return math::Point3(p(0), p(1), p(2));
+}
+
+template <typename MeshType>
+void clipImpl(const typename MeshType::Vertices &vertices
+              , const Face::list &faces
+              , MeshType &mesh
+              , const std::vector<ClipPlane> &planes
+              , ClipWorkspace<> &ws)
+{
+    typedef typename MeshType::Vertex Vertex;
+
+    GEOMETRY_PERF_TIMER(perf::Timer::clip);
+    GEOMETRY_PERF_ADD(perf::Counter::facesClipped, faces.size());
+
+    ws.clear();
+    auto &clipped(ws.triangles());
+    clipped.reserve(faces.size());
+    for (const auto &face : faces) {
         clipped.emplace_back(
-              omesh.vertices[face.a]
-            , omesh.vertices[face.b]
-            , omesh.vertices[face.c]);
+              clipPoint(vertices[face.a])
+            , clipPoint(vertices[face.b])
+            , clipPoint(vertices[face.c]));
     }
 
-    std::vector<double> tinfos;
-    for (const auto &plane : planes) {
-        clipped = clipTriangles(clipped, plane, tinfos);
-    }
+    // batch mode: fully inside/outside faces bypass the clip machinery
+    clipTriangles(ws, planes);
 
     typedef math::Points3::size_type Index;
     std::map<math::Point3, Index> pMap;
     Index next = 0;
 
-    for (const auto &triangle : clipped)
+    for (const auto &triangle : ws.triangles())
     {
         Index indices[3];
         for (int i = 0; i < 3; i++)
@@ -422,7 +739,8 @@ void clipImpl(const Mesh &omesh, Mesh &mesh
             indices[i] = pair.first->second;
 
             if (indices[i] >= mesh.vertices.size()) {
-                mesh.vertices.push_back(triangle.pos[i]);
+                const auto &pos(triangle.pos[i]);
+                mesh.vertices.push_back(Vertex(pos(0), pos(1), pos(2)));
             }
         }
         // do not add degenerated faces
@@ -462,82 +780,130 @@ std::vector<ClipPlane> planes(const math::Extents3 &extents)
 Mesh clip(const Mesh &omesh, const math::Extents2 &extents)
 {
     Mesh out;
-    clipImpl(omesh, out, planes(extents));
+    ClipWorkspace<> ws;
+    clipImpl(omesh.vertices, omesh.faces, out, planes(extents), ws);
     return out;
 }
 
 Mesh clip(const Mesh &omesh, const math::Extents3 &extents)
 {
     Mesh out;
-    clipImpl(omesh, out, planes(extents));
+    ClipWorkspace<> ws;
+    clipImpl(omesh.vertices, omesh.faces, out, planes(extents), ws);
     return out;
 }
 
-Mesh::pointer removeNonManifoldEdges(Mesh omesh)
+Mesh clip(const Mesh &omesh, const math::Extents2 &extents
+          , ClipWorkspace<> &ws)
 {
-    auto ofaces = omesh.faces;
-    auto pmesh(std::make_shared<geometry::Mesh>(std::move(omesh)));
-    auto& mesh(*pmesh);
-    mesh.faces.clear();
-    mesh.faces.shrink_to_fit();
+    Mesh out;
+    clipImpl(omesh.vertices, omesh.faces, out, planes(extents), ws);
+    return out;
+}
 
-    typedef Face::index_type index_type;
+Mesh clip(const Mesh &omesh, const math::Extents3 &extents
+          , ClipWorkspace<> &ws)
+{
+    Mesh out;
+    clipImpl(omesh.vertices, omesh.faces, out, planes(extents), ws);
+    return out;
+}
 
-    struct EdgeKey
-    {
-        index_type v1, v2; // vertex indices
+Mesh clip(const MeshView &view, const math::Extents2 &extents)
+{
+    Mesh out;
+    ClipWorkspace<> ws;
+    clipImpl(view.vertices(), view.faces(), out, planes(extents), ws);
+    return out;
+}
 
-        EdgeKey(index_type v1, index_type v2)
-        {
-            this->v1 = std::min(v1, v2);
-            this->v2 = std::max(v1, v2);
-        }
+Mesh clip(const MeshView &view, const math::Extents3 &extents)
+{
+    Mesh out;
+    ClipWorkspace<> ws;
+    clipImpl(view.vertices(), view.faces(), out, planes(extents), ws);
+    return out;
+}
 
-        bool operator< (const EdgeKey& other) const
-        {
-            return (v1 == other.v1) ? (v2 < other.v2) : (v1 < other.v1);
-        }
-    };
+Mesh clip(const MeshView &view, const math::Extents2 &extents
+          , ClipWorkspace<> &ws)
+{
+    Mesh out;
+    clipImpl(view.vertices(), view.faces(), out, planes(extents), ws);
+    return out;
+}
 
-    struct Edge {
-        utility::small_list<index_type, 2> facesIndices;
-    };
+Mesh clip(const MeshView &view, const math::Extents3 &extents
+          , ClipWorkspace<> &ws)
+{
+    Mesh out;
+    clipImpl(view.vertices(), view.faces(), out, planes(extents), ws);
+    return out;
+}
 
-    //count faces for each edge
-    std::map<EdgeKey,Edge> edgeMap;
-    for(index_type fi=0; fi<ofaces.size(); fi++){
-        const auto & face(ofaces[fi]);
-        EdgeKey edgeKeys[3] = { EdgeKey(face.a,face.b)
-                           , EdgeKey(face.b,face.c)
-                           , EdgeKey(face.c,face.a) };
-        for(const auto & key : edgeKeys){
-            auto it = edgeMap.find(key);
-            if(it==edgeMap.end()){
-                //if edge is not present insert it with current face
-                Edge edge;
-                edge.facesIndices.insert(fi);
-                edgeMap.insert(std::make_pair(key,edge));
-            }
-            else{
-                //if edge is present add current face to it
-                it->second.facesIndices.insert(fi);
-            }
-        }
-    }
+FloatMesh clip(const FloatMesh &omesh, const math::Extents2 &extents)
+{
+    FloatMesh out;
+    ClipWorkspace<> ws;
+    clipImpl(omesh.vertices, omesh.faces, out, planes(extents), ws);
+    return out;
+}
+
+FloatMesh clip(const FloatMesh &omesh, const math::Extents3 &extents)
+{
+    FloatMesh out;
+    ClipWorkspace<> ws;
+    clipImpl(omesh.vertices, omesh.faces, out, planes(extents), ws);
+    return out;
+}
+
+FloatMesh clip(const FloatMesh &omesh, const math::Extents2 &extents
+               , ClipWorkspace<> &ws)
+{
+    FloatMesh out;
+    clipImpl(omesh.vertices, omesh.faces, out, planes(extents), ws);
+    return out;
+}
+
+FloatMesh clip(const FloatMesh &omesh, const math::Extents3 &extents
+               , ClipWorkspace<> &ws)
+{
+    FloatMesh out;
+    clipImpl(omesh.vertices, omesh.faces, out, planes(extents), ws);
+    return out;
+}
+
+Mesh::pointer removeNonManifoldEdges(Mesh omesh)
+{
+    typedef Face::index_type index_type;
 
     //collect faces incident with non-manifold edge
-    std::set<index_type> facesToOmit;
-    for(auto it = edgeMap.begin(); it!=edgeMap.end(); it++){
-        if(it->second.facesIndices.size()>2){
-            it->second.facesIndices.for_each([&](index_type fi) {
-                facesToOmit.insert(fi);
-            });
+    std::vector<char> facesToOmit;
+    {
+        const auto padj(meshAdjacency(omesh));
+        const auto &adj(*padj);
+
+        facesToOmit.assign(omesh.faces.size(), false);
+        for (std::size_t e(0); e < adj.edgeCount(); ++e) {
+            if (!adj.nonManifold(index_type(e))) { continue; }
+            for (const auto *ih(adj.begin(index_type(e)))
+                     ; ih != adj.end(index_type(e)); ++ih)
+            {
+                facesToOmit[MeshAdjacency::halfedgeFace(*ih)] = true;
+            }
         }
     }
 
+    auto ofaces(std::move(omesh.faces));
+    omesh.faces.clear();
+    omesh.adjacency.reset();
+
+    auto pmesh(std::make_shared<geometry::Mesh>(std::move(omesh)));
+    auto& mesh(*pmesh);
+
     for(index_type fi=0; fi<ofaces.size(); fi++){
         const auto & face(ofaces[fi]);
-        if(facesToOmit.find(fi)==facesToOmit.end()){
+        if(!facesToOmit[fi]){
             mesh.addFace( face.a, face.b, face.c
                         , face.ta, face.tb, face.tc );
         }
@@ -586,11 +952,118 @@ Mesh::pointer removeIsolatedVertices( const Mesh& imesh ){
     return pmesh;
 }
 
+void cleanup(Mesh &mesh, CleanupOptions flags)
+{
+    typedef Face::index_type index_type;
 
-Mesh::pointer refine( const Mesh & omesh, unsigned int maxFacesCount)
+    //collect faces incident with non-manifold edge
+    std::vector<char> omit;
+    if (flags & CleanupOption::RMNONMANIFOLD) {
+        const auto padj(meshAdjacency(mesh));
+        const auto &adj(*padj);
+
+        omit.assign(mesh.faces.size(), false);
+        for (std::size_t e(0); e < adj.edgeCount(); ++e) {
+            if (!adj.nonManifold(index_type(e))) { continue; }
+            for (const auto *ih(adj.begin(index_type(e)))
+                     ; ih != adj.end(index_type(e)); ++ih)
+            {
+                omit[MeshAdjacency::halfedgeFace(*ih)] = true;
+            }
+        }
+    }
+
+    //compact the face list within its storage
+    {
+        std::size_t write(0);
+        for (std::size_t fi(0); fi < mesh.faces.size(); ++fi) {
+            const auto &face(mesh.faces[fi]);
+            if (!omit.empty() && omit[fi]) { continue; }
+            if ((flags & CleanupOption::RMDEGENERATE)
+                && mesh.degenerate(face))
+            {
+                continue;
+            }
+            if (write != fi) { mesh.faces[write] = face; }
+            ++write;
+        }
+        if (write != mesh.faces.size()) {
+            LOG(info1) << "cleanup: dropped "
+                       << (mesh.faces.size() - write) << " faces.";
+            mesh.faces.resize(write);
+            mesh.adjacency.reset();
+        }
+    }
+
+    if (!(flags & CleanupOption::RMISOLATED)) { return; }
+
+    //mark vertices and tcoords referenced by the surviving faces
+    std::vector<index_type> vertexMap(mesh.vertices.size(), 0);
+    std::vector<index_type> tCoordMap(mesh.tCoords.size(), 0);
+    for (const auto &face : mesh.faces) {
+        vertexMap[face.a] = vertexMap[face.b] = vertexMap[face.c] = 1;
+        if (!tCoordMap.empty()) {
+            tCoordMap[face.ta] = tCoordMap[face.tb] = tCoordMap[face.tc] = 1;
+        }
+    }
+
+    //order-preserving in-place compaction; maps then hold new indices
+    const bool hasClass(mesh.vertecesClass.size() == mesh.vertices.size());
+    index_type write(0);
+    for (std::size_t v(0); v < mesh.vertices.size(); ++v) {
+        if (!vertexMap[v]) { continue; }
+        if (write != v) {
+            mesh.vertices[write] = mesh.vertices[v];
+            if (hasClass) {
+                mesh.vertecesClass[write] = mesh.vertecesClass[v];
+            }
+        }
+        vertexMap[v] = write++;
+    }
+    const auto droppedVertices(mesh.vertices.size() - write);
+    mesh.vertices.resize(write);
+    if (hasClass) { mesh.vertecesClass.resize(write); }
+
+    write = 0;
+    for (std::size_t t(0); t < mesh.tCoords.size(); ++t) {
+        if (!tCoordMap[t]) { continue; }
+        if (write != t) { mesh.tCoords[write] = mesh.tCoords[t]; }
+        tCoordMap[t] = write++;
+    }
+    const auto droppedTCoords(mesh.tCoords.size() - write);
+    mesh.tCoords.resize(write);
+
+    if (!droppedVertices && !droppedTCoords) { return; }
+
+    LOG(info1) << "cleanup: dropped " << droppedVertices
+               << " isolated vertices, " << droppedTCoords
+               << " texture coordinates.";
+
+    for (auto &face : mesh.faces) {
+        face.a = vertexMap[face.a];
+        face.b = vertexMap[face.b];
+        face.c = vertexMap[face.c];
+        if (!tCoordMap.empty()) {
+            face.ta = tCoordMap[face.ta];
+            face.tb = tCoordMap[face.tb];
+            face.tc = tCoordMap[face.tc];
+        }
+    }
+    mesh.adjacency.reset();
+}
+
+void removeNonManifoldEdgesInPlace(Mesh &mesh)
 {
-    auto pmesh(std::make_shared<geometry::Mesh>(omesh));
-    auto & mesh(*pmesh);
+    cleanup(mesh, CleanupOption::RMNONMANIFOLD);
+}
+
+void removeIsolatedVerticesInPlace(Mesh &mesh)
+{
+    cleanup(mesh, CleanupOption::RMISOLATED);
+}
+
+
+struct MeshRefiner::Impl {
 
     struct EdgeKey
     {
@@ -687,6 +1160,59 @@ Mesh::pointer refine( const Mesh & omesh, unsigned int maxFacesCount)
             return *heap[0];
         }
 
+        /** Seeds the map from the shared mesh adjacency in one pass.
+         *  Edges arrive ordered by (v1, v2), so the hinted map inserts
+         *  are amortized constant and the heap is built in linear time.
+         */
+        void seed(const Mesh &mesh, const MeshAdjacency &adj){
+            for (std::size_t e(0); e < adj.edgeCount(); ++e) {
+                std::shared_ptr<Edge> edge;
+
+                const auto ei(MeshAdjacency::index_type(e));
+                for (const auto *ih(adj.begin(ei)); ih != adj.end(ei)
+                         ; ++ih)
+                {
+                    const auto fid(MeshAdjacency::halfedgeFace(*ih));
+                    const auto &f(mesh.faces[fid]);
+
+                    std::size_t pv1, pv2;
+                    Edge::EdgeType type;
+                    switch (MeshAdjacency::halfedgeCorner(*ih)) {
+                    case 0:
+                        pv1 = f.a; pv2 = f.b;
+                        type = Edge::EdgeType::AB;
+                        break;
+                    case 1:
+                        pv1 = f.b; pv2 = f.c;
+                        type = Edge::EdgeType::BC;
+                        break;
+                    default:
+                        pv1 = f.c; pv2 = f.a;
+                        type = Edge::EdgeType::CA;
+                        break;
+                    }
+
+                    if (!edge) {
+                        auto length(float(ublas::norm_2
+                            (mesh.vertices[pv1] - mesh.vertices[pv2])));
+                        edge = std::make_shared<Edge>(pv1, pv2, length);
+                    }
+                    edge->addFace(pv1, pv2, int(fid), type);
+                }
+
+                map.insert(map.end()
+                           , std::make_pair(EdgeKey(edge->v1, edge->v2)
+                                            , edge));
+                heap.push_back(edge);
+            }
+
+            std::make_heap(heap.begin(), heap.end()
+                           , [this]( const std::shared_ptr<Edge> &a
+                                   , const std::shared_ptr<Edge> &b){
+                return this->compareEdgePtr(a,b);
+            });
+        }
+
         void addFaceEdges(const Mesh & mesh, int fid){
             const auto& f = mesh.faces[fid];
             auto e1Length =  float(ublas::norm_2(mesh.vertices[f.a]-mesh.vertices[f.b]));
@@ -705,10 +1231,19 @@ Mesh::pointer refine( const Mesh & omesh, unsigned int maxFacesCount)
 
     };
 
+    Mesh::pointer pmesh;
     EdgeMap edgeMap;
 
-    auto splitEdge = [&mesh,&edgeMap]( int fid, Edge::EdgeType type
-                       , std::size_t vid) mutable -> void{
+    Impl(const Mesh &omesh)
+        : pmesh(std::make_shared<geometry::Mesh>(omesh))
+    {
+        //add all edges from the shared adjacency in one pass
+        auto & mesh(*pmesh);
+        edgeMap.seed(mesh, *meshAdjacency(mesh));
+    }
+
+    void splitEdge( int fid, Edge::EdgeType type, std::size_t vid ){
+        auto & mesh(*pmesh);
         auto & face = mesh.faces[fid];
         switch(type){
             case Edge::EdgeType::AB:
@@ -768,35 +1303,60 @@ Mesh::pointer refine( const Mesh & omesh, unsigned int maxFacesCount)
                 }
                 break;
         }
-    };
-
-    for (std::size_t i=0; i<mesh.faces.size(); ++i ) {
-        //add all 3 edges
-        edgeMap.addFaceEdges(mesh, int(i));
     }
 
-    //sort edges by length
-    while( mesh.faces.size() < maxFacesCount && edgeMap.size()>0 ){
-        //split edge
-        auto edge = edgeMap.pop_top_edge();
+    std::size_t step(std::size_t maxSplits, unsigned int maxFacesCount){
+        auto & mesh(*pmesh);
 
-        //find middle
-        math::Point3 middle = (mesh.vertices[edge.v1]
-                            + mesh.vertices[edge.v2]) * 0.5;
-        mesh.vertices.push_back(middle);
+        std::size_t splits(0);
+        //split longest edges until budget or slice is exhausted
+        while( splits < maxSplits
+               && mesh.faces.size() < maxFacesCount && edgeMap.size()>0 ){
+            //split edge
+            auto edge = edgeMap.pop_top_edge();
 
-        //split first face
-        if(edge.f1>=0){
-            splitEdge(edge.f1, edge.et1, mesh.vertices.size()-1);
-        }
+            //find middle
+            math::Point3 middle = (mesh.vertices[edge.v1]
+                                + mesh.vertices[edge.v2]) * 0.5;
+            mesh.vertices.push_back(middle);
+
+            //split first face
+            if(edge.f1>=0){
+                splitEdge(edge.f1, edge.et1, mesh.vertices.size()-1);
+            }
+
+            //split second face
+            if(edge.f2>=0){
+                splitEdge(edge.f2, edge.et2, mesh.vertices.size()-1);
+            }
 
-        //split second face
-        if(edge.f2>=0){
-            splitEdge(edge.f2, edge.et2, mesh.vertices.size()-1);
+            ++splits;
         }
+
+        return splits;
     }
+};
 
-    return pmesh;
+MeshRefiner::MeshRefiner(const Mesh &mesh) : impl_(new Impl(mesh)) {}
+
+MeshRefiner::~MeshRefiner() = default;
+
+std::size_t MeshRefiner::step(std::size_t maxSplits
+                              , unsigned int maxFacesCount)
+{
+    return impl_->step(maxSplits, maxFacesCount);
+}
+
+Mesh::pointer MeshRefiner::mesh() const { return impl_->pmesh; }
+
+Mesh::pointer refine( const Mesh & omesh, unsigned int maxFacesCount)
+{
+    MeshRefiner refiner(omesh);
+
+    // one-shot refinement; slicing only bounds the inner loop
+    while (refiner.step(1024, maxFacesCount)) {}
+
+    return refiner.mesh();
 }
 
 MeshInfo measurePly(std::istream &is, const boost::filesystem::path &path)
@@ -844,7 +1404,9 @@ void loadPly(ObjParserBase &parser, std::istream &is
 
 MeshInfo measurePly(const boost::filesystem::path &path)
 {
-    std::ifstream f(path.string());
+    // binary open: the header is text either way and element data of
+    // binary files must not trip the stream
+    std::ifstream f(path.string(), std::ios::binary);
     if (!f.good()) {
         LOGTHROW(err2, std::runtime_error)
             << "Can't open PLY file " << path << ".";
@@ -891,7 +1453,7 @@ bool objHasVertexOrFace(const boost::filesystem::path &path)
 
 void loadPly(ObjParserBase &parser, const boost::filesystem::path &path)
 {
-    std::ifstream f(path.string());
+    std::ifstream f(path.string(), std::ios::binary);
     if (!f.good()) {
         LOGTHROW(err2, std::runtime_error)
             << "Can't open PLY file " << path << ".";
@@ -899,12 +1461,46 @@ void loadPly(ObjParserBase &parser, const boost::filesystem::path &path)
 
     f.exceptions(std::ios::badbit | std::ios::failbit);
 
+    const auto header(detail::parsePlyHeader(f, path));
+
+    if (header.format == detail::PlyHeader::Format::binaryLittleEndian) {
+#ifdef GEOMETRY_HAS_BIO
+        // binary fast path: mapped load, then feed the parser
+        f.close();
+        const auto mesh(loadBinaryPly(path));
+
+        ObjParserBase::Vector3d v;
+        for (const auto &vertex : mesh.vertices) {
+            v.x = vertex(0); v.y = vertex(1); v.z = vertex(2);
+            parser.addVertex(v);
+        }
+
+        ObjParserBase::Facet facet;
+        for (const auto &face : mesh.faces) {
+            facet.v[0] = int(face.a);
+            facet.v[1] = int(face.b);
+            facet.v[2] = int(face.c);
+            parser.addFacet(facet);
+        }
+        return;
+#else
+        LOGTHROW(err2, std::runtime_error)
+            << path << ": binary PLY support is available only"
+            " when compiled with Boost.IOStreams.";
+#endif
+    }
+
+    // ascii path re-reads the header itself
+    f.seekg(0);
     loadPly(parser, f, path);
 
     f.close();
 }
 
-void append(Mesh &mesh, const Mesh &added)
+namespace {
+
+template <typename MeshType>
+void appendImpl(MeshType &mesh, const MeshType &added)
 {
     // remember vertex indexing shift and append vertices
     const auto vShift(mesh.vertices.size());
@@ -924,6 +1520,81 @@ void append(Mesh &mesh, const Mesh &added)
     }
 }
 
+} // namespace
+
+void append(Mesh &mesh, const Mesh &added)
+{
+    appendImpl(mesh, added);
+}
+
+void append(FloatMesh &mesh, const FloatMesh &added)
+{
+    appendImpl(mesh, added);
+}
+
+void MeshBuilder::reserve(std::size_t vertexCount, std::size_t tCoordCount
+                          , std::size_t faceCount)
+{
+    mesh_.vertices.reserve(vertexCount);
+    mesh_.tCoords.reserve(tCoordCount);
+    mesh_.faces.reserve(faceCount);
+    if (weldVertices_) { vertexIndex_.reserve(vertexCount); }
+}
+
+void MeshBuilder::reserve(const Mesh::list &meshes)
+{
+    std::size_t vertexCount(0), tCoordCount(0), faceCount(0);
+    for (const auto &m : meshes) {
+        vertexCount += m.vertices.size();
+        tCoordCount += m.tCoords.size();
+        faceCount += m.faces.size();
+    }
+    reserve(vertexCount, tCoordCount, faceCount);
+}
+
+void MeshBuilder::append(const Mesh &added)
+{
+    if (!weldVertices_) {
+        geometry::append(mesh_, added);
+        return;
+    }
+
+    // weld: map every vertex through the hashed index; fresh points get
+    // sequential indices, so pushing them as they appear keeps
+    // mesh_.vertices parallel with the index
+    vertexIndex_.assignMany(added.vertices.data(), added.vertices.size()
+                            , vertexMap_);
+    for (std::size_t i(0); i < added.vertices.size(); ++i) {
+        if (vertexMap_[i] == mesh_.vertices.size()) {
+            mesh_.vertices.push_back(added.vertices[i]);
+        }
+    }
+
+    const auto tcShift(mesh_.tCoords.size());
+    mesh_.tCoords.insert(mesh_.tCoords.end(), added.tCoords.begin()
+                         , added.tCoords.end());
+
+    for (const auto &f : added.faces) {
+        mesh_.addFace(vertexMap_[f.a], vertexMap_[f.b], vertexMap_[f.c]
+                      , f.ta + tcShift, f.tb + tcShift, f.tc + tcShift
+                      , f.imageId);
+    }
+}
+
+void MeshBuilder::append(Mesh &&added)
+{
+    // take over the first mesh wholesale when nothing was reserved or
+    // appended yet; welding needs every vertex to go through the index
+    if (!weldVertices_ && mesh_.vertices.empty() && mesh_.faces.empty()
+        && !mesh_.vertices.capacity())
+    {
+        mesh_ = std::move(added);
+        return;
+    }
+
+    append(added);
+}
+
 Mesh::list splitById(const Mesh &mesh)
 {
     typedef unsigned int ImageId;
@@ -976,4 +1647,21 @@ Mesh::list splitById(const Mesh &mesh)
     return out;
 }
 
+MeshView::list splitById(const std::shared_ptr<const Mesh> &mesh)
+{
+    // group faces per image id; vertices and texture coordinates stay
+    // in the shared parent buffers, so nothing else is copied
+    std::unordered_map<unsigned int, Face::list> groups;
+    for (const auto &face : mesh->faces) {
+        groups[face.imageId].push_back(face);
+    }
+
+    MeshView::list out;
+    out.reserve(groups.size());
+    for (auto &group : groups) {
+        out.emplace_back(mesh, std::move(group.second));
+    }
+    return out;
+}
+
 } // namespace geometry
@@ -34,6 +34,7 @@
 #define geometry_meshop_hpp_included_
 
 #include <iostream>
+#include <memory>
 
 #include <boost/optional.hpp>
 
@@ -41,6 +42,9 @@
 
 #include "mesh.hpp"
 #include "parse-obj.hpp"
+#include "pointindex.hpp"
+#include "triclip.hpp"
+#include "zstd-blocks.hpp"
 
 // Needed to get OpenMesh version
 #ifdef GEOMETRY_HAS_OPENMESH
@@ -74,8 +78,22 @@ public:
         : flags_(flags), alternativeVertices_() {}
 
     SimplifyOptions& flags(long long flags) { flags_ = flags; return *this; }
+    long long flags() const { return flags_; }
     bool check(long long flag) const { return flags_ & flag; }
 
+    /** Worker thread count for simplification; unset or 1 runs the
+     *  serial path, 0 means all hardware threads. Grid simplification
+     *  parallelizes over cells, plain simplification decimates rounds of
+     *  independent collapse sets in parallel.
+     */
+    SimplifyOptions& nThreads(const boost::optional<unsigned int> &nThreads)
+    {
+        nThreads_ = nThreads; return *this;
+    }
+    const boost::optional<unsigned int>& nThreads() const {
+        return nThreads_;
+    }
+
     SimplifyOptions& maxError(const boost::optional<double> &maxError)
     {
         maxError_ = maxError; return *this;
@@ -138,6 +156,7 @@ public:
 
 private:
     long long flags_;
+    boost::optional<unsigned int> nThreads_;
     boost::optional<double> maxError_;
     boost::optional<float> maxEdgeLength_;
     boost::optional<float> minAspectRatio_;
@@ -199,6 +218,38 @@ void simplifyInPlace(Mesh &mesh, int faceCount
 #endif
     ;
 
+/** Reusable decimation context for LOD chains.
+ *
+ * Holds the OpenMesh conversion of the input mesh and the configured
+ * decimator (error quadrics included) across successive simplify()
+ * calls, so simplifying one mesh to several face budgets costs a single
+ * conversion plus incremental collapses. Face-count targets must be
+ * non-increasing: each call continues decimating the state left by the
+ * previous one.
+ */
+class SimplifyContext {
+public:
+    SimplifyContext(const Mesh &mesh
+                    , const SimplifyOptions &simplifyOptions
+                     =  SimplifyOption::CORNERS
+                     | SimplifyOption::RMNONMANIFOLDEDGES)
+#ifndef GEOMETRY_HAS_OPENMESH
+    UTILITY_FUNCTION_ERROR("Mesh simplification is available only when compiled with OpenMesh.")
+#endif
+    ;
+
+    ~SimplifyContext();
+
+    /** Decimates the held mesh down to faceCount faces and returns a
+     *  snapshot of the current state.
+     */
+    Mesh::pointer simplify(int faceCount);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 /** Simplify mesh with maximal geometric error
  * \param mesh mesh to simplify
  * \param maxErr maximal geometric error
@@ -219,6 +270,36 @@ Mesh::pointer simplifyToError(const Mesh &mesh, double maxErr
  */
 Mesh::pointer refine( const Mesh &mesh, unsigned int maxFacesCount);
 
+/** Incremental, cancellable variant of refine().
+ *
+ * Holds the longest-edge priority queue and the edge/face adjacency
+ * across calls, so refinement can run in scheduled slices instead of
+ * one blocking call. Cancellation is simply dropping the object;
+ * calling step() later with a larger face budget resumes where the
+ * previous budget stopped without recomputing from the original mesh.
+ */
+class MeshRefiner {
+public:
+    /** Copies the input mesh and builds the edge bookkeeping. */
+    MeshRefiner(const Mesh &mesh);
+
+    ~MeshRefiner();
+
+    /** Performs at most maxSplits edge splits, stopping early once the
+     *  mesh holds maxFacesCount faces or no splittable edge remains.
+     *  Returns the number of splits performed; zero means there is
+     *  nothing left to do for this budget.
+     */
+    std::size_t step(std::size_t maxSplits, unsigned int maxFacesCount);
+
+    /** Refined mesh; live, mutates as step() progresses. */
+    Mesh::pointer mesh() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 /** Removes non manifold edges (edges with more than 2 incident faces)
  ** and their incident faces.
  *
@@ -235,6 +316,38 @@ Mesh::pointer removeNonManifoldEdges(Mesh omesh);
  */
 Mesh::pointer removeIsolatedVertices( const Mesh& omesh );
 
+/** Mesh cleanup flags, see cleanup().
+ */
+enum CleanupOption
+{
+    RMISOLATED = 1,
+    RMDEGENERATE = 2,
+    RMNONMANIFOLD = 4
+};
+
+typedef long long CleanupOptions;
+
+/** Combined in-place mesh cleanup.
+ *
+ * Per flags drops faces incident with non-manifold edges, degenerate
+ * faces and isolated vertices in one traversal. Face and vertex arrays
+ * are compacted within their existing storage; nothing is copied or
+ * reallocated, so chaining cleanups over multi-GB meshes costs no
+ * intermediate meshes.
+ */
+void cleanup(Mesh &mesh, CleanupOptions flags
+             = CleanupOption::RMISOLATED
+             | CleanupOption::RMDEGENERATE
+             | CleanupOption::RMNONMANIFOLD);
+
+/** In-place variant of removeNonManifoldEdges().
+ */
+void removeNonManifoldEdgesInPlace(Mesh &mesh);
+
+/** In-place variant of removeIsolatedVertices().
+ */
+void removeIsolatedVerticesInPlace(Mesh &mesh);
+
 /** Clips mesh to the given 3d extents
  *
  * \param mesh mesh to clip
@@ -251,10 +364,91 @@ Mesh clip(const Mesh &omesh, const math::Extents3 &extents);
  */
 Mesh clip(const Mesh &omesh, const math::Extents2 &extents);
 
+/** Same as clip() above, with caller-provided clipping workspace: all
+ *  temporary triangle storage lives in ws and its capacity is reused
+ *  across calls (useful when clipping many meshes/tiles in a loop).
+ */
+Mesh clip(const Mesh &omesh, const math::Extents3 &extents
+          , ClipWorkspace<> &ws);
+
+Mesh clip(const Mesh &omesh, const math::Extents2 &extents
+          , ClipWorkspace<> &ws);
+
+/** Clips a mesh view (see MeshView in mesh.hpp): reads the shared
+ *  vertex buffer in place, so concurrent clips of many views over one
+ *  parent mesh copy nothing.
+ */
+Mesh clip(const MeshView &view, const math::Extents3 &extents);
+
+Mesh clip(const MeshView &view, const math::Extents2 &extents);
+
+Mesh clip(const MeshView &view, const math::Extents3 &extents
+          , ClipWorkspace<> &ws);
+
+Mesh clip(const MeshView &view, const math::Extents2 &extents
+          , ClipWorkspace<> &ws);
+
+/** Single-precision variants. Mesh storage stays float; the clip
+ *  arithmetic itself runs in double (the workspace is shared with the
+ *  double overloads), so plane tests do not lose robustness.
+ */
+FloatMesh clip(const FloatMesh &omesh, const math::Extents3 &extents);
+
+FloatMesh clip(const FloatMesh &omesh, const math::Extents2 &extents);
+
+FloatMesh clip(const FloatMesh &omesh, const math::Extents3 &extents
+               , ClipWorkspace<> &ws);
+
+FloatMesh clip(const FloatMesh &omesh, const math::Extents2 &extents
+               , ClipWorkspace<> &ws);
+
 /** Appends one mesh to the another. Fixed face indices.
  */
 void append(Mesh &mesh, const Mesh &added);
 
+void append(FloatMesh &mesh, const FloatMesh &added);
+
+/** Streaming mesh assembly from many sub-meshes (e.g. splitById output).
+ *
+ * Repeated append(Mesh&, const Mesh&) chains reallocate the growing
+ * vectors over and over; the builder instead reserves target storage
+ * once -- either from explicit totals or from a first pass over the
+ * whole list -- and then appends sub-meshes into it. The first appended
+ * mesh is taken over by move when nothing was reserved yet. With
+ * weldVertices set, exactly identical vertices are deduplicated across
+ * sub-mesh boundaries while merging.
+ */
+class MeshBuilder {
+public:
+    explicit MeshBuilder(bool weldVertices = false)
+        : weldVertices_(weldVertices)
+    {}
+
+    /** Pre-sizes storage for the expected element totals.
+     */
+    void reserve(std::size_t vertexCount, std::size_t tCoordCount
+                 , std::size_t faceCount);
+
+    /** Pre-sizes storage from a pass over the whole input list.
+     */
+    void reserve(const Mesh::list &meshes);
+
+    void append(const Mesh &added);
+    void append(Mesh &&added);
+
+    /** Returns the assembled mesh, leaving the builder empty.
+     */
+    Mesh detach() { return std::move(mesh_); }
+
+    const Mesh& mesh() const { return mesh_; }
+
+private:
+    bool weldVertices_;
+    Mesh mesh_;
+    HashedPointIndex<math::Point3> vertexIndex_;
+    std::vector<unsigned> vertexMap_;
+};
+
 /** Support structure for faces-per-tile calculation.
  */
 class FacesPerCell {
@@ -365,7 +559,10 @@ struct ObjMaterial {
 
 /** Callback for setting up stream before saving mesh as OBJ.
  *  Returns if stream precision has been set.
- *  Stream precision is configured when false is returned.
+ *  When false is returned the writer takes the fast buffered path with
+ *  its own locale-independent shortest-round-trip float formatting;
+ *  returning true keeps the configured stream formatting and writes
+ *  through the ostream token by token.
  */
 struct ObjStreamSetup {
     virtual bool vertex(std::ostream&) const { return false; };
@@ -404,6 +601,34 @@ void saveAsObj(const Mesh &mesh, std::ostream &out
                , const boost::filesystem::path &filepath
                , const ObjStreamSetup &streamSetup);
 
+/** Saves a mesh view as OBJ. The shared vertex and texture coordinate
+ *  buffers are written wholesale (OBJ tolerates unused vertices), so
+ *  nothing is copied or compacted; materialize() the view first when a
+ *  compact file matters more than write speed.
+ */
+void saveAsObj(const MeshView &view
+               , const boost::filesystem::path &filepath
+               , const ObjMaterial &mtl
+               , const ObjStreamSetup &streamSetup = ObjStreamSetup());
+
+void saveAsObj(const MeshView &view, std::ostream &out
+               , const ObjMaterial &mtl
+               , const boost::filesystem::path &filepath = "UNKNOWN"
+               , const ObjStreamSetup &streamSetup = ObjStreamSetup());
+
+/** Single-precision variants; identical output format, the writer is
+ *  shared across storage scalars.
+ */
+void saveAsObj(const FloatMesh &mesh
+               , const boost::filesystem::path &filepath
+               , const ObjMaterial &mtl
+               , const ObjStreamSetup &streamSetup = ObjStreamSetup());
+
+void saveAsObj(const FloatMesh &mesh, std::ostream &out
+               , const ObjMaterial &mtl
+               , const boost::filesystem::path &filepath = "UNKNOWN"
+               , const ObjStreamSetup &streamSetup = ObjStreamSetup());
+
 void saveAsGzippedObj(const Mesh &mesh
                       , const boost::filesystem::path &filepath
                       , const ObjMaterial &mtl
@@ -423,6 +648,22 @@ void saveAsGzippedObj(const Mesh &mesh
 #endif
     ;
 
+/** Writes the mesh as an OBJ wrapped in the zstd block container (see
+ *  zstd-blocks.hpp); blocks are compressed by a worker pool. The OBJ
+ *  text is serialized into memory first. Much cheaper to write and
+ *  somewhat smaller than saveAsGzippedObj().
+ */
+void saveAsZstdObj(const Mesh &mesh
+                   , const boost::filesystem::path &filepath
+                   , const ObjMaterial &mtl
+                   , const ObjStreamSetup &streamSetup = ObjStreamSetup()
+                   , const ZstdBlocksOptions &zstdOptions
+                   = ZstdBlocksOptions())
+#ifndef GEOMETRY_HAS_BIO
+    UTILITY_FUNCTION_ERROR("Zstd support is available only when compiled with Boost.IOStreams.")
+#endif
+    ;
+
 void saveAsPly( const Mesh::pointer &mesh
               , const boost::filesystem::path &filepath);
 
@@ -431,6 +672,17 @@ void saveAsPly( const Mesh &mesh
 
 Mesh loadPly( const boost::filesystem::path &filepath );
 
+/** Memory-mapped loader for binary-little-endian PLY files: the header
+ *  is parsed through a stream, element data is bulk-mapped and
+ *  stride-copied straight into Mesh storage. loadPly() dispatches here
+ *  automatically; calling it directly skips the format sniffing.
+ */
+Mesh loadBinaryPly(const boost::filesystem::path &filepath)
+#ifndef GEOMETRY_HAS_BIO
+    UTILITY_FUNCTION_ERROR("Memory-mapped PLY loading is available only when compiled with Boost.IOStreams.")
+#endif
+    ;
+
 // parses PLY from a file, throws on any error
 void loadPly(ObjParserBase &parser, const boost::filesystem::path &path);
 
@@ -457,6 +709,12 @@ bool objHasVertexOrFace(const boost::filesystem::path &path);
  */
 Mesh::list splitById(const Mesh &mesh);
 
+/** Splits mesh by image identifier into lightweight views sharing the
+ *  parent's vertex buffer: only face lists are built, no vertices are
+ *  copied and the views can be processed concurrently. See MeshView.
+ */
+MeshView::list splitById(const std::shared_ptr<const Mesh> &mesh);
+
 // inline stuff
 
 inline Mesh::pointer simplify(const Mesh::pointer &mesh, int faceCount
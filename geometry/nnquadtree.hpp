@@ -33,14 +33,21 @@
 #ifndef geometry_nnquadtree_hpp_included_
 #define geometry_nnquadtree_hpp_included_
 
+#include <algorithm>
 #include <limits>
 #include <cmath>
+#include <vector>
 
 namespace geometry {
 
 /** NNQuadTree -- quadtree that stores 2D points and provides nearest
- *  neighbor search. Points are first inserted into the tree (one by one),
- *  then nearest neighbor queries can be issued.
+ *  neighbor search. Points are either inserted into the tree (one by one)
+ *  or passed as a whole span to the bulk-build constructor; afterwards
+ *  nearest neighbor queries can be issued.
+ *
+ *  Nodes live in a contiguous pool (indices instead of pointers, the four
+ *  children of a node are allocated next to each other), so both building
+ *  and traversal stay cache friendly and no per-split allocation happens.
  *
  *  PointType -- must define operator() for coordinate access (e.g.,
  *               math::Point2f)
@@ -57,15 +64,42 @@ public:
      *  tree.
      */
     NNQuadTree(const PointType &min, const PointType &max)
-        : root_(new Node), min_(min), max_(max)
-    {}
+        : min_(min), max_(max)
+    {
+        nodes_.emplace_back();
+    }
+
+    /** Bulk-build constructor: builds the tree from the whole point span
+     *  at once by recursive quadrant partitioning -- no incremental leaf
+     *  splits and re-inserts. The resulting tree is identical in shape to
+     *  one built by insert() (the shape depends only on point positions);
+     *  the id of each point is its index in the span, cast to IdType.
+     *
+     *  As with insert(), more than NodeSize coincident points are not
+     *  supported.
+     */
+    template <typename PointIter>
+    NNQuadTree(PointIter first, PointIter last,
+               const PointType &min, const PointType &max)
+        : min_(min), max_(max)
+    {
+        std::vector<Entry> entries;
+        entries.reserve(std::distance(first, last));
+        IdType id = IdType();
+        for (auto it = first; it != last; ++it, ++id) {
+            entries.push_back({ *it, id });
+        }
+
+        nodes_.reserve(2 * entries.size() / NodeSize + 1);
+        build(entries, 0, int(entries.size()), min_, max_);
+    }
 
     /** Insert a point into the tree. For future reference, an ID of the point
      *  needs to also be passed.
      */
     void insert(const PointType &point, IdType id)
     {
-        root_->insert(point, id, min_, max_);
+        insertImpl(0, point, id, min_, max_);
     }
 
     /** Find the nearest point to 'query' and return its ID. If the tree is
@@ -76,7 +110,7 @@ public:
     {
         IdType minId = invalidId;
         double minDist = std::numeric_limits<double>::max();
-        root_->nearest(query, min_, max_, minDist, minId);
+        nearestImpl(0, query, min_, max_, minDist, minId);
         return minId;
     }
 
@@ -87,47 +121,78 @@ public:
     {
         IdType minId = IdType();
         double minDist = std::numeric_limits<double>::max();
-        root_->nearest(query, min_, max_, minDist, minId);
+        nearestImpl(0, query, min_, max_, minDist, minId);
         return minDist;
     }
 
-    ~NNQuadTree() { delete root_; }
+    /** Find (up to) k nearest points to 'query'; returns their IDs ordered
+     *  by increasing distance. Uses a bounded max-heap of size k, so the
+     *  cost is one traversal with pruning against the current k-th
+     *  distance.
+     */
+    std::vector<IdType> nearest(const PointType &query, std::size_t k) const
+    {
+        std::vector<HeapEntry> heap;
+        if (k) {
+            heap.reserve(k);
+            knnImpl(0, query, min_, max_, k, heap);
+        }
+
+        std::sort_heap(heap.begin(), heap.end());
+
+        std::vector<IdType> ids;
+        ids.reserve(heap.size());
+        for (const auto &entry : heap) { ids.push_back(entry.id); }
+        return ids;
+    }
 
 protected:
 
     struct Node
     {
-        union {
-            Node* ch[4];
-            struct {
-                PointType pt[NodeSize];
-                IdType id[NodeSize];
-            } data;
-        };
+        int ch[4]; // indices of children (internal nodes only)
+        PointType pt[NodeSize];
+        IdType id[NodeSize];
         int size; // >= 0 if leaf, < 0 if internal node
 
         Node() : size(0) {}
+    };
 
-        void insert(const PointType &point, IdType id,
-                    const PointType &min, const PointType &max);
+    struct Entry { PointType pt; IdType id; };
 
-        void nearest(const PointType &query,
-                     const PointType &min, const PointType &max,
-                     double &minDist, IdType &minId);
+    struct HeapEntry
+    {
+        double dist2;
+        IdType id;
 
-        ~Node() {
-            if (size < 0) {
-                for (int i = 0; i < 4; i++) {
-                    delete ch[i];
-                }
-            }
+        bool operator< (const HeapEntry &other) const {
+            return dist2 < other.dist2;
         }
     };
 
-    Node* root_;
+    std::vector<Node> nodes_; // node pool; root is nodes_[0]
     PointType min_, max_; // root extents
 
-    // TODO: a fast allocator for Nodes
+    int allocNode()
+    {
+        nodes_.emplace_back();
+        return int(nodes_.size()) - 1;
+    }
+
+    int build(std::vector<Entry> &entries, int lo, int hi,
+              const PointType &min, const PointType &max);
+
+    void insertImpl(int node, const PointType &point, IdType id,
+                    const PointType &min, const PointType &max);
+
+    void nearestImpl(int node, const PointType &query,
+                     const PointType &min, const PointType &max,
+                     double &minDist, IdType &minId) const;
+
+    void knnImpl(int node, const PointType &query,
+                 const PointType &min, const PointType &max,
+                 std::size_t k, std::vector<HeapEntry> &heap) const;
+
     // TODO: user shouldn't need to specify initial bounding box
     // TODO: store bounding box in slack space of branch nodes?
 };
@@ -136,11 +201,65 @@ protected:
 // implementation
 
 template<typename PointType, typename IdType, int NodeSize>
-void NNQuadTree<PointType, IdType, NodeSize>::Node::insert(
-        const PointType &point, IdType id,
+int NNQuadTree<PointType, IdType, NodeSize>::build(
+        std::vector<Entry> &entries, int lo, int hi,
+        const PointType &min, const PointType &max)
+{
+    int node = allocNode();
+
+    if (hi - lo <= NodeSize) // leaf
+    {
+        Node &n(nodes_[node]);
+        for (int i = lo; i < hi; i++) {
+            n.pt[i - lo] = entries[i].pt;
+            n.id[i - lo] = entries[i].id;
+        }
+        n.size = hi - lo;
+        return node;
+    }
+
+    double x1 = (min(0) + max(0))*0.5;
+    double y1 = (min(1) + max(1))*0.5;
+
+    // partition the span into the four quadrants (same numbering as
+    // insertImpl below)
+    auto first(entries.begin());
+    int mx = int(std::partition(first + lo, first + hi,
+                    [&](const Entry &e) { return e.pt(0) < x1; })
+                 - first);
+    int m0 = int(std::partition(first + lo, first + mx,
+                    [&](const Entry &e) { return e.pt(1) < y1; })
+                 - first);
+    int m1 = int(std::partition(first + mx, first + hi,
+                    [&](const Entry &e) { return e.pt(1) < y1; })
+                 - first);
+
+    nodes_[node].size = -1;
+
+    // build children; re-fetch the node after each call, the pool may
+    // have reallocated
+    int ch0 = build(entries, lo, m0, min, PointType(x1, y1));
+    int ch1 = build(entries, mx, m1,
+                    PointType(x1, min(1)), PointType(max(0), y1));
+    int ch2 = build(entries, m0, mx,
+                    PointType(min(0), y1), PointType(x1, max(1)));
+    int ch3 = build(entries, m1, hi, PointType(x1, y1), max);
+
+    Node &n(nodes_[node]);
+    n.ch[0] = ch0;
+    n.ch[1] = ch1;
+    n.ch[2] = ch2;
+    n.ch[3] = ch3;
+    return node;
+}
+
+
+template<typename PointType, typename IdType, int NodeSize>
+void NNQuadTree<PointType, IdType, NodeSize>::insertImpl(
+        int node, const PointType &point, IdType id,
         const PointType &min, const PointType &max)
 {
-    if (size < 0) // branch node
+    if (nodes_[node].size < 0) // branch node
     {
         double x0 = min(0), x2 = max(0), x1 = (x0 + x2)*0.5;
         double y0 = min(1), y2 = max(1), y1 = (y0 + y2)*0.5;
@@ -158,26 +277,31 @@ void NNQuadTree<PointType, IdType, NodeSize>::Node::insert(
 
         if (point(0) < x1) {
             if (point(1) < y1) {
-                ch[0]->insert(point, id, min, PointType(x1, y1));
+                insertImpl(nodes_[node].ch[0], point, id,
+                           min, PointType(x1, y1));
             }
             else {
-                ch[2]->insert(point, id, PointType(x0, y1), PointType(x1, y2));
+                insertImpl(nodes_[node].ch[2], point, id,
+                           PointType(x0, y1), PointType(x1, y2));
             }
         }
         else {
             if (point(1) < y1) {
-                ch[1]->insert(point, id, PointType(x1, y0), PointType(x2, y1));
+                insertImpl(nodes_[node].ch[1], point, id,
+                           PointType(x1, y0), PointType(x2, y1));
             }
             else {
-                ch[3]->insert(point, id, PointType(x1, y1), max);
+                insertImpl(nodes_[node].ch[3], point, id,
+                           PointType(x1, y1), max);
             }
         }
     }
-    else if (size < NodeSize) // leaf, not full
+    else if (nodes_[node].size < NodeSize) // leaf, not full
     {
-        data.pt[size] = point;
-        data.id[size] = id;
-        size++;
+        Node &n(nodes_[node]);
+        n.pt[n.size] = point;
+        n.id[n.size] = id;
+        n.size++;
     }
     else // full leaf, we need to split it
     {
@@ -186,32 +310,34 @@ void NNQuadTree<PointType, IdType, NodeSize>::Node::insert(
 
         // back up node content
         for (int i = 0; i < NodeSize; i++) {
-            tmp_pt[i] = data.pt[i];
-            tmp_id[i] = data.id[i];
+            tmp_pt[i] = nodes_[node].pt[i];
+            tmp_id[i] = nodes_[node].id[i];
         }
 
-        // turn this leaf into an internal node, create new empty children
-        size = -1;
+        // turn this leaf into an internal node, allocate four fresh
+        // children next to each other in the pool
+        nodes_[node].size = -1;
         for (int i = 0; i < 4; i++) {
-            ch[i] = new Node;
+            int child = allocNode();
+            nodes_[node].ch[i] = child;
         }
 
         // reinsert old points
         for (int i = 0; i < NodeSize; i++) {
-            insert(tmp_pt[i], tmp_id[i], min, max);
+            insertImpl(node, tmp_pt[i], tmp_id[i], min, max);
         }
 
         // finally, insert the new one
-        insert(point, id, min, max);
+        insertImpl(node, point, id, min, max);
     }
 }
 
 
 template<typename PointType, typename IdType, int NodeSize>
-void NNQuadTree<PointType, IdType, NodeSize>::Node::nearest(
-        const PointType &query,
+void NNQuadTree<PointType, IdType, NodeSize>::nearestImpl(
+        int node, const PointType &query,
         const PointType &min, const PointType &max,
-        double &minDist, IdType &minId)
+        double &minDist, IdType &minId) const
 {
     // quickly reject subtrees that cannot contain a closer point
     if (min(0) - query(0) > minDist ||
@@ -222,7 +348,9 @@ void NNQuadTree<PointType, IdType, NodeSize>::Node::nearest(
         return;
     }
 
-    if (size < 0) // branch node, recurse to subtrees (closest first)
+    const Node &n(nodes_[node]);
+
+    if (n.size < 0) // branch node, recurse to subtrees (closest first)
     {
         double x[3] = { min(0), (min(0) + max(0))*0.5, max(0) };
         double y[3] = { min(1), (min(1) + max(1))*0.5, max(1) };
@@ -238,22 +366,87 @@ void NNQuadTree<PointType, IdType, NodeSize>::Node::nearest(
         for (int i = 0; i < 4; i++)
         {
             int q = order[i];
-            ch[q]->nearest(query,
-                           PointType(x[q & 1], y[q >> 1]),
-                           PointType(x[(q & 1) + 1], y[(q >> 1) + 1]),
-                           minDist, minId);
+            nearestImpl(n.ch[q], query,
+                        PointType(x[q & 1], y[q >> 1]),
+                        PointType(x[(q & 1) + 1], y[(q >> 1) + 1]),
+                        minDist, minId);
         }
     }
     else // leaf node
     {
-        for (int i = 0; i < size; i++)
+        for (int i = 0; i < n.size; i++)
         {
-            double d2 = math::sqr(data.pt[i](0) - query(0)) +
-                        math::sqr(data.pt[i](1) - query(1));
+            double d2 = math::sqr(n.pt[i](0) - query(0)) +
+                        math::sqr(n.pt[i](1) - query(1));
 
             if (d2 < math::sqr(minDist)) {
                 minDist = std::sqrt(d2);
-                minId = data.id[i];
+                minId = n.id[i];
+            }
+        }
+    }
+}
+
+
+template<typename PointType, typename IdType, int NodeSize>
+void NNQuadTree<PointType, IdType, NodeSize>::knnImpl(
+        int node, const PointType &query,
+        const PointType &min, const PointType &max,
+        std::size_t k, std::vector<HeapEntry> &heap) const
+{
+    // prune against the current k-th nearest distance once the heap is
+    // full
+    if (heap.size() == k)
+    {
+        double worst = std::sqrt(heap.front().dist2);
+        if (min(0) - query(0) > worst ||
+            min(1) - query(1) > worst ||
+            query(0) - max(0) > worst ||
+            query(1) - max(1) > worst)
+        {
+            return;
+        }
+    }
+
+    const Node &n(nodes_[node]);
+
+    if (n.size < 0) // branch node, recurse to subtrees (closest first)
+    {
+        double x[3] = { min(0), (min(0) + max(0))*0.5, max(0) };
+        double y[3] = { min(1), (min(1) + max(1))*0.5, max(1) };
+
+        int qx = (query(0) < x[1]) ? 0 : 1;
+        int qy = (query(1) < y[1]) ? 0 : 1;
+
+        int order[4] = { 2*qy + qx,
+                         2*qy + (1-qx),
+                         2*(1-qy) + qx,
+                         2*(1-qy) + (1-qx) };
+
+        for (int i = 0; i < 4; i++)
+        {
+            int q = order[i];
+            knnImpl(n.ch[q], query,
+                    PointType(x[q & 1], y[q >> 1]),
+                    PointType(x[(q & 1) + 1], y[(q >> 1) + 1]),
+                    k, heap);
+        }
+    }
+    else // leaf node
+    {
+        for (int i = 0; i < n.size; i++)
+        {
+            double d2 = math::sqr(n.pt[i](0) - query(0)) +
+                        math::sqr(n.pt[i](1) - query(1));
+
+            if (heap.size() < k) {
+                heap.push_back({ d2, n.id[i] });
+                std::push_heap(heap.begin(), heap.end());
+            }
+            else if (d2 < heap.front().dist2) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = { d2, n.id[i] };
+                std::push_heap(heap.begin(), heap.end());
             }
         }
     }
@@ -34,9 +34,12 @@
 #  include <boost/geometry/geometries/multi_polygon.hpp>
 #endif
 
+#include <algorithm>
+
 #include "dbglog/dbglog.hpp"
 
 #include "nonconvexclip.hpp"
+#include "polygon.hpp"
 #include "triangulate.hpp"
 
 namespace bg = boost::geometry;
@@ -83,11 +86,164 @@ inline double area(const math::Triangle2d &t) {
                                             , math::Point2(t[2] - t[0])));
 }
 
+/** Lifts a 2D triangle of the clipped result back to 3D using
+ *  barycentric interpolation of the original triangle's heights.
+ */
+inline math::Triangle3d liftTriangle(const math::Triangle2d &t2
+                                     , const math::Triangle3d &tri
+                                     , const math::Triangle2d &tri2
+                                     , bool flip)
+{
+    math::Triangle3d t3;
+    for (int i = 0; i < 3; i++)
+    {
+        math::Point3 l(math::barycentricCoords(t2[i], tri2));
+        t3[i](0) = t2[i](0);
+        t3[i](1) = t2[i](1);
+        t3[i](2) = l(0)*tri[0](2) +
+                   l(1)*tri[1](2) +
+                   l(2)*tri[2](2);
+    }
+    if (flip) {
+        std::swap(t3[1], t3[2]);
+    }
+    return t3;
+}
+
+// capacity of the fixed rings of the convex fast path; a triangle
+// clipped by a convex polygon with m edges has at most m + 3 vertices
+const int ringCapacity(32);
+
+/** Fast path applies when the clip region is a single convex polygon
+ *  small enough for the fixed rings; outputs it as a CCW ring.
+ */
+bool convexClipRing(const math::MultiPolygon &clipRegion
+                    , math::Points2d &ring)
+{
+    if (clipRegion.size() != 1) { return false; }
+
+    const auto &poly(clipRegion.front());
+    if ((int(poly.size()) > (ringCapacity - 3)) || !convex(poly)) {
+        return false;
+    }
+
+    ring = poly;
+    if (geometry::area(ring) < 0.) {
+        std::reverse(ring.begin(), ring.end());
+    }
+    return true;
+}
+
+/** Clips a convex polygon by the halfplane left of edge a->b. Both
+ *  buffers have ringCapacity elements; output grows by at most one
+ *  vertex, which the caller's upfront size check accounts for.
+ */
+inline int clipEdge(const math::Point2d *in, int size, math::Point2d *out
+                    , const math::Point2d &a, const math::Point2d &b)
+{
+    const double ex(b(0) - a(0)), ey(b(1) - a(1));
+    const auto side([&](const math::Point2d &p) {
+        return ex * (p(1) - a(1)) - ey * (p(0) - a(0));
+    });
+
+    int count(0);
+
+    const auto *prev(&in[size - 1]);
+    double prevSide(side(*prev));
+
+    for (int i(0); i < size; ++i) {
+        const auto &p(in[i]);
+        const double pSide(side(p));
+
+        if ((pSide < 0.) != (prevSide < 0.)) {
+            // edge crosses the halfplane boundary -> add intersection
+            const double t(prevSide / (prevSide - pSide));
+            out[count++] = math::Point2d
+                ((*prev)(0) + t * (p(0) - (*prev)(0))
+                 , (*prev)(1) + t * (p(1) - (*prev)(1)));
+        }
+
+        if (pSide >= 0.) { out[count++] = p; }
+
+        prev = &p;
+        prevSide = pSide;
+    }
+
+    return count;
+}
+
+/** Sutherland-Hodgman clip of one triangle by a convex CCW ring; the
+ *  fan-triangulated result is appended to tris3. No heap allocation
+ *  happens outside the output vector.
+ */
+void clipTriangleConvexRing(const math::Triangle3d &tri_
+                            , const math::Points2d &ring
+                            , math::Triangles3d &tris3)
+{
+    math::Triangle3d tri(tri_);
+
+    // tri -> tri2
+    math::Triangle2d tri2;
+    for (int i = 0; i < 3; i++) {
+        tri2[i](0) = tri[i](0);
+        tri2[i](1) = tri[i](1);
+    }
+
+    bool flip = false;
+    double ccw(checkCcw(tri2[0], tri2[1], tri2[2]));
+
+    if (std::abs(ccw) < 1e-4) {
+        return; // TODO: handle exactly vertical triangles
+    }
+
+    // ensure counter-clockwise orientation for clipping
+    if (ccw < 0.0) {
+        std::swap(tri[1], tri[2]);
+        std::swap(tri2[1], tri2[2]);
+        flip = true;
+    }
+
+    // ping-pong the polygon between two fixed rings, one clip region
+    // edge at a time
+    math::Point2d ring0[ringCapacity], ring1[ringCapacity];
+    for (int i = 0; i < 3; i++) { ring0[i] = tri2[i]; }
+
+    math::Point2d *cur(ring0);
+    math::Point2d *next(ring1);
+    int size(3);
+
+    for (std::size_t e(0); e < ring.size(); ++e) {
+        size = clipEdge(cur, size, next
+                        , ring[e], ring[(e + 1) % ring.size()]);
+        if (!size) { return; }
+        std::swap(cur, next);
+    }
+
+    // the intersection is convex -> fan triangulation
+    for (int i = 1; (i + 1) < size; ++i) {
+        math::Triangle2d t2;
+        t2[0] = cur[0];
+        t2[1] = cur[i];
+        t2[2] = cur[i + 1];
+        tris3.push_back(liftTriangle(t2, tri, tri2, flip));
+    }
+}
+
 } // namespace
 
 math::Triangles3d clipTriangleNonconvex(const math::Triangle3d &tri_,
                                         const math::MultiPolygon &clipRegion)
 {
+    {
+        // convex clip regions take the allocation-free path
+        math::Points2d ring;
+        if (convexClipRing(clipRegion, ring)) {
+            math::Triangles3d tris3;
+            clipTriangleConvexRing(tri_, ring, tris3);
+            return tris3;
+        }
+    }
+
     math::Triangle3d tri(tri_);
 
     // tri -> tri2
@@ -157,25 +313,31 @@ math::Triangles3d clipTriangleNonconvex(const math::Triangle3d &tri_,
     tris3.reserve(tris2.size());
     for (const auto &t2 : tris2)
     {
-        math::Triangle3d t3;
-        for (int i = 0; i < 3; i++)
-        {
-            math::Point3 l(math::barycentricCoords(t2[i], tri2));
-            t3[i](0) = t2[i](0);
-            t3[i](1) = t2[i](1);
-            t3[i](2) = l(0)*tri[0](2) +
-                       l(1)*tri[1](2) +
-                       l(2)*tri[2](2);
-        }
-        if (flip) {
-            std::swap(t3[1], t3[2]);
-        }
-        tris3.push_back(t3);
+        tris3.push_back(liftTriangle(t2, tri, tri2, flip));
     }
 
     return tris3;
 }
 
+void clipTrianglesNonconvex(const math::Triangles3d &tris,
+                            const math::MultiPolygon &clipRegion,
+                            math::Triangles3d &out)
+{
+    // analyze the clip region once for the whole batch
+    math::Points2d ring;
+    if (convexClipRing(clipRegion, ring)) {
+        for (const auto &tri : tris) {
+            clipTriangleConvexRing(tri, ring, out);
+        }
+        return;
+    }
+
+    for (const auto &tri : tris) {
+        auto res(clipTriangleNonconvex(tri, clipRegion));
+        out.insert(out.end(), res.begin(), res.end());
+    }
+}
+
 
 math::Point3 barycentric3D(const math::Point3 &p, const math::Point3 &a,
                            const math::Point3 &b, const math::Point3 &c)
@@ -46,6 +46,15 @@ namespace geometry {
 math::Triangles3d clipTriangleNonconvex(const math::Triangle3d &tri,
                                         const math::MultiPolygon &clipRegion);
 
+/** Clips a batch of triangles by the same region, appending the results
+ *  of all of them to a shared output vector. The clip region is analyzed
+ *  once per batch; a convex region is clipped without heap allocation
+ *  outside the output vector.
+ */
+void clipTrianglesNonconvex(const math::Triangles3d &tris,
+                            const math::MultiPolygon &clipRegion,
+                            math::Triangles3d &out);
+
 /** Similar to clipTriangleNonconvex, but handles texture coordinates as well.
  */
 std::tuple<math::Triangles3d, math::Triangles2d>
@@ -27,20 +27,29 @@
  *  @file geometry/parse-obj.cpp
  *  @author Vaclav Blazek <vaclav.blazek@citationtech.net>
  *
- *  Boost.Spirit-based OBJ file format parser.
+ *  OBJ file format parser.
  */
 
 #include <cstdio>
 
 #include "utility/expect.hpp"
 
-#include "detail/parse-obj.hpp"
+#include "detail/parse-obj-fast.hpp"
 
 namespace geometry {
 
 bool ObjParserBase::parse(std::istream &is)
 {
-    return detail::parse(is, *this);
+    // the block scanner drives the stream via read()/gcount(); run it with
+    // exceptions masked so an EOF on the last block is not fatal
+    const auto exceptions(is.exceptions());
+    is.exceptions(std::ios::goodbit);
+
+    const auto res(detail::parseFast(is, *this));
+
+    is.clear();
+    is.exceptions(exceptions);
+    return res;
 }
 
 bool ObjParserBase::parse(const boost::filesystem::path &path)
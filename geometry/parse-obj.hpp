@@ -72,6 +72,27 @@ public:
     virtual void addNormal(const Vector3d&) = 0;
     virtual void addFacet(const Facet&) = 0;
 
+    /** Batched variants used by the high-throughput parsing path. Default
+     *  implementations forward element by element, so existing sinks keep
+     *  working; hot sinks can override them to ingest whole blocks with a
+     *  single virtual call.
+     */
+    virtual void addVertices(const std::vector<Vector3d> &vertices) {
+        for (const auto &v : vertices) { addVertex(v); }
+    }
+
+    virtual void addTextures(const std::vector<Vector3d> &textures) {
+        for (const auto &t : textures) { addTexture(t); }
+    }
+
+    virtual void addNormals(const std::vector<Vector3d> &normals) {
+        for (const auto &n : normals) { addNormal(n); }
+    }
+
+    virtual void addFacets(const Facet::list &facets) {
+        for (const auto &f : facets) { addFacet(f); }
+    }
+
     virtual void materialLibrary(const std::string&) = 0;
 
     virtual void useMaterial(const std::string&) = 0;
@@ -0,0 +1,232 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * Memory-mapped loader for binary-little-endian PLY files; the fast
+ * path behind loadPly(). The header is parsed through a stream, element
+ * data is then bulk-mapped and stride-copied straight into Mesh
+ * storage.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+#include "error.hpp"
+#include "meshop.hpp"
+#include "detail/ply.hpp"
+
+namespace bio = boost::iostreams;
+
+namespace geometry {
+
+namespace {
+
+typedef detail::PlyProperty::Type Type;
+
+/** Reads one little-endian scalar of given type as double. */
+double readScalar(const char *data, Type type)
+{
+    switch (type) {
+    case Type::int8: {
+        std::int8_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return double(value);
+    }
+    case Type::uint8: {
+        std::uint8_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return double(value);
+    }
+    case Type::int16: {
+        std::int16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return double(value);
+    }
+    case Type::uint16: {
+        std::uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return double(value);
+    }
+    case Type::int32: {
+        std::int32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return double(value);
+    }
+    case Type::uint32: {
+        std::uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return double(value);
+    }
+    case Type::float32: {
+        float value;
+        std::memcpy(&value, data, sizeof(value));
+        return double(value);
+    }
+    case Type::float64: {
+        double value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    }
+    return 0.0;
+}
+
+std::size_t readIndex(const char *data, Type type)
+{
+    return std::size_t(readScalar(data, type));
+}
+
+} // namespace
+
+Mesh loadBinaryPly(const boost::filesystem::path &path)
+{
+    detail::PlyHeader header;
+    {
+        std::ifstream f(path.string(), std::ios::binary);
+        if (!f.good()) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Can't open PLY file " << path << ".";
+        }
+        header = detail::parsePlyHeader(f, path);
+    }
+
+    if (header.format != detail::PlyHeader::Format::binaryLittleEndian) {
+        LOGTHROW(err2, BadFileFormat)
+            << "File " << path << " is not a binary-little-endian PLY.";
+    }
+
+    const auto *vertexElement(header.element("vertex"));
+    const auto *faceElement(header.element("face"));
+    if (!vertexElement || !faceElement) {
+        LOGTHROW(err2, BadFileFormat)
+            << "Unknown PLY format in file " << path << ".";
+    }
+
+    // vertices must come first and be fixed-size records so the face
+    // block can be located without walking them
+    if ((&header.elements.front() != vertexElement)
+        || !vertexElement->fixedSize())
+    {
+        LOGTHROW(err2, BadFileFormat)
+            << "File " << path << " has unsupported PLY vertex layout.";
+    }
+
+    const auto xOffset(vertexElement->propertyOffset("x"));
+    const auto yOffset(vertexElement->propertyOffset("y"));
+    const auto zOffset(vertexElement->propertyOffset("z"));
+    if ((xOffset < 0) || (yOffset < 0) || (zOffset < 0)) {
+        LOGTHROW(err2, BadFileFormat)
+            << "File " << path << " has no x/y/z vertex properties.";
+    }
+    const auto xType(vertexElement->property("x")->type);
+    const auto yType(vertexElement->property("y")->type);
+    const auto zType(vertexElement->property("z")->type);
+
+    // faces: the vertex index list must be the first property; any
+    // fixed-size properties behind it are skipped
+    const auto &faceProperties(faceElement->properties);
+    if (faceProperties.empty() || !faceProperties.front().list) {
+        LOGTHROW(err2, BadFileFormat)
+            << "File " << path << " has unsupported PLY face layout.";
+    }
+    const auto &indexList(faceProperties.front());
+    std::size_t faceExtraSize(0);
+    for (std::size_t i(1); i < faceProperties.size(); ++i) {
+        if (faceProperties[i].list) {
+            LOGTHROW(err2, BadFileFormat)
+                << "File " << path << " has unsupported PLY face layout.";
+        }
+        faceExtraSize
+            += detail::PlyProperty::typeSize(faceProperties[i].type);
+    }
+
+    bio::mapped_file_source file(path.string());
+    if (!file.is_open()) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Cannot map PLY file " << path << ".";
+    }
+
+    const char *data(file.data());
+    const char *end(data + file.size());
+    const char *cursor(data + header.size);
+
+    Mesh mesh;
+
+    // stride-copy vertices
+    const auto vertexSize(vertexElement->recordSize());
+    if (cursor + vertexSize * vertexElement->count > end) {
+        LOGTHROW(err2, BadFileFormat)
+            << "File " << path << " is truncated.";
+    }
+
+    mesh.vertices.reserve(vertexElement->count);
+    for (std::size_t i(0); i < vertexElement->count; ++i) {
+        mesh.vertices.emplace_back(readScalar(cursor + xOffset, xType)
+                                   , readScalar(cursor + yOffset, yType)
+                                   , readScalar(cursor + zOffset, zType));
+        cursor += vertexSize;
+    }
+
+    // walk variable-size face records
+    const auto countSize(detail::PlyProperty::typeSize
+                         (indexList.countType));
+    const auto indexSize(detail::PlyProperty::typeSize(indexList.type));
+
+    mesh.faces.reserve(faceElement->count);
+    for (std::size_t i(0); i < faceElement->count; ++i) {
+        if (cursor + countSize > end) {
+            LOGTHROW(err2, BadFileFormat)
+                << "File " << path << " is truncated.";
+        }
+        const auto n(readIndex(cursor, indexList.countType));
+        cursor += countSize;
+
+        if (n != 3) {
+            LOGTHROW(err2, BadFileFormat)
+                << "Only triangles are supported in PLY files ("
+                << path << ").";
+        }
+        if (cursor + 3 * indexSize + faceExtraSize > end) {
+            LOGTHROW(err2, BadFileFormat)
+                << "File " << path << " is truncated.";
+        }
+
+        const auto a(readIndex(cursor, indexList.type));
+        const auto b(readIndex(cursor + indexSize, indexList.type));
+        const auto c(readIndex(cursor + 2 * indexSize, indexList.type));
+        cursor += 3 * indexSize + faceExtraSize;
+
+        mesh.faces.emplace_back(a, b, c);
+    }
+
+    return mesh;
+}
+
+} // namespace geometry
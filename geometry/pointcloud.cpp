@@ -29,13 +29,51 @@
 
 #include <dbglog/dbglog.hpp>
 #include <boost/foreach.hpp>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 
+#include "utility/binaryio.hpp"
+
+namespace bin = utility::binaryio;
+
 namespace geometry {
 
+namespace {
+
+/** Binary snapshot layout, all offsets from file start:
+ *
+ *      0  char[8]   magic
+ *      8  uint32    version (1)
+ *     12  uint32    points per chunk
+ *     16  uint64    point count
+ *     24  chunks: double[3 * n] coordinates, back to back
+ *      .  footer: double[6] extents (ll, ur) per chunk, then the
+ *         overall extents
+ *
+ * Per-chunk extents allow a future reader to skip chunks spatially;
+ * the overall extents restore the cloud state without touching points.
+ */
+const char BINARY_MAGIC[8] = {'P', 'C', 'L', 'O', 'U', 'D', '.', 'B'};
+const unsigned BINARY_VERSION = 1;
+
+void writeExtents( std::ostream & f, const math::Extents3 & e ) {
+    for ( int i = 0; i < 3; i++ ) bin::write( f, double( e.ll( i ) ) );
+    for ( int i = 0; i < 3; i++ ) bin::write( f, double( e.ur( i ) ) );
+}
+
+void readExtents( std::istream & f, math::Extents3 & e ) {
+    for ( int i = 0; i < 3; i++ ) bin::read( f, e.ll( i ) );
+    for ( int i = 0; i < 3; i++ ) bin::read( f, e.ur( i ) );
+}
+
+} // namespace
+
 
 void PointCloud::push_back( const math::Point3 & x ) {
 
+    materialize();
+
     updateExtents( x );
     std::vector<math::Point3>::push_back( x );
 }
@@ -43,6 +81,8 @@ void PointCloud::push_back( const math::Point3 & x ) {
 PointCloud::iterator PointCloud::insert( iterator position,
     const math::Point3 & x ) {
 
+    materialize();
+
     updateExtents( x );
     return std::vector<math::Point3>::insert( position, x );
 }
@@ -50,16 +90,72 @@ PointCloud::iterator PointCloud::insert( iterator position,
 void PointCloud::insert( iterator position, size_type n,
     const math::Point3 & x ) {
 
+    materialize();
+
     updateExtents( x );
     std::vector<math::Point3>::insert( position, n, x );
 }
 
 void PointCloud::clear() {
     extents_ = math::Extents3();
+    transformPending_ = false;
+}
+
+void PointCloud::transformLazy( const math::Matrix4 & trafo ) {
+
+    pendingTrafo_ = transformPending_
+        ? math::Matrix4( prod( trafo, pendingTrafo_ ) )
+        : trafo;
+    transformPending_ = true;
+
+    if ( empty() ) return;
+
+    // keep extents usable without touching the points: bound the
+    // transformed cloud by the transformed extents box corners
+    // (conservative, exact again after materialize())
+    const math::Extents3 old( extents_ );
+
+    for ( int i = 0; i < 8; i++ ) {
+
+        math::Point3 corner(
+            ( i & 1 ) ? old.ur(0) : old.ll(0),
+            ( i & 2 ) ? old.ur(1) : old.ll(1),
+            ( i & 4 ) ? old.ur(2) : old.ll(2) );
+
+        corner = math::euclidian(
+            prod( trafo, math::homogeneous( corner ) ) );
+
+        if ( i == 0 )
+            extents_ = math::Extents3( corner, corner );
+        else
+            update( extents_, corner );
+    }
+}
+
+void PointCloud::materialize() {
+
+    if ( !transformPending_ ) return;
+
+    const math::Matrix4 trafo( pendingTrafo_ );
+    transformPending_ = false;
+
+    if ( empty() ) return;
+
+    // apply the fused transform and rebuild exact extents in one pass
+    iterator it = begin();
+    *it = math::euclidian( prod( trafo, math::homogeneous( *it ) ) );
+    extents_ = math::Extents3( *it, *it );
+
+    for ( ++it; it != end(); ++it ) {
+        *it = math::euclidian( prod( trafo, math::homogeneous( *it ) ) );
+        update( extents_, *it );
+    }
 }
 
 void PointCloud::dump( const std::string & path ) {
 
+    materialize();
+
     std::fstream f;
 
     f.exceptions( std::ios::badbit | std::ios::failbit );
@@ -81,6 +177,71 @@ void PointCloud::dump( const std::string & path ) {
 }
 
 
+void PointCloud::dumpBinary( const std::string & path,
+                             std::size_t pointsPerChunk ) {
+
+    materialize();
+
+    if ( !pointsPerChunk ) pointsPerChunk = 1 << 20;
+
+    std::ofstream f;
+    f.exceptions( std::ios::badbit | std::ios::failbit );
+
+    try {
+
+        f.open( path, std::ios_base::out | std::ios_base::trunc
+                | std::ios_base::binary );
+
+        bin::write( f, BINARY_MAGIC );
+        bin::write( f, std::uint32_t( BINARY_VERSION ) );
+        bin::write( f, std::uint32_t( pointsPerChunk ) );
+        bin::write( f, std::uint64_t( size() ) );
+
+        const std::size_t chunks(
+            size() ? ( size() + pointsPerChunk - 1 ) / pointsPerChunk
+                   : 0 );
+
+        std::vector<math::Extents3> chunkExtents;
+        chunkExtents.reserve( chunks );
+
+        std::vector<double> buffer;
+        buffer.reserve( 3 * std::min( pointsPerChunk, size() ) );
+
+        for ( std::size_t c = 0; c < chunks; c++ ) {
+
+            const std::size_t begin( c * pointsPerChunk );
+            const std::size_t count(
+                std::min( pointsPerChunk, size() - begin ) );
+
+            buffer.clear();
+
+            math::Extents3 ce( at( begin ), at( begin ) );
+            for ( std::size_t i = begin; i < begin + count; i++ ) {
+
+                const math::Point3 & p( at( i ) );
+                buffer.push_back( p( 0 ) );
+                buffer.push_back( p( 1 ) );
+                buffer.push_back( p( 2 ) );
+                update( ce, p );
+            }
+            chunkExtents.push_back( ce );
+
+            f.write( reinterpret_cast<const char *>( buffer.data() ),
+                     std::streamsize( buffer.size() * sizeof( double ) ) );
+        }
+
+        for ( const auto & ce : chunkExtents ) writeExtents( f, ce );
+        writeExtents( f, extents_ );
+
+    } catch ( std::ios_base::failure & e ) {
+
+        LOG( err2 ) << "Failed to write to '" << path
+                    << "', error: " << e.what();
+        throw;
+    }
+}
+
+
 void PointCloud::load( const std::string & path ) {
 
     std::ifstream f;
@@ -88,9 +249,22 @@ void PointCloud::load( const std::string & path ) {
 
     try {
 
-        f.open( path );
+        f.open( path, std::ios_base::in | std::ios_base::binary );
         clear();
 
+        // binary snapshot? (detected by magic)
+        char magic[ sizeof( BINARY_MAGIC ) ];
+        if ( f.read( magic, sizeof( magic ) )
+             && !std::memcmp( magic, BINARY_MAGIC, sizeof( magic ) ) ) {
+
+            loadBinary( f, path );
+            return;
+        }
+
+        // text format
+        f.clear();
+        f.seekg( 0 );
+
         double x, y, z;
         while (f >> x >> y >> z) {
             push_back( math::Point3(x, y, z) );
@@ -105,6 +279,58 @@ void PointCloud::load( const std::string & path ) {
 }
 
 
+void PointCloud::loadBinary( std::istream & f, const std::string & path ) {
+
+    f.exceptions( std::ios::badbit | std::ios::failbit );
+
+    std::uint32_t version, pointsPerChunk;
+    std::uint64_t count;
+    bin::read( f, version );
+    bin::read( f, pointsPerChunk );
+    bin::read( f, count );
+
+    if ( version != BINARY_VERSION || ( count && !pointsPerChunk ) ) {
+
+        LOG( err2 ) << "File '" << path
+                    << "' is not a valid point cloud snapshot.";
+        throw std::runtime_error( "invalid point cloud snapshot" );
+    }
+
+    std::vector<math::Point3>::clear();
+    reserve( count );
+
+    // bulk sequential reads, one chunk at a time; extents come from
+    // the footer, no per-point bookkeeping
+    std::vector<double> buffer;
+
+    for ( std::uint64_t done = 0; done < count; ) {
+
+        const std::size_t chunk(
+            std::size_t( std::min<std::uint64_t>( pointsPerChunk,
+                                                  count - done ) ) );
+
+        buffer.resize( 3 * chunk );
+        f.read( reinterpret_cast<char *>( buffer.data() ),
+                std::streamsize( buffer.size() * sizeof( double ) ) );
+
+        for ( std::size_t i = 0; i < chunk; i++ ) {
+            std::vector<math::Point3>::emplace_back(
+                buffer[ 3 * i ], buffer[ 3 * i + 1 ],
+                buffer[ 3 * i + 2 ] );
+        }
+
+        done += chunk;
+    }
+
+    // skip per-chunk extents, keep the overall ones
+    const std::uint64_t chunks(
+        count ? ( count + pointsPerChunk - 1 ) / pointsPerChunk : 0 );
+    f.seekg( std::streamoff( chunks * 6 * sizeof( double ) ),
+             std::ios_base::cur );
+    readExtents( f, extents_ );
+}
+
+
 void PointCloud::updateExtents( const math::Point3 & x ) {
     if ( empty() ) {
         extents_ = math::Extents3(x, x);
@@ -116,6 +342,10 @@ void PointCloud::updateExtents( const math::Point3 & x ) {
 
 double PointCloud::samplingDelta( float bulkThreshold ) const {
 
+    // logically const: applies the pending lazy transform, point set
+    // itself does not change
+    const_cast<PointCloud *>( this )->materialize();
+
     ThreeDistance * distArray = new ThreeDistance[ size() ];
 
     // sanity
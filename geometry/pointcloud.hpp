@@ -54,9 +54,11 @@ class PointCloud: public std::vector<math::Point3> {
 public :
 
     /** Initialize */
-    PointCloud() {};
+    PointCloud() : transformPending_( false ) {};
 
-    PointCloud( const std::vector<math::Point3> & in ) {
+    PointCloud( const std::vector<math::Point3> & in )
+        : transformPending_( false )
+    {
         assign(in.begin(), in.end());
     }
 
@@ -91,7 +93,19 @@ public :
     void dump( const std::string & path );
 
     /**
-     * Load a file saved with "dump".
+     * Save to a chunked binary snapshot: fixed-width coordinate chunks
+     * followed by a footer with per-chunk and overall extents. Orders
+     * of magnitude faster to round-trip than dump() and about a third
+     * of the size; use dump() when a human needs to read the file.
+     */
+    void dumpBinary( const std::string & path,
+                     std::size_t pointsPerChunk = 1 << 20 );
+
+    /**
+     * Load a file saved with "dump" or "dumpBinary"; the binary
+     * snapshot is detected by its magic. Binary loads use large
+     * sequential reads and restore extents from the footer, with no
+     * per-point bookkeeping.
      */
     void load( const std::string & path );
 
@@ -115,6 +129,29 @@ public :
     template <class Matrix>
     PointCloud transform( const Matrix & trafo ) const;
 
+    /**
+     * Compose trafo into the pending lazy transform; the points are not
+     * touched. Consecutive calls fuse into a single matrix which
+     * materialize() applies in one pass over the cloud, so a chain of
+     * transforms costs one traversal instead of one per transform.
+     *
+     * Extents are kept usable by transforming the extents box corners
+     * (conservative until materialized). Raw element access (operator[],
+     * iterators, asVector) sees untransformed data until the cloud is
+     * materialized; the class's own readers and modifiers materialize
+     * on demand.
+     */
+    void transformLazy( const math::Matrix4 & trafo );
+
+    /** True if a lazy transform is waiting to be applied. */
+    bool transformPending() const { return transformPending_; }
+
+    /**
+     * Apply the fused pending transform to all points in a single pass
+     * and recompute exact extents. No-op when nothing is pending.
+     */
+    void materialize();
+
     void swap(PointCloud &other);
 
     void swap(std::vector<math::Point3> &other);
@@ -139,6 +176,9 @@ private :
 
     void updateExtents( const math::Point3 & x );
 
+    /** Reads a binary snapshot; stream is positioned behind the magic. */
+    void loadBinary( std::istream & f, const std::string & path );
+
     class ThreeDistance {
 
     public :
@@ -160,6 +200,10 @@ private :
     };
 
     math::Extents3 extents_;
+
+    /* lazy transform pipeline state */
+    math::Matrix4 pendingTrafo_;
+    bool transformPending_;
 };
 
 
@@ -174,6 +218,8 @@ std::basic_ostream<E, T> & operator << (
 template <class InputIterator>
 void PointCloud::assign(InputIterator first, InputIterator last)
 {
+    transformPending_ = false;
+
     std::vector<math::Point3>::assign(first, last);
 
     extents_ = math::computeExtents(first, last);
@@ -183,6 +229,8 @@ template <class InputIterator>
 inline void PointCloud::insert ( iterator position, InputIterator first,
                             InputIterator last ) {
 
+    materialize();
+
     for ( InputIterator it = first; it < last; it++ )
         updateExtents( *it );
 
@@ -195,6 +243,19 @@ inline PointCloud PointCloud::transform( const Matrix & trafo ) const {
 
     PointCloud retval;
 
+    if ( transformPending_ ) {
+
+        // fuse with the pending transform instead of materializing
+        const math::Matrix4 fused( prod( trafo, pendingTrafo_ ) );
+
+        for(const auto &point : *this) {
+            retval.push_back( math::euclidian(
+                prod( fused, math::homogeneous( point ) ) ) );
+        }
+
+        return retval;
+    }
+
     for(const auto &point : *this) {
         retval.push_back( math::euclidian(
             prod( trafo, math::homogeneous( point ) ) ) );
@@ -208,10 +269,14 @@ inline void PointCloud::swap(PointCloud &other)
     std::swap(static_cast<std::vector<math::Point3>&>(*this)
               , static_cast<std::vector<math::Point3>&>(other));
     std::swap(extents_, other.extents_);
+    std::swap(pendingTrafo_, other.pendingTrafo_);
+    std::swap(transformPending_, other.transformPending_);
 }
 
 inline void PointCloud::swap(std::vector<math::Point3> &other)
 {
+    materialize();
+
     std::swap(static_cast<std::vector<math::Point3>&>(*this), other);
 
     extents_ = math::computeExtents(begin(), end());
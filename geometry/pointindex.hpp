@@ -33,7 +33,10 @@
 #ifndef geometry_pointindex_hpp_included_
 #define geometry_pointindex_hpp_included_
 
+#include <cstdint>
+#include <cstring>
 #include <map>
+#include <vector>
 
 namespace geometry {
 
@@ -58,6 +61,112 @@ public:
     }
 };
 
+//! Open-addressing variant of PointIndex for high point volumes.
+//!
+//! Hashes the coordinate bit patterns (same exact-match equivalence as
+//! the map-based index) into a power-of-two slot table with linear
+//! probing, so an assign() is a hash and a short scan instead of a tree
+//! descent. Supports reserve() and bulk assignment. Point coordinates
+//! are accessed as pt(dim).
+//!
+template<typename Point, unsigned Dims = 3>
+class HashedPointIndex
+{
+public:
+    HashedPointIndex() {}
+
+    explicit HashedPointIndex(std::size_t expectedPoints)
+    {
+        reserve(expectedPoints);
+    }
+
+    //! Pre-sizes the index for the expected number of unique points.
+    void reserve(std::size_t expectedPoints)
+    {
+        points_.reserve(expectedPoints);
+
+        std::size_t cap(minCapacity);
+        // target load factor 0.7
+        while (cap * 7 < expectedPoints * 10) { cap *= 2; }
+        if (cap > slots_.size()) { rehash(cap); }
+    }
+
+    //! Assigns (and returns) a unique index for the given point.
+    //! Indices are reused for points that have been seen before.
+    unsigned assign(const Point& pt)
+    {
+        if ((points_.size() + 1) * 10 > slots_.size() * 7) {
+            rehash(slots_.size() ? (slots_.size() * 2) : minCapacity);
+        }
+
+        const std::size_t mask(slots_.size() - 1);
+        for (std::size_t i(hash(pt) & mask); ; i = (i + 1) & mask) {
+            auto &slot(slots_[i]);
+            if (!slot) {
+                // empty slot: new point (slots store index + 1)
+                slot = unsigned(points_.size()) + 1;
+                points_.push_back(pt);
+                return slot - 1;
+            }
+            if (equal(points_[slot - 1], pt)) { return slot - 1; }
+        }
+    }
+
+    //! Assigns indices to a whole span of points in one pass.
+    void assignMany(const Point *points, std::size_t count
+                    , std::vector<unsigned> &indices)
+    {
+        indices.resize(count);
+        reserve(points_.size() + count);
+        for (std::size_t i(0); i < count; ++i) {
+            indices[i] = assign(points[i]);
+        }
+    }
+
+    std::size_t size() const { return points_.size(); }
+
+    //! Unique points in the order their indices were assigned.
+    const std::vector<Point>& points() const { return points_; }
+
+private:
+    static const std::size_t minCapacity = 64;
+
+    static std::size_t hash(const Point &pt)
+    {
+        // FNV-1a over the coordinate bit patterns
+        std::uint64_t h(0xcbf29ce484222325ULL);
+        for (unsigned d(0); d < Dims; ++d) {
+            std::uint64_t bits;
+            const double value(pt(d));
+            std::memcpy(&bits, &value, sizeof(bits));
+            h = (h ^ bits) * 0x100000001b3ULL;
+        }
+        return std::size_t(h);
+    }
+
+    static bool equal(const Point &a, const Point &b)
+    {
+        for (unsigned d(0); d < Dims; ++d) {
+            if (a(d) != b(d)) { return false; }
+        }
+        return true;
+    }
+
+    void rehash(std::size_t capacity)
+    {
+        slots_.assign(capacity, 0);
+        const std::size_t mask(capacity - 1);
+        for (std::size_t p(0); p < points_.size(); ++p) {
+            std::size_t i(hash(points_[p]) & mask);
+            while (slots_[i]) { i = (i + 1) & mask; }
+            slots_[i] = unsigned(p) + 1;
+        }
+    }
+
+    std::vector<unsigned> slots_; // index + 1; 0 marks an empty slot
+    std::vector<Point> points_;
+};
+
 } // namespace geometry
 
 #endif // geometry_pointindex_hpp_included_
@@ -48,6 +48,28 @@ public:
     Clipper(const math::Extents2 &ext) : ext(ext) {}
 
     math::Points2 clip(const math::Points2 &polygon) {
+        // small polygons ping-pong between two fixed buffers across the
+        // four halfspace stages; no allocation until the final result
+        if (!polygon.empty()
+            && (2 * polygon.size() <= StackCapacity))
+        {
+            int size(clipHalfspace<Right>(polygon.data()
+                                          , int(polygon.size()), buf0_));
+            if (size >= 0) {
+                size = clipHalfspace<Upper>(buf0_, size, buf1_);
+            }
+            if (size >= 0) {
+                size = clipHalfspace<Left>(buf1_, size, buf0_);
+            }
+            if (size >= 0) {
+                size = clipHalfspace<Lower>(buf0_, size, buf1_);
+            }
+            if (size >= 0) {
+                return math::Points2(buf1_, buf1_ + size);
+            }
+            // a stage overflowed the buffers -> heap path below
+        }
+
         return clipHalfspace<Lower>
             (clipHalfspace<Left>
              (clipHalfspace<Upper>
@@ -57,6 +79,10 @@ public:
 private:
     const math::Extents2 ext;
 
+    enum { StackCapacity = 128 };
+    math::Point2 buf0_[StackCapacity];
+    math::Point2 buf1_[StackCapacity];
+
     template <int Halfspace>
     bool inside(const math::Point2 &p);
 
@@ -65,6 +91,13 @@ private:
 
     template <int Halfspace>
     math::Points2 clipHalfspace(const math::Points2 &polygon);
+
+    /** Fixed-capacity variant; returns output size or -1 when the result
+     *  would not fit.
+     */
+    template <int Halfspace>
+    int clipHalfspace(const math::Point2 *polygon, int size
+                      , math::Point2 *res);
 };
 
 template <>
@@ -164,6 +197,46 @@ math::Points2 Clipper::clipHalfspace(const math::Points2 &polygon)
     return res;
 }
 
+template <int Halfspace>
+int Clipper::clipHalfspace(const math::Point2 *polygon, int size
+                           , math::Point2 *res)
+{
+    if (!size) {
+        return 0;
+    }
+
+    int count(0);
+
+    // previous point
+    const auto *prev(&polygon[size - 1]);
+    bool prevInside(inside<Halfspace>(*prev));
+
+    for (int i(0); i < size; ++i) {
+        const auto &p(polygon[i]);
+        bool pInside(inside<Halfspace>(p));
+        // "logical xor"
+        if (pInside != prevInside) {
+            // line segment crosses halfspace boundary
+
+            // add intersection
+            if (count == StackCapacity) { return -1; }
+            res[count++] = intersect<Halfspace>(*prev, p);
+        }
+
+        if (pInside) {
+            // add p as well
+            if (count == StackCapacity) { return -1; }
+            res[count++] = p;
+        }
+
+        // prepare for next round
+        prev = &p;
+        prevInside = pInside;
+    }
+
+    return count;
+}
+
 } // namespace cohen_hodgman
 
 math::Points2 clip(const math::Viewport2f &viewport
@@ -172,4 +245,18 @@ math::Points2 clip(const math::Viewport2f &viewport
     return cohen_hodgman::Clipper(extents(viewport)).clip(polygon);
 }
 
+std::vector<math::Points2> clip(const math::Viewport2f &viewport
+                                , const std::vector<math::Points2> &polygons)
+{
+    // one clipper (and its stage buffers) serves the whole batch
+    cohen_hodgman::Clipper clipper(extents(viewport));
+
+    std::vector<math::Points2> res;
+    res.reserve(polygons.size());
+    for (const auto &polygon : polygons) {
+        res.push_back(clipper.clip(polygon));
+    }
+    return res;
+}
+
 } } // namespace geometry::detail
@@ -63,6 +63,16 @@ template <typename Iterator, typename U>
 std::vector<typename std::iterator_traits<Iterator>::value_type>
 clip(const math::Viewport2_<U> &viewport, Iterator begin, Iterator end);
 
+/** Clip a batch of polygons by one viewport in a single call.
+ *
+ *  Output is aligned with input: element i holds polygon i clipped (and
+ *  may be empty). Clipper setup is shared by the whole batch.
+ */
+template <typename T, typename U>
+std::vector<std::vector<math::Point2_<T> > >
+clip(const math::Viewport2_<U> &viewport
+     , const std::vector<std::vector<math::Point2_<T> > > &polygons);
+
 
 /** Determine whether polygon is convex.
  */
@@ -103,6 +113,9 @@ double area( const std::vector<math::Point2_<T> > & polygon  ) {
 namespace detail {
     math::Points2 clip(const math::Viewport2f &viewport
                        , const math::Points2 &polygon);
+    std::vector<math::Points2>
+    clip(const math::Viewport2f &viewport
+         , const std::vector<math::Points2> &polygons);
 }
 
 template <typename T, typename U>
@@ -125,6 +138,27 @@ clip(const math::Viewport2_<U> &viewport
     return { res.begin(), res.end() };
 }
 
+template <typename T, typename U>
+std::vector<std::vector<math::Point2_<T> > >
+clip(const math::Viewport2_<U> &viewport
+     , const std::vector<std::vector<math::Point2_<T> > > &polygons)
+{
+    std::vector<math::Points2> input;
+    input.reserve(polygons.size());
+    for (const auto &polygon : polygons) {
+        input.emplace_back(polygon.begin(), polygon.end());
+    }
+
+    auto res(detail::clip(math::Viewport2f(viewport), input));
+
+    std::vector<std::vector<math::Point2_<T> > > out;
+    out.reserve(res.size());
+    for (const auto &polygon : res) {
+        out.emplace_back(polygon.begin(), polygon.end());
+    }
+    return out;
+}
+
 namespace detail {
 
 inline char getSign(double value) {
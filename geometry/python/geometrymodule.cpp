@@ -26,11 +26,17 @@
 
 #include <ogr_core.h>
 
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <mutex>
 
+#include <boost/noncopyable.hpp>
 #include <boost/python.hpp>
 #include <boost/python/scope.hpp>
 #include <boost/python/extract.hpp>
@@ -48,6 +54,7 @@
 
 #include "../mesh.hpp"
 #include "../meshop.hpp"
+#include "../binmesh.hpp"
 
 namespace fs = boost::filesystem;
 namespace bp = boost::python;
@@ -85,43 +92,372 @@ void addVertex(Mesh &m, double x, double y, double z)
     return m.vertices.emplace_back(x, y, z);
 }
 
+namespace {
+
+/** Releases the GIL for the lifetime of the guard (RAII). Wrap the
+ *  pure-C++ part of a binding in it; anything touching Python objects
+ *  must stay outside.
+ */
+class GilRelease {
+public:
+    GilRelease() : state_(PyEval_SaveThread()) {}
+    ~GilRelease() { PyEval_RestoreThread(state_); }
+
+    GilRelease(const GilRelease&) = delete;
+    GilRelease& operator=(const GilRelease&) = delete;
+
+private:
+    PyThreadState *state_;
+};
+
+/** Python buffer acquired via the buffer protocol (RAII).
+ */
+struct BufferGuard {
+    Py_buffer view;
+
+    BufferGuard(const bp::object &data, int flags) {
+        if (PyObject_GetBuffer(data.ptr(), &view, flags)) {
+            bp::throw_error_already_set();
+        }
+    }
+
+    ~BufferGuard() { PyBuffer_Release(&view); }
+
+    BufferGuard(const BufferGuard&) = delete;
+    BufferGuard& operator=(const BufferGuard&) = delete;
+};
+
+void raiseValueError(const std::string &message)
+{
+    PyErr_SetString(PyExc_ValueError, message.c_str());
+    bp::throw_error_already_set();
+}
+
+/** Number of records in a flat buffer; each record has given number of
+ *  components.
+ */
+std::size_t recordCount(const Py_buffer &view, std::size_t components
+                        , const char *what)
+{
+    if ((view.itemsize <= 0) || (view.len % view.itemsize)) {
+        raiseValueError(std::string(what) + ": malformed buffer");
+    }
+
+    const std::size_t items(view.len / view.itemsize);
+    if (items % components) {
+        raiseValueError(std::string(what) + ": buffer size is not a multiple"
+                        " of " + std::to_string(components));
+    }
+
+    return items / components;
+}
+
+/** Read i-th index from a buffer of 32- or 64-bit integers.
+ */
+index_type bufferIndex(const Py_buffer &view, std::size_t i)
+{
+    const char *raw(static_cast<const char*>(view.buf)
+                    + i * view.itemsize);
+    if (view.itemsize == 4) {
+        std::uint32_t value;
+        std::memcpy(&value, raw, sizeof(value));
+        return index_type(value);
+    }
+
+    std::uint64_t value;
+    std::memcpy(&value, raw, sizeof(value));
+    return index_type(value);
+}
+
+void checkIndexBuffer(const Py_buffer &view, const char *what)
+{
+    if ((view.itemsize != 4) && (view.itemsize != 8)) {
+        raiseValueError(std::string(what) + ": expected a buffer of 32- or"
+                        " 64-bit integers");
+    }
+}
+
+void checkDoubleBuffer(const Py_buffer &view, const char *what)
+{
+    if (view.itemsize != Py_ssize_t(sizeof(double))) {
+        raiseValueError(std::string(what)
+                        + ": expected a buffer of doubles");
+    }
+}
+
+/** Builds a 2D strided memoryview aliasing mesh storage. The view stays
+ *  valid only until the underlying vector reallocates or the mesh dies;
+ *  CPython copies shape/strides into the memoryview so the local arrays
+ *  may go out of scope.
+ */
+bp::object makeMemoryView(void *data, std::size_t count
+                          , std::size_t components, std::size_t stride
+                          , std::size_t itemsize, const char *format)
+{
+    Py_buffer view;
+    std::memset(&view, 0, sizeof(view));
+
+    Py_ssize_t shape[2] = { Py_ssize_t(count), Py_ssize_t(components) };
+    Py_ssize_t strides[2] = { Py_ssize_t(stride), Py_ssize_t(itemsize) };
+
+    view.buf = data;
+    view.obj = nullptr;
+    view.len = Py_ssize_t(count * components * itemsize);
+    view.itemsize = Py_ssize_t(itemsize);
+    view.readonly = 0;
+    view.ndim = 2;
+    view.format = const_cast<char*>(format);
+    view.shape = shape;
+    view.strides = strides;
+
+    PyObject *mv(PyMemoryView_FromBuffer(&view));
+    if (!mv) { bp::throw_error_already_set(); }
+    return bp::object(bp::handle<>(mv));
+}
+
+} // namespace
+
+/** Replace mesh vertices from a contiguous buffer of (x, y, z) doubles
+ *  (e.g. a numpy array of shape (N, 3)) in one pass.
+ */
+void setVertices(Mesh &m, const bp::object &data)
+{
+    BufferGuard buffer(data, PyBUF_FORMAT | PyBUF_ND);
+    const auto &view(buffer.view);
+    checkDoubleBuffer(view, "setVertices");
+
+    const auto count(recordCount(view, 3, "setVertices"));
+    const double *src(static_cast<const double*>(view.buf));
+
+    m.vertices.resize(count);
+    for (auto &v : m.vertices) {
+        v(0) = src[0]; v(1) = src[1]; v(2) = src[2];
+        src += 3;
+    }
+}
+
+/** Replace mesh texture coordinates from a contiguous buffer of (u, v)
+ *  doubles in one pass.
+ */
+void setTCoords(Mesh &m, const bp::object &data)
+{
+    BufferGuard buffer(data, PyBUF_FORMAT | PyBUF_ND);
+    const auto &view(buffer.view);
+    checkDoubleBuffer(view, "setTCoords");
+
+    const auto count(recordCount(view, 2, "setTCoords"));
+    const double *src(static_cast<const double*>(view.buf));
+
+    m.tCoords.resize(count);
+    for (auto &t : m.tCoords) {
+        t(0) = src[0]; t(1) = src[1];
+        src += 2;
+    }
+}
+
+/** Replace mesh faces from a contiguous buffer of (a, b, c) vertex index
+ *  triplets.
+ */
+void setFaces2(Mesh &m, const bp::object &vertexIndices)
+{
+    BufferGuard buffer(vertexIndices, PyBUF_FORMAT | PyBUF_ND);
+    const auto &view(buffer.view);
+    checkIndexBuffer(view, "setFaces");
+
+    const auto count(recordCount(view, 3, "setFaces"));
+
+    m.faces.clear();
+    m.faces.reserve(count);
+    for (std::size_t i(0); i < count; ++i) {
+        m.faces.emplace_back(bufferIndex(view, 3 * i)
+                             , bufferIndex(view, 3 * i + 1)
+                             , bufferIndex(view, 3 * i + 2));
+    }
+}
+
+/** Replace mesh faces from contiguous buffers of (a, b, c) vertex and
+ *  (ta, tb, tc) texture coordinate index triplets.
+ */
+void setFaces3(Mesh &m, const bp::object &vertexIndices
+               , const bp::object &tcIndices)
+{
+    BufferGuard vBuffer(vertexIndices, PyBUF_FORMAT | PyBUF_ND);
+    BufferGuard tBuffer(tcIndices, PyBUF_FORMAT | PyBUF_ND);
+    const auto &vView(vBuffer.view);
+    const auto &tView(tBuffer.view);
+    checkIndexBuffer(vView, "setFaces");
+    checkIndexBuffer(tView, "setFaces");
+
+    const auto count(recordCount(vView, 3, "setFaces"));
+    if (recordCount(tView, 3, "setFaces") != count) {
+        raiseValueError("setFaces: vertex and texture coordinate index"
+                        " buffers differ in size");
+    }
+
+    m.faces.clear();
+    m.faces.reserve(count);
+    for (std::size_t i(0); i < count; ++i) {
+        m.faces.emplace_back(bufferIndex(vView, 3 * i)
+                             , bufferIndex(vView, 3 * i + 1)
+                             , bufferIndex(vView, 3 * i + 2)
+                             , bufferIndex(tView, 3 * i)
+                             , bufferIndex(tView, 3 * i + 1)
+                             , bufferIndex(tView, 3 * i + 2));
+    }
+}
+
+/** Zero-copy (N, 3) double view of mesh vertices; None for an empty
+ *  mesh. Aliases mesh storage, see makeMemoryView().
+ */
+bp::object verticesView(Mesh &m)
+{
+    if (m.vertices.empty()) { return bp::object(); }
+    return makeMemoryView(&m.vertices.front()(0), m.vertices.size(), 3
+                          , sizeof(math::Point3), sizeof(double), "d");
+}
+
+/** Zero-copy (N, 2) double view of mesh texture coordinates; None for a
+ *  mesh without them.
+ */
+bp::object tCoordsView(Mesh &m)
+{
+    if (m.tCoords.empty()) { return bp::object(); }
+    return makeMemoryView(&m.tCoords.front()(0), m.tCoords.size(), 2
+                          , sizeof(math::Point2), sizeof(double), "d");
+}
+
+/** Zero-copy (N, 3) view of face vertex indices (Face::a, b, c); None
+ *  for a mesh without faces.
+ */
+bp::object facesView(Mesh &m)
+{
+    if (m.faces.empty()) { return bp::object(); }
+    return makeMemoryView(&m.faces.front().a, m.faces.size(), 3
+                          , sizeof(geometry::Face)
+                          , sizeof(index_type), "I");
+}
+
 Mesh clip2(const Mesh &m, const math::Extents2 &e)
 {
+    GilRelease gil;
     return geometry::clip(m, e);
 }
 
 Mesh clip3(const Mesh &m, const math::Extents3 &e)
 {
+    GilRelease gil;
     return geometry::clip(m, e);
 }
 
 void appendMesh(Mesh &mesh, const Mesh &added)
 {
+    GilRelease gil;
     return geometry::append(mesh, added);
 }
 
 Mesh loadObj(const boost::filesystem::path &filepath)
 {
+    GilRelease gil;
     return geometry::loadObj(filepath);
 }
 
+Mesh loadPly1(const fs::path &filepath)
+{
+    GilRelease gil;
+    return geometry::loadPly(filepath);
+}
+
 void saveObj1(const geometry::Mesh &mesh, const fs::path &path)
 {
+    GilRelease gil;
     return geometry::saveAsObj(mesh, path, {});
 }
 
 void saveObj2(const geometry::Mesh &mesh, const fs::path &path
               , const std::string &mtlLibrary)
 {
+    GilRelease gil;
     return geometry::saveAsObj(mesh, path, mtlLibrary);
 }
 
 void saveObj3(const geometry::Mesh &mesh, const fs::path &path
               , const ObjMaterial &mtl)
 {
+    GilRelease gil;
     return geometry::saveAsObj(mesh, path, mtl);
 }
 
+void savePly1(const geometry::Mesh &mesh, const fs::path &path)
+{
+    GilRelease gil;
+    return geometry::saveAsPly(mesh, path);
+}
+
+#ifdef GEOMETRY_HAS_OPENMESH
+
+Mesh simplify1(const Mesh &mesh, int faceCount)
+{
+    GilRelease gil;
+    return *geometry::simplify(mesh, faceCount);
+}
+
+#endif // GEOMETRY_HAS_OPENMESH
+
+/** Future-like handle to a mesh being loaded on a background thread.
+ *  The worker runs without the GIL (it only touches C++); get() blocks
+ *  with the GIL released, so other Python threads keep running.
+ */
+class MeshFuture {
+public:
+    MeshFuture(const fs::path &path, Mesh (*loader)(const fs::path&))
+        : future_(std::async(std::launch::async, loader, path))
+    {}
+
+    /** True once the result (or an error) is ready; non-blocking. */
+    bool done() const {
+        return !future_.valid()
+            || (future_.wait_for(std::chrono::seconds(0))
+                == std::future_status::ready);
+    }
+
+    /** Waits for the worker and returns the mesh; a load error raised
+     *  by the worker is re-thrown here. One-shot.
+     */
+    Mesh get() {
+        if (!future_.valid()) {
+            PyErr_SetString(PyExc_RuntimeError
+                            , "MeshFuture result already taken");
+            bp::throw_error_already_set();
+        }
+
+        GilRelease gil;
+        return future_.get();
+    }
+
+private:
+    std::future<Mesh> future_;
+};
+
+std::shared_ptr<MeshFuture> loadObjAsync(const fs::path &path)
+{
+    return std::make_shared<MeshFuture>
+        (path, +[](const fs::path &p) { return geometry::loadObj(p); });
+}
+
+std::shared_ptr<MeshFuture> loadPlyAsync(const fs::path &path)
+{
+    return std::make_shared<MeshFuture>
+        (path, +[](const fs::path &p) { return geometry::loadPly(p); });
+}
+
+std::shared_ptr<MeshFuture> loadBinaryMeshAsync(const fs::path &path)
+{
+    return std::make_shared<MeshFuture>
+        (path, +[](const fs::path &p) {
+            return *asMesh(geometry::loadBinaryMesh(p));
+        });
+}
+
 } } // namespace geometry::py
 
 BOOST_PYTHON_MODULE(melown_geometry)
@@ -141,7 +477,7 @@ BOOST_PYTHON_MODULE(melown_geometry)
         .def(init<index_type, index_type, index_type
              , index_type, index_type, index_type, unsigned int>())
 
-        .def("normal", &geometry::Face::normal)
+        .def("normal", &geometry::Face::normal<double>)
         .def("clear", &geometry::Face::clear)
         .def("degenerate", &geometry::Face::degenerate)
 
@@ -172,6 +508,13 @@ BOOST_PYTHON_MODULE(melown_geometry)
         .def("addFace", &py::addFace6)
         .def("addFace", &py::addFace7)
         .def("addVertex", &py::addVertex)
+        .def("setVertices", &py::setVertices)
+        .def("setTCoords", &py::setTCoords)
+        .def("setFaces", &py::setFaces2)
+        .def("setFaces", &py::setFaces3)
+        .def("verticesView", &py::verticesView)
+        .def("tCoordsView", &py::tCoordsView)
+        .def("facesView", &py::facesView)
         .def("a", &geometry::Mesh::a, InternalRef)
         .def("b", &geometry::Mesh::b, InternalRef)
         .def("c", &geometry::Mesh::c, InternalRef)
@@ -202,10 +545,9 @@ BOOST_PYTHON_MODULE(melown_geometry)
         .def_readwrite("names", &geometry::ObjMaterial::names)
         ;
 
-    def<geometry::Mesh (*)(const fs::path&)>("loadPly", &geometry::loadPly);
+    def("loadPly", &py::loadPly1);
     def("loadObj", &py::loadObj);
-    def<void (*)(const geometry::Mesh&, const fs::path&)>
-        ("savePly", &geometry::saveAsPly);
+    def("savePly", &py::savePly1);
     def("saveObj", &py::saveObj1);
     def("saveObj", &py::saveObj2);
     def("saveObj", &py::saveObj3);
@@ -213,6 +555,22 @@ BOOST_PYTHON_MODULE(melown_geometry)
     def("clip", &py::clip2);
     def("clip", &py::clip3);
     def("append", &py::appendMesh);
+
+#ifdef GEOMETRY_HAS_OPENMESH
+    def("simplify", &py::simplify1);
+#endif
+
+    // background loading: the worker parses without the GIL, the handle
+    // hands the mesh over once ready
+    class_<py::MeshFuture, std::shared_ptr<py::MeshFuture>
+           , boost::noncopyable>("MeshFuture", no_init)
+        .def("done", &py::MeshFuture::done)
+        .def("get", &py::MeshFuture::get)
+        ;
+
+    def("loadObjAsync", &py::loadObjAsync);
+    def("loadPlyAsync", &py::loadPlyAsync);
+    def("loadBinaryMeshAsync", &py::loadBinaryMeshAsync);
 }
 
 namespace geometry { namespace py {
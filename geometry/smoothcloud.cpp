@@ -32,6 +32,9 @@
  *  2014-07-09 (vasek) Stolen from window-mesh
  */
 
+#include <atomic>
+#include <thread>
+
 #include "utility/openmp.hpp"
 #include "utility/progress.hpp"
 
@@ -45,6 +48,14 @@ namespace geometry {
 math::Points3 CloudSmoother::operator()(const math::Points3 &points
                                         , const KdTree<math::Point3> &kdtree)
     const
+{
+    return operator()(points, kdtree, ProgressCallback());
+}
+
+math::Points3 CloudSmoother::operator()(const math::Points3 &points
+                                        , const KdTree<math::Point3> &kdtree
+                                        , const ProgressCallback &progressCb)
+    const
 {
     // sanity check
     if (!params_.feasible(points.size())) {
@@ -61,7 +72,18 @@ math::Points3 CloudSmoother::operator()(const math::Points3 &points
 
     utility::ts::Progress progress("Cloud smoothing", size);
 
-    UTILITY_OMP(parallel for private(neighbors))
+    const int nThreads(params_.nThreads
+                       ? int(params_.nThreads)
+                       : std::max(1, int(std::thread::hardware_concurrency())));
+    const auto chunkSize(std::max<std::size_t>(params_.chunkSize, 1));
+    const auto progressStep(std::max<std::size_t>(size / 1000, 1));
+    std::atomic<std::size_t> done(0);
+
+    // each worker grabs whole chunks and keeps its neighbor scratch
+    // buffer between points; output goes into the pre-sized cloud above,
+    // the input stays untouched
+    UTILITY_OMP(parallel for private(neighbors)
+                schedule(dynamic, chunkSize) num_threads(nThreads))
     for (int64_t i = 0; i < (int64_t)size; ++i) {
         const auto &point(points[i]);
         auto &spoint(smooth[i]);
@@ -80,8 +102,15 @@ math::Points3 CloudSmoother::operator()(const math::Points3 &points
         spoint = sum * (1.0 / wsum);
 
         ++progress;
+
+        if (progressCb) {
+            const auto d(++done);
+            if (!(d % progressStep)) { progressCb(d, size); }
+        }
     }
 
+    if (progressCb) { progressCb(size, size); }
+
     return smooth;
 }
 
@@ -35,6 +35,7 @@
 #ifndef geometry_smoothcloud_hpp_included_
 #define geometry_smoothcloud_hpp_included_
 
+#include <functional>
 #include <iostream>
 #include <boost/program_options.hpp>
 
@@ -55,8 +56,17 @@ public:
          */
         double radius;
 
+        /** Number of worker threads (0 = all hardware threads).
+         */
+        std::size_t nThreads;
+
+        /** Number of points per scheduling chunk. Each worker processes
+         *  whole chunks with a persistent neighbor scratch buffer.
+         */
+        std::size_t chunkSize;
+
         Params()
-            : neighbors(10), radius(0.1)
+            : neighbors(10), radius(0.1), nThreads(0), chunkSize(4096)
         {}
 
         void configuration(const std::string &section
@@ -71,6 +81,12 @@ public:
                 ((section + "radius").c_str(),
                  value(&radius)->default_value(radius),
                  "Radius of point's neighborhood use.")
+                ((section + "nThreads").c_str(),
+                 value(&nThreads)->default_value(nThreads),
+                 "Number of worker threads (0 = all).")
+                ((section + "chunkSize").c_str(),
+                 value(&chunkSize)->default_value(chunkSize),
+                 "Number of points per scheduling chunk.")
                 ;
         }
 
@@ -102,6 +118,18 @@ public:
     math::Points3 operator()(const math::Points3 &points
                              , const KdTree<math::Point3> &kdtree) const;
 
+    /** Called roughly every permille of progress as (done, total).
+     *  Invoked from worker threads; must be thread-safe.
+     */
+    typedef std::function<void(std::size_t, std::size_t)> ProgressCallback;
+
+    /** Smooth given cloud with progress reporting. The input stays
+     *  immutable; results land in a pre-sized output cloud.
+     */
+    math::Points3 operator()(const math::Points3 &points
+                             , const KdTree<math::Point3> &kdtree
+                             , const ProgressCallback &progressCb) const;
+
 private:
     const Params params_;
 };
@@ -0,0 +1,191 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstdint>
+
+#include "utility/openmp.hpp"
+
+#include "spatialsort.hpp"
+
+namespace geometry {
+
+namespace {
+
+/** Spreads the low 21 bits of v so that there are two zero bits between
+ *  every pair of consecutive payload bits.
+ */
+inline std::uint64_t spreadBits(std::uint64_t v)
+{
+    v &= 0x1fffffull;
+    v = (v | (v << 32)) & 0x1f00000000ffffull;
+    v = (v | (v << 16)) & 0x1f0000ff0000ffull;
+    v = (v | (v << 8))  & 0x100f00f00f00f00full;
+    v = (v | (v << 4))  & 0x10c30c30c30c30c3ull;
+    v = (v | (v << 2))  & 0x1249249249249249ull;
+    return v;
+}
+
+inline std::uint64_t quantize(double value, double origin, double scale)
+{
+    double q((value - origin) * scale);
+    if (q < 0.0) { q = 0.0; }
+    if (q > 2097151.0) { q = 2097151.0; }
+    return std::uint64_t(q);
+}
+
+/** Permutation sorting keys ascending; stable, so deterministic. The
+ *  keys are scattered into buckets by their top bits first and the
+ *  buckets are sorted in parallel.
+ */
+std::vector<std::size_t> sortedOrder(const std::vector<std::uint64_t> &keys)
+{
+    const std::size_t count(keys.size());
+
+    // top 8 payload bits of the 63-bit code
+    const unsigned int bucketBits(8), shift(63 - bucketBits);
+    const std::size_t buckets(std::size_t(1) << bucketBits);
+
+    std::vector<std::size_t> offsets(buckets + 1, 0);
+    for (std::size_t i(0); i < count; ++i) {
+        ++offsets[(keys[i] >> shift) + 1];
+    }
+    for (std::size_t b(1); b <= buckets; ++b) {
+        offsets[b] += offsets[b - 1];
+    }
+
+    std::vector<std::size_t> order(count);
+    {
+        std::vector<std::size_t> cursor(offsets.begin()
+                                        , offsets.begin() + buckets);
+        for (std::size_t i(0); i < count; ++i) {
+            order[cursor[keys[i] >> shift]++] = i;
+        }
+    }
+
+    UTILITY_OMP(parallel for schedule( dynamic, 1 ))
+    for (std::int64_t b = 0; b < std::int64_t(buckets); ++b) {
+        std::sort(order.begin() + offsets[b], order.begin() + offsets[b + 1]
+                  , [&keys](std::size_t x, std::size_t y) {
+                        // index tie-break keeps equal keys stable
+                        return (keys[x] != keys[y])
+                            ? (keys[x] < keys[y]) : (x < y);
+                  });
+    }
+
+    return order;
+}
+
+std::vector<std::uint64_t> mortonKeys(const math::Points3 &points)
+{
+    const math::Extents3 extents
+        (math::computeExtents(points.begin(), points.end()));
+
+    std::vector<std::uint64_t> keys(points.size());
+
+    UTILITY_OMP(parallel for schedule( static ))
+    for (std::int64_t i = 0; i < std::int64_t(points.size()); ++i) {
+        keys[i] = mortonCode(points[i], extents);
+    }
+
+    return keys;
+}
+
+} // namespace
+
+std::uint64_t mortonCode(const math::Point3 &point
+                         , const math::Extents3 &extents)
+{
+    const math::Point3 size(extents.ur - extents.ll);
+
+    std::uint64_t code(0);
+    for (int axis(0); axis < 3; ++axis) {
+        const double scale((size(axis) > 0.0)
+                           ? 2097151.0 / size(axis) : 0.0);
+        code |= spreadBits(quantize(point(axis), extents.ll(axis), scale))
+            << axis;
+    }
+    return code;
+}
+
+std::vector<std::size_t> spatialSortOrder(const math::Points3 &points)
+{
+    return sortedOrder(mortonKeys(points));
+}
+
+void spatialSort(math::Points3 &points)
+{
+    if (points.size() < 2) { return; }
+
+    const auto order(spatialSortOrder(points));
+
+    math::Points3 sorted;
+    sorted.reserve(points.size());
+    for (const auto index : order) { sorted.push_back(points[index]); }
+    points.swap(sorted);
+}
+
+void spatialSort(Mesh &mesh)
+{
+    if (mesh.vertices.size() >= 2) {
+        const auto order(spatialSortOrder(mesh.vertices));
+
+        // reorder vertices, remembering where each one went
+        math::Points3 sorted;
+        sorted.reserve(mesh.vertices.size());
+        std::vector<std::size_t> newIndex(mesh.vertices.size());
+        for (std::size_t i(0); i < order.size(); ++i) {
+            newIndex[order[i]] = i;
+            sorted.push_back(mesh.vertices[order[i]]);
+        }
+        mesh.vertices.swap(sorted);
+
+        for (auto &face : mesh.faces) {
+            face.a = newIndex[face.a];
+            face.b = newIndex[face.b];
+            face.c = newIndex[face.c];
+        }
+    }
+
+    if (mesh.faces.size() < 2) { return; }
+
+    // reorder faces along the curve as well, by centroid
+    math::Points3 centroids;
+    centroids.reserve(mesh.faces.size());
+    for (const auto &face : mesh.faces) {
+        centroids.push_back((mesh.vertices[face.a] + mesh.vertices[face.b]
+                             + mesh.vertices[face.c]) / 3.0);
+    }
+
+    const auto order(spatialSortOrder(centroids));
+
+    Face::list sorted;
+    sorted.reserve(mesh.faces.size());
+    for (const auto index : order) { sorted.push_back(mesh.faces[index]); }
+    mesh.faces.swap(sorted);
+}
+
+} // namespace geometry
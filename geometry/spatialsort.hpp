@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ *  @file spatialsort.hpp
+ *
+ *  Morton-order spatial sort of points and meshes.
+ *
+ *  Reordering input along a space filling curve makes spatially close
+ *  elements close in memory, which speeds up every locality-sensitive
+ *  consumer downstream (BVH and kd-tree builds, clipping, grid
+ *  binning). Bvh::build has a matching fast path for pre-sorted input,
+ *  see BvhPresorted in bvh.hpp.
+ */
+
+#ifndef geometry_spatialsort_hpp_included_
+#define geometry_spatialsort_hpp_included_
+
+#include <cstdint>
+#include <vector>
+
+#include "math/geometry_core.hpp"
+
+#include "mesh.hpp"
+
+namespace geometry {
+
+/** 63-bit Morton code of a point: each coordinate is quantized to 21
+ *  bits over the given extents and the bits are interleaved (x lowest).
+ */
+std::uint64_t mortonCode(const math::Point3 &point
+                         , const math::Extents3 &extents);
+
+/** Permutation that sorts points into Morton order over their extents;
+ *  order[i] is the index of the point at position i after the sort.
+ *  Keys are bucketed by their top bits and the buckets are sorted in
+ *  parallel. Equal keys keep their relative order, so the result is
+ *  deterministic.
+ */
+std::vector<std::size_t> spatialSortOrder(const math::Points3 &points);
+
+/** Reorders points into Morton order. Works for PointCloud as well
+ *  (extents are order independent).
+ */
+void spatialSort(math::Points3 &points);
+
+/** Reorders mesh vertices into Morton order, remapping face vertex
+ *  indices, and then reorders faces by the Morton code of their
+ *  centroid. Texture coordinates and per-face attributes are kept; the
+ *  mesh geometry is unchanged.
+ */
+void spatialSort(Mesh &mesh);
+
+} // namespace geometry
+
+#endif // geometry_spatialsort_hpp_included_
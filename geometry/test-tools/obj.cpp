@@ -3,6 +3,7 @@
 #include "dbglog/dbglog.hpp"
 
 #include "geometry/parse-obj.hpp"
+#include "geometry/mesh.hpp"
 
 int main(int argc, char *argv[])
 {
@@ -12,13 +13,17 @@ int main(int argc, char *argv[])
     }
 
     struct Loader : geometry::ObjParserBase {
+        geometry::Mesh mesh;
+
         virtual void addVertex(const Vector3d &v) {
             LOG(info4) << "vertex: (" << v.x << ", " << v.y << ", "
                        << v.z << ")";
+            mesh.vertices.emplace_back(v.x, v.y, v.z);
         }
         virtual void addTexture(const Vector3d &t) {
             LOG(info4) << "texture: (" << t.x << ", " << t.y << ", "
                        << t.z << ")";
+            mesh.tCoords.emplace_back(t.x, t.y);
         }
         virtual void addNormal(const Vector3d &n) {
             LOG(info4) << "normal: (" << n.x << ", " << n.y << ", "
@@ -31,6 +36,8 @@ int main(int argc, char *argv[])
                        << f.t[2] << "), b=("
                        << "facet: n=(" << f.n[0] << ", " << f.n[1] << ", "
                        << f.n[2] << ")";
+            mesh.addFace(f.v[0], f.v[1], f.v[2]
+                         , f.t[0], f.t[1], f.t[2]);
         }
 
         virtual void materialLibrary(const std::string &path) {
@@ -45,5 +52,7 @@ int main(int argc, char *argv[])
     Loader loader;
     loader.parse(argv[1]);
 
+    LOG(info4) << "stats: " << geometry::meshStats(loader.mesh);
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <math/math_all.hpp>
+#include <geometry/bvh.hpp>
+
+namespace {
+
+struct BvhBox : geometry::BvhPrimitive {
+    math::Extents3 box;
+
+    BvhBox() = default;
+
+    BvhBox(const math::Point3 &center, double halfSize, std::size_t index) {
+        const math::Point3 size(halfSize, halfSize, halfSize);
+        box = math::Extents3(center - size, center + size);
+        userData = index;
+    }
+
+    bool getIntersection(const geometry::Ray &ray
+                         , geometry::IntersectionInfo &intersection) const {
+        double t0, t1;
+        if (!geometry::intersectBox(box, ray, t0, t1) || (t1 <= 0.)) {
+            return false;
+        }
+        intersection.t = (t0 > 0.) ? t0 : t1;
+        intersection.object = this;
+        return true;
+    }
+
+    math::Extents3 getBBox() const { return box; }
+
+    math::Point3 getCenter() const {
+        return math::Point3((box.ll + box.ur) / 2.);
+    }
+};
+
+math::Point3 randomPoint()
+{
+    return math::Point3((double) rand() / RAND_MAX,
+                        (double) rand() / RAND_MAX,
+                        (double) rand() / RAND_MAX);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(geometry_bvh_parallel_build)
+{
+    const int N = 20000;
+    BOOST_TEST_MESSAGE("* Testing parallel BVH build on " << N << " boxes");
+
+    // generate random boxes in the unit cube
+    srand(0);
+    std::vector<BvhBox> objects;
+    for (int i = 0; i < N; i++)
+    {
+        objects.push_back(BvhBox(randomPoint(), 0.002, i));
+    }
+
+    // serial build and two parallel builds over the same input
+    geometry::Bvh<BvhBox> serial(4);
+    {
+        auto copy(objects);
+        serial.build(std::move(copy));
+    }
+
+    geometry::Bvh<BvhBox> parallel1(4);
+    {
+        auto copy(objects);
+        parallel1.build(std::move(copy), geometry::BvhParallel(4));
+    }
+
+    geometry::Bvh<BvhBox> parallel2(4);
+    {
+        auto copy(objects);
+        parallel2.build(std::move(copy), geometry::BvhParallel(4));
+    }
+
+    for (int i = 0; i < 1000; i++)
+    {
+        const math::Point3 origin(randomPoint());
+        const math::Point3 target(randomPoint());
+        if (origin == target) { continue; }
+        const geometry::Ray ray
+            (origin, math::normalize(math::Point3(target - origin)));
+
+        geometry::IntersectionInfo si, pi1, pi2;
+        const bool sHit(serial.getFirstIntersection(ray, si));
+        const bool pHit1(parallel1.getFirstIntersection(ray, pi1));
+        const bool pHit2(parallel2.getFirstIntersection(ray, pi2));
+
+        // the SAH tree differs from the median-split tree but the
+        // closest hit must be the same object at the same distance
+        BOOST_REQUIRE(sHit == pHit1);
+        if (sHit)
+        {
+            BOOST_REQUIRE(si.t == pi1.t);
+            BOOST_REQUIRE(si.object->userData == pi1.object->userData);
+        }
+
+        // two parallel builds of the same input must behave identically
+        BOOST_REQUIRE(pHit1 == pHit2);
+        if (pHit1)
+        {
+            BOOST_REQUIRE(pi1.t == pi2.t);
+            BOOST_REQUIRE(pi1.object->userData == pi2.object->userData);
+        }
+    }
+}
@@ -72,7 +72,129 @@ BOOST_AUTO_TEST_CASE(geometry_kdtree_nearest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(geometry_kdtree_parallel_build)
+{
+    const int N = 10000;
+    BOOST_TEST_MESSAGE("* Testing parallel kd-tree build on " << N
+                       << " points");
+
+    // generate random points in the unit cube
+    srand(0);
+    std::vector<math::Point3> points;
+    for (int i = 0; i < N; i++)
+    {
+        points.emplace_back((double) rand() / RAND_MAX,
+                            (double) rand() / RAND_MAX,
+                            (double) rand() / RAND_MAX);
+    }
+
+    // build serial and parallel trees over the same container
+    geometry::KdTree<math::Point3> serial(points.begin(), points.end());
+    geometry::KdTree<math::Point3> parallel
+        (points.begin(), points.end(), geometry::KdTreeParallel(4));
+
+    // both trees must return identical nearest neighbors
+    for (int i = 0; i < N; i++)
+    {
+        double sDist2, pDist2;
+        const math::Point3 &sNeigh = *serial.nearest<true>(points[i], sDist2);
+        const math::Point3 &pNeigh = *parallel.nearest<true>(points[i], pDist2);
+
+        BOOST_REQUIRE((sDist2 == pDist2) && (sNeigh == pNeigh));
+    }
+}
 
+BOOST_AUTO_TEST_CASE(geometry_kdtree_nearest_batch)
+{
+    const int N = 2000;
+    const unsigned int K = 8;
+    BOOST_TEST_MESSAGE("* Testing batched " << K << "-nn queries on " << N
+                       << " points");
+
+    // generate random points in the unit cube
+    srand(0);
+    std::vector<math::Point3> points;
+    for (int i = 0; i < N; i++)
+    {
+        points.emplace_back((double) rand() / RAND_MAX,
+                            (double) rand() / RAND_MAX,
+                            (double) rand() / RAND_MAX);
+    }
+
+    geometry::KdTree<math::Point3> kdtree(points.begin(), points.end());
+
+    std::vector<geometry::KdTree<math::Point3>::Neighbors> results;
+    kdtree.nearestBatch(points, K, results);
+
+    BOOST_REQUIRE(results.size() == points.size());
+
+    for (int i = 0; i < N; i++)
+    {
+        const auto &neighbors(results[i]);
+        BOOST_REQUIRE(neighbors.size() == K);
+
+        // brute force: K smallest distances
+        std::vector<double> bf;
+        for (int j = 0; j < N; j++)
+        {
+            math::Point3 diff(points[i] - points[j]);
+            bf.push_back(inner_prod(diff, diff));
+        }
+        std::sort(bf.begin(), bf.end());
+
+        for (unsigned int k = 0; k < K; k++)
+        {
+            BOOST_REQUIRE(neighbors[k].second == bf[k]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(geometry_kdtree_range_visit)
+{
+    const int N = 2000;
+    const double radius = 0.2;
+    BOOST_TEST_MESSAGE("* Testing visitor-based range queries on " << N
+                       << " points");
+
+    // generate random points in the unit cube
+    srand(0);
+    std::vector<math::Point3> points;
+    for (int i = 0; i < N; i++)
+    {
+        points.emplace_back((double) rand() / RAND_MAX,
+                            (double) rand() / RAND_MAX,
+                            (double) rand() / RAND_MAX);
+    }
+
+    geometry::KdTree<math::Point3> kdtree(points.begin(), points.end());
+
+    for (int i = 0; i < N; i += 50)
+    {
+        // reference: materializing range query
+        auto reference(kdtree.range(points[i], radius));
+
+        // visitor must see the same points
+        std::size_t visited(0);
+        math::Point3 sum(0, 0, 0);
+        kdtree.rangeVisit(points[i], radius
+                          , [&](const math::Point3 &point, double) {
+                              ++visited;
+                              sum += point;
+                          });
+
+        BOOST_REQUIRE(visited == reference.size());
+        BOOST_REQUIRE(kdtree.rangeCount(points[i], radius)
+                      == reference.size());
+
+        std::array<double, 3> centroid;
+        BOOST_REQUIRE(kdtree.rangeCentroid(points[i], radius, centroid)
+                      == reference.size());
+        for (int axis = 0; axis < 3; axis++)
+        {
+            BOOST_CHECK_CLOSE(centroid[axis], sum(axis) / visited, 1e-9);
+        }
+    }
+}
 
     // TODO: test kdtree.nearest<false>
     // TODO: test const iterator version
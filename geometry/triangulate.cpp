@@ -24,11 +24,17 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <thread>
+
 #include "boost/polygon/voronoi.hpp"
 
 #include "dbglog/dbglog.hpp"
 
 #include "utility/gccversion.hpp"
+#include "utility/openmp.hpp"
 
 #include "triangulate.hpp"
 
@@ -208,23 +214,20 @@ public:
     }
 };
 
-} // namespace
-
-math::Triangles2d generalPolyTriangulate(const math::MultiPolygon &mpolygon)
+// Builds a voronoi diagram of the points and collects dual triangles
+// whose centroid lies inside the multipolygon and whose centroid x (in
+// converted coordinates) falls into [ownMin, ownMax) -- the half-open
+// window makes every triangle belong to exactly one strip in the
+// parallel mode.
+void voronoiTriangulate(const std::vector<bp::point_data<double> > &points,
+                        const CoordConverter &cnv,
+                        const math::MultiPolygon &mpolygon,
+                        double ownMin, double ownMax,
+                        math::Triangles2d &result)
 {
-    CoordConverter cnv(mpolygon);
-    std::vector<bp::point_data<double> > points;
-    for (const auto &poly : mpolygon) {
-        for (const auto &p : poly) {
-            points.emplace_back(cnv(p));
-        }
-    }
-
     bp::voronoi_diagram<double> voronoi;
     bp::construct_voronoi(points.begin(), points.end(), &voronoi);
 
-    math::Triangles2d result;
-
     // TODO: we should really do constrained Delaunay triangulation here to
     // make sure all required edges are contained in the output.
 
@@ -243,7 +246,9 @@ math::Triangles2d generalPolyTriangulate(const math::MultiPolygon &mpolygon)
             if (tri.size() == 3)
             {
                 math::Point2d c = (tri[0] + tri[1] + tri[2]) * (1.0 / 3);
-                if (pointInMultiPolygon(c, mpolygon))
+                double cx = cnv(c).x();
+                if (cx >= ownMin && cx < ownMax &&
+                    pointInMultiPolygon(c, mpolygon))
                 {
                     result.push_back({{tri[0], tri[1], tri[2]}});
                 }
@@ -254,6 +259,116 @@ math::Triangles2d generalPolyTriangulate(const math::MultiPolygon &mpolygon)
         }
         while (edge != vertex.incident_edge());
     }
+}
+
+} // namespace
+
+math::Triangles2d generalPolyTriangulate(const math::MultiPolygon &mpolygon)
+{
+    CoordConverter cnv(mpolygon);
+    std::vector<bp::point_data<double> > points;
+    for (const auto &poly : mpolygon) {
+        for (const auto &p : poly) {
+            points.emplace_back(cnv(p));
+        }
+    }
+
+    math::Triangles2d result;
+    voronoiTriangulate(points, cnv, mpolygon,
+                       -std::numeric_limits<double>::infinity(),
+                       +std::numeric_limits<double>::infinity(),
+                       result);
+    return result;
+}
+
+math::Triangles2d generalPolyTriangulateParallel(
+        const math::MultiPolygon &mpolygon, std::size_t maxThreads)
+{
+    CoordConverter cnv(mpolygon);
+    std::vector<bp::point_data<double> > points;
+    for (const auto &poly : mpolygon) {
+        for (const auto &p : poly) {
+            points.emplace_back(cnv(p));
+        }
+    }
+
+    std::size_t threads(maxThreads ? maxThreads :
+        std::max(1, int(std::thread::hardware_concurrency())));
+
+    // each strip must still hold a sizable population, otherwise the
+    // ghost bands dominate and the serial path wins
+    const std::size_t minStripPoints(1 << 14);
+    std::size_t nStrips(std::min(threads, points.size() / minStripPoints));
+
+    if (nStrips < 2) {
+        return generalPolyTriangulate(mpolygon);
+    }
+
+    // order points by x (ties broken by insertion order for determinism)
+    std::vector<std::size_t> order(points.size());
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) {
+                         return points[a].x() < points[b].x();
+                     });
+
+    // balanced strip boundaries at point-count quantiles; ownership is by
+    // x value, so cuts falling inside a run of equal x get merged
+    std::vector<double> cuts;
+    cuts.push_back(-std::numeric_limits<double>::infinity());
+    for (std::size_t s = 1; s < nStrips; s++) {
+        double cut(points[order[s * points.size() / nStrips]].x());
+        if (cut > cuts.back()) { cuts.push_back(cut); }
+    }
+    cuts.push_back(+std::numeric_limits<double>::infinity());
+    nStrips = cuts.size() - 1;
+
+    if (nStrips < 2) {
+        return generalPolyTriangulate(mpolygon);
+    }
+
+    std::vector<math::Triangles2d> stripResults(nStrips);
+
+    LOG(info1) << "Triangulating " << points.size() << " points in "
+               << nStrips << " strips.";
+
+    UTILITY_OMP(parallel for schedule( dynamic, 1 ))
+    for (int s = 0; s < int(nStrips); s++)
+    {
+        // owned range in sorted order
+        auto lo(std::lower_bound(
+                    order.begin(), order.end(), cuts[s],
+                    [&](std::size_t i, double x) {
+                        return points[i].x() < x;
+                    }) - order.begin());
+        auto hi(std::lower_bound(
+                    order.begin(), order.end(), cuts[s + 1],
+                    [&](std::size_t i, double x) {
+                        return points[i].x() < x;
+                    }) - order.begin());
+
+        // extend by a ghost band on both sides so that seam triangles
+        // are built identically in both adjacent strips
+        auto ghost(std::max<std::ptrdiff_t>(256, (hi - lo) / 8));
+        auto glo(std::max<std::ptrdiff_t>(0, lo - ghost));
+        auto ghi(std::min<std::ptrdiff_t>(order.size(), hi + ghost));
+
+        std::vector<bp::point_data<double> > stripPoints;
+        stripPoints.reserve(ghi - glo);
+        for (auto i(glo); i < ghi; i++) {
+            stripPoints.push_back(points[order[i]]);
+        }
+
+        voronoiTriangulate(stripPoints, cnv, mpolygon,
+                           cuts[s], cuts[s + 1], stripResults[s]);
+    }
+
+    // concatenate in strip order -- deterministic regardless of the
+    // thread schedule
+    math::Triangles2d result;
+    for (const auto &stripResult : stripResults) {
+        result.insert(result.end(), stripResult.begin(), stripResult.end());
+    }
     return result;
 }
 
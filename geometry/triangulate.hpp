@@ -50,6 +50,24 @@ math::Triangles2d simplePolyTriangulate(const math::Polygon &polygon);
  */
 math::Triangles2d generalPolyTriangulate(const math::MultiPolygon &mpolygon);
 
+/** Parallel variant of generalPolyTriangulate() for large inputs. The
+ *  points are split into balanced x-range strips, each strip (plus ghost
+ *  points from an overlap band on both sides) is triangulated
+ *  concurrently and a triangle is emitted by exactly the strip that owns
+ *  its centroid, so seams produce no duplicates. Strip results are
+ *  concatenated in strip order and each strip is processed
+ *  deterministically, making the output ordering stable between runs.
+ *
+ *  Seam triangles whose Delaunay neighborhood extends past the ghost
+ *  band may differ from the serial result; the band is sized generously
+ *  so this does not happen for reasonably uniform inputs. Small inputs
+ *  fall back to the serial path.
+ *
+ *  \param maxThreads limit on worker count; 0 means hardware concurrency
+ */
+math::Triangles2d generalPolyTriangulateParallel(
+        const math::MultiPolygon &mpolygon, std::size_t maxThreads = 0);
+
 
 } // namespace geometry
 
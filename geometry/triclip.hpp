@@ -217,5 +217,243 @@ ClipTriangle::list clipTriangles( const ClipTriangle::list &triangles
     return result;
 }
 
+/** Reusable triangle clipping workspace.
+ *
+ * Owns the ping-pong triangle and info buffers consumed by successive
+ * clipTriangles(workspace, plane) passes: a multi-plane clip then performs
+ * no per-plane list construction and a workspace held by the caller
+ * amortizes buffer capacity across whole clip calls.
+ */
+template <typename TriangleInfo = double>
+class ClipWorkspace {
+public:
+    ClipWorkspace() : current_(0) {}
+
+    /** Current triangle set: input of the next pass, output of the last.
+     */
+    ClipTriangle::list& triangles() { return triangles_[current_]; }
+    const ClipTriangle::list& triangles() const {
+        return triangles_[current_];
+    }
+
+    /** Per-triangle infos matching triangles(); empty when unused.
+     */
+    std::vector<TriangleInfo>& infos() { return infos_[current_]; }
+    const std::vector<TriangleInfo>& infos() const {
+        return infos_[current_];
+    }
+
+    /** Drop content from previous use; buffer capacity is retained.
+     */
+    void clear() {
+        triangles_[0].clear(); triangles_[1].clear();
+        infos_[0].clear(); infos_[1].clear();
+        current_ = 0;
+    }
+
+    /** Output buffers of the running pass.
+     */
+    ClipTriangle::list& scratchTriangles() {
+        return triangles_[current_ ^ 1];
+    }
+    std::vector<TriangleInfo>& scratchInfos() { return infos_[current_ ^ 1]; }
+
+    /** Make the scratch buffers current (finishes a clipping pass).
+     */
+    void flip() { current_ ^= 1; }
+
+private:
+    ClipTriangle::list triangles_[2];
+    std::vector<TriangleInfo> infos_[2];
+    unsigned int current_;
+};
+
+/** Clip workspace triangles with given plane, in place.
+ *
+ * Same semantics as clipTriangles() above with workspace.triangles() and
+ * workspace.infos() as input; the result replaces them without allocating
+ * fresh lists.
+ */
+template<typename TriangleInfo>
+void clipTriangles(ClipWorkspace<TriangleInfo> &workspace
+                   , const ClipPlane &plane)
+{
+    const auto &triangles(workspace.triangles());
+    const auto &triangleInfos(workspace.infos());
+    auto &result(workspace.scratchTriangles());
+    auto &resultInfo(workspace.scratchInfos());
+    result.clear();
+    resultInfo.clear();
+
+    if (triangleInfos.size() && triangleInfos.size()!=triangles.size()) {
+        LOGTHROW(err3, std::runtime_error)
+            << "Triangle count and triangle informations count mismatch.";
+    }
+
+    for ( std::size_t tid=0; tid<triangles.size(); ++tid)
+    {
+        auto &tri(triangles[tid]);
+
+        bool positive[3] = {
+            detail::signedDistance(tri.pos[0], plane) >= 0,
+            detail::signedDistance(tri.pos[1], plane) >= 0,
+            detail::signedDistance(tri.pos[2], plane) >= 0
+        };
+
+        int count = 0;
+        for (int i = 0; i < 3; i++) {
+            if (positive[i]) count++;
+        }
+
+        // triangle completely on negative side - do nothing
+        if (count == 0) continue;
+
+        // trinagle completely on positive side - copy to result
+        if (count == 3) {
+            result.push_back(tri);
+            if(triangleInfos.size()){
+                resultInfo.emplace_back(triangleInfos[tid]);
+            }
+            continue;
+        }
+
+        int a = 0, b = 0, c = 0;
+        double t = 0.0;
+
+        // case 1: one vertex on positive side, just adjust the other two
+        if (count == 1)
+        {
+            if (positive[0]) a = 0, b = 1, c = 2;
+            else if (positive[1]) a = 1, b = 2, c = 0;
+            else a = 2, b = 0, c = 1;
+
+            auto x1pos(detail::intersection(tri.pos[a], tri.pos[b], plane, t));
+            auto x1uv((1.0 - t)*tri.uv[a] + t*tri.uv[b]);
+
+            auto x2pos(detail::intersection(tri.pos[c], tri.pos[a], plane, t));
+            auto x2uv((1.0 - t)*tri.uv[c] + t*tri.uv[a]);
+
+            result.emplace_back(tri.pos[a], x1pos, x2pos,
+                                tri.uv[a],  x1uv,  x2uv);
+            if(triangleInfos.size()){
+                resultInfo.emplace_back(triangleInfos[tid]);
+            }
+        }
+        // case 2: two vertices on positive side, adjust triangle and add one more
+        else
+        {
+            if (!positive[0]) a = 0, b = 1, c = 2;
+            else if (!positive[1]) a = 1, b = 2, c = 0;
+            else a = 2, b = 0, c = 1;
+
+            auto tmp(1.0 - t);
+            auto x1pos(detail::intersection(tri.pos[a], tri.pos[b], plane, t));
+            auto x1uv(tmp*tri.uv[a] + t*tri.uv[b]);
+
+            auto x2pos(detail::intersection(tri.pos[c], tri.pos[a], plane, t));
+            auto x2uv(tmp*tri.uv[c] + t*tri.uv[a]);
+
+            result.emplace_back(x1pos, tri.pos[b], tri.pos[c],
+                                x1uv,  tri.uv[b],  tri.uv[c]);
+            if(triangleInfos.size()){
+                resultInfo.emplace_back(triangleInfos[tid]);
+            }
+
+            result.emplace_back(x1pos, tri.pos[c], x2pos,
+                                x1uv,  tri.uv[c],  x2uv);
+            if(triangleInfos.size()){
+                resultInfo.emplace_back(triangleInfos[tid]);
+            }
+        }
+    }
+
+    workspace.flip();
+}
+
+/** Clip workspace triangles with a whole set of planes in one batch pass.
+ *
+ * Instead of re-running the polygon-clipping machinery per plane over the
+ * full triangle list, each triangle is classified once against all planes
+ * (one dot product per vertex and plane): triangles fully on the positive
+ * side of every plane are copied straight to the output, triangles fully
+ * on the negative side of some plane are dropped, and only straddling
+ * triangles go through the per-plane clip. In typical tiling cuts the
+ * vast majority of faces is fully inside and pays only the
+ * classification cost.
+ *
+ * Output is equivalent to applying clipTriangles(workspace, plane) for
+ * each plane in order, up to the ordering of the output triangles.
+ */
+template<typename TriangleInfo>
+void clipTriangles(ClipWorkspace<TriangleInfo> &workspace
+                   , const std::vector<ClipPlane> &planes)
+{
+    const auto &triangles(workspace.triangles());
+    const auto &triangleInfos(workspace.infos());
+    auto &result(workspace.scratchTriangles());
+    auto &resultInfo(workspace.scratchInfos());
+    result.clear();
+    resultInfo.clear();
+
+    if (triangleInfos.size() && triangleInfos.size()!=triangles.size()) {
+        LOGTHROW(err3, std::runtime_error)
+            << "Triangle count and triangle informations count mismatch.";
+    }
+
+    // machinery for the straddling triangles; capacity is amortized over
+    // the whole batch
+    ClipWorkspace<TriangleInfo> straddling;
+
+    for ( std::size_t tid=0; tid<triangles.size(); ++tid)
+    {
+        auto &tri(triangles[tid]);
+
+        bool inside(true), outside(false);
+        for (const auto &plane : planes)
+        {
+            int count = 0;
+            for (int i = 0; i < 3; i++) {
+                if (detail::signedDistance(tri.pos[i], plane) >= 0) {
+                    count++;
+                }
+            }
+
+            // all vertices on negative side of some plane - triangle is
+            // gone, no need to check the remaining planes
+            if (count == 0) { outside = true; break; }
+
+            if (count < 3) { inside = false; }
+        }
+
+        if (outside) { continue; }
+
+        if (inside) {
+            result.push_back(tri);
+            if(triangleInfos.size()){
+                resultInfo.emplace_back(triangleInfos[tid]);
+            }
+            continue;
+        }
+
+        // straddling triangle - run the full per-plane clip on it
+        straddling.clear();
+        straddling.triangles().push_back(tri);
+        if(triangleInfos.size()){
+            straddling.infos().emplace_back(triangleInfos[tid]);
+        }
+
+        for (const auto &plane : planes) {
+            clipTriangles(straddling, plane);
+        }
+
+        result.insert(result.end(), straddling.triangles().begin()
+                      , straddling.triangles().end());
+        resultInfo.insert(resultInfo.end(), straddling.infos().begin()
+                          , straddling.infos().end());
+    }
+
+    workspace.flip();
+}
+
 } // namespace geometry
 #endif // geometry_triclip_hpp_included_
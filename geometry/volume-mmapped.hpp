@@ -0,0 +1,435 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ *  @file volume-mmapped.hpp
+ *
+ *  Out-of-core volume container backed by a memory-mapped block file.
+ *
+ *  VolumeBlockFile stores materialized blocks in fixed-size records of
+ *  a scratch file instead of the heap, with an in-memory block
+ *  directory and an LRU over mapped file slabs bounding how much of the
+ *  file is resident at once. It plugs into GeoVolume_t/ScalarField_t as
+ *  Container_t, so downscaling, distance sweeps and isosurface
+ *  extraction run unchanged on volumes 10-50x larger than RAM.
+ *
+ *  Blocks are allocated in the file in first-touch order; plane-by-plane
+ *  sweeps therefore read and write the file sequentially and the LRU
+ *  only ever holds the active working set. Uniform blocks stay elided in
+ *  the directory (as in VolumeTileGrid) and never touch the file at all.
+ *
+ *  Needs Boost.IOStreams (GEOMETRY_HAS_BIO).
+ */
+
+#ifndef geometry_volume_mmapped_hpp_included_
+#define geometry_volume_mmapped_hpp_included_
+
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <unordered_map>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <dbglog/dbglog.hpp>
+
+#include "volume.hpp"
+
+namespace geometry {
+
+template <typename Value_t>
+class VolumeBlockFile : public VolumeContainer<Value_t> {
+public:
+    typedef typename VolumeContainer<Value_t>::ValueType ValueType;
+    typedef typename VolumeContainer<Value_t>::Position_s Position_s;
+    typedef typename VolumeContainer<Value_t>::Displacement_s Displacement_s;
+    typedef typename VolumeContainer<Value_t>::BorderType BorderType;
+
+    struct Options {
+        /** Where scratch files are created; empty means the system
+         *  temporary directory.
+         */
+        boost::filesystem::path backingDir;
+
+        /** Upper bound on mapped (resident) file slabs, in bytes.
+         */
+        std::size_t residentLimit;
+
+        Options() : residentLimit(std::size_t(1) << 30) {}
+    };
+
+    /** Process-wide defaults, used by the GeoVolume_t-compatible
+     *  constructor below (volume constructors cannot pass a path
+     *  through). Adjust once before building out-of-core volumes.
+     */
+    static Options& defaultOptions() {
+        static Options options;
+        return options;
+    }
+
+    /** Container_t-compatible constructor: backs the volume by a
+     *  unique scratch file under defaultOptions().backingDir; the file
+     *  is removed on destruction.
+     */
+    VolumeBlockFile( const int sizeX, const int sizeY, const int sizeZ
+                   , const Value_t & initValue
+                   , const math::Size3i & capacity = math::Size3i()
+                   , const math::Point3i & offset = math::Point3i()
+                   , const BorderType & border
+                         = BorderType::BORDER_CONSTANT );
+
+    /** Explicit backing file; the (truncated) file is left in place on
+     *  destruction.
+     */
+    VolumeBlockFile( const boost::filesystem::path & path
+                   , const Options & options
+                   , const int sizeX, const int sizeY, const int sizeZ
+                   , const Value_t & initValue
+                   , const math::Size3i & capacity = math::Size3i()
+                   , const math::Point3i & offset = math::Point3i()
+                   , const BorderType & border
+                         = BorderType::BORDER_CONSTANT );
+
+    VolumeBlockFile( const VolumeBlockFile & ) = delete;
+
+    VolumeBlockFile & operator=( const VolumeBlockFile & ) = delete;
+
+    VolumeBlockFile( VolumeBlockFile && ) = default;
+
+    VolumeBlockFile & operator=( VolumeBlockFile && ) = default;
+
+    ~VolumeBlockFile();
+
+    Value_t get( int i, int j, int k ) const;
+
+    void set( int i, int j, int k, const Value_t & value );
+
+    void grow(const int axis, bool front = false) {
+        (void) axis; (void) front;
+        LOGTHROW(err2, std::runtime_error)
+            << "Grow not implemented for block file.";
+    }
+
+    /** A block falling into a single elided tile is constant. */
+    bool constantBlock( int i, int j, int k, int size
+                      , Value_t & value ) const;
+
+    /** Unmaps every resident slab, pushing all modified blocks to the
+     *  backing file; subsequent access maps them back on demand.
+     */
+    void flushResident() const;
+
+    /** Number of blocks materialized in the backing file. */
+    std::size_t blockCount() const { return slotCount_; }
+
+    /** Bytes of the backing file currently mapped. */
+    std::size_t residentBytes() const { return residentBytes_; }
+
+protected:
+    const static int blockBits = 5;
+    const static int blockSize = 1 << blockBits;
+    const static int blockMask = blockSize - 1;
+    const static int blockVolume = blockSize * blockSize * blockSize;
+
+    const static std::uint32_t npos = 0xffffffffu;
+
+    /** Directory entry: constant value until materialized, then the
+     *  index of the block's record in the backing file.
+     */
+    struct Block_s {
+        Value_t value;
+        std::uint32_t slot;
+
+        Block_s( const Value_t & value ) : value( value ), slot( npos ) {}
+    };
+
+    std::size_t blockIndex( int bi, int bj, int bk ) const {
+        return std::size_t(bk) + std::size_t(bj) * bSize_(2)
+            + std::size_t(bi) * bSize_(2) * bSize_(1);
+    }
+
+    static std::size_t cellIndex( int ci, int cj, int ck ) {
+        return std::size_t(ck & blockMask)
+            + (std::size_t(cj & blockMask) << blockBits)
+            + (std::size_t(ci & blockMask) << (2 * blockBits));
+    }
+
+    /** Mapped window of slabBlocks_ consecutive block records. */
+    struct Slab_s {
+        std::size_t index;
+        boost::iostreams::mapped_file file;
+    };
+
+    typedef std::list<Slab_s> SlabList;
+
+    void openBackingFile();
+
+    /** Resident pointer to a materialized block, mapping (and possibly
+     *  evicting) slabs as needed. Touches the LRU, hence const via
+     *  mutable residency state.
+     */
+    Value_t* blockData( std::uint32_t slot ) const;
+
+    math::Size3i bSize_;
+    std::vector<Block_s> blocks_;
+
+    boost::filesystem::path path_;
+    Options options_;
+    bool ownedFile_;
+
+    std::uint32_t slotCount_;
+    std::size_t slabBlocks_, slabBytes_;
+    mutable std::uint64_t fileSize_;
+
+    /** front = most recently used */
+    mutable SlabList lru_;
+    mutable std::unordered_map<std::size_t, typename SlabList::iterator>
+        resident_;
+    mutable std::size_t residentBytes_;
+};
+
+/* implementation */
+
+template <typename Value_t>
+VolumeBlockFile<Value_t>::VolumeBlockFile( const int sizeX
+                    , const int sizeY, const int sizeZ
+                    , const Value_t & initValue
+                    , const math::Size3i & capacity
+                    , const math::Point3i & offset
+                    , const BorderType & border )
+    : VolumeBlockFile( boost::filesystem::path(), defaultOptions()
+                     , sizeX, sizeY, sizeZ, initValue
+                     , capacity, offset, border )
+{}
+
+template <typename Value_t>
+VolumeBlockFile<Value_t>::VolumeBlockFile(
+                      const boost::filesystem::path & path
+                    , const Options & options
+                    , const int sizeX, const int sizeY, const int sizeZ
+                    , const Value_t & initValue
+                    , const math::Size3i & capacity
+                    , const math::Point3i & offset
+                    , const BorderType & border )
+    : VolumeContainer<Value_t>( sizeX, sizeY, sizeZ, initValue
+                              , capacity, offset, border)
+    , bSize_( (sizeX + blockMask) >> blockBits
+            , (sizeY + blockMask) >> blockBits
+            , (sizeZ + blockMask) >> blockBits )
+    , path_( path ), options_( options ), ownedFile_( path.empty() )
+    , slotCount_( 0 ), fileSize_( 0 ), residentBytes_( 0 )
+{
+    if (this->capacity_ != this->size_) {
+        LOGTHROW(err2, std::runtime_error)
+                << "Capacity handling not implemented in block file.";
+    }
+
+    const std::size_t blockBytes( blockVolume * sizeof(Value_t) );
+
+    // slabs of roughly 64 MiB, rounded up to a mappable offset multiple
+    slabBlocks_ = std::max<std::size_t>
+        ( 1, (std::size_t(1) << 26) / blockBytes );
+    const std::size_t alignment
+        ( boost::iostreams::mapped_file::alignment() );
+    while ((slabBlocks_ * blockBytes) % alignment) { ++slabBlocks_; }
+    slabBytes_ = slabBlocks_ * blockBytes;
+
+    const std::size_t nBlocks( std::size_t(bSize_(0))
+                             * bSize_(1) * bSize_(2) );
+    blocks_.reserve( nBlocks );
+    for ( std::size_t b(0); b < nBlocks; ++b ) {
+        blocks_.push_back( Block_s( initValue ) );
+    }
+
+    openBackingFile();
+}
+
+template <typename Value_t>
+VolumeBlockFile<Value_t>::~VolumeBlockFile() {
+    // unmapping flushes; scratch files are ours to remove
+    lru_.clear();
+    resident_.clear();
+
+    if ( ownedFile_ && !path_.empty() ) {
+        boost::system::error_code ec;
+        boost::filesystem::remove( path_, ec );
+    }
+}
+
+template <typename Value_t>
+void VolumeBlockFile<Value_t>::openBackingFile() {
+    namespace fs = boost::filesystem;
+
+    if ( path_.empty() ) {
+        const fs::path dir( options_.backingDir.empty()
+                            ? fs::temp_directory_path()
+                            : options_.backingDir );
+        path_ = dir / fs::unique_path
+            ( "geometry-volume-%%%%%%%%.blk" );
+    }
+
+    std::ofstream f( path_.string().c_str()
+                   , std::ios::binary | std::ios::trunc );
+    if ( !f ) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Cannot create volume backing file " << path_ << ".";
+    }
+    f.close();
+
+    LOG(info1) << "Volume backed by block file " << path_
+               << " (slab " << slabBytes_ << " B, resident limit "
+               << options_.residentLimit << " B).";
+}
+
+template <typename Value_t>
+Value_t* VolumeBlockFile<Value_t>::blockData( std::uint32_t slot ) const {
+    namespace bio = boost::iostreams;
+
+    const std::size_t slab( slot / slabBlocks_ );
+
+    auto fresident( resident_.find( slab ) );
+    if ( fresident != resident_.end() ) {
+        // keep hot slabs at the front
+        lru_.splice( lru_.begin(), lru_, fresident->second );
+    } else {
+        // the file never shrinks, grow it to cover the whole slab
+        const std::uint64_t needed( std::uint64_t(slab + 1) * slabBytes_ );
+        if ( fileSize_ < needed ) {
+            boost::filesystem::resize_file( path_, needed );
+            fileSize_ = needed;
+        }
+
+        bio::mapped_file_params params( path_.string() );
+        params.flags = bio::mapped_file::readwrite;
+        params.length = slabBytes_;
+        params.offset = bio::stream_offset( slab * std::uint64_t(slabBytes_) );
+
+        lru_.push_front( Slab_s() );
+        lru_.front().index = slab;
+        lru_.front().file.open( params );
+        if ( !lru_.front().file.is_open() ) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Cannot map slab " << slab << " of " << path_ << ".";
+        }
+        resident_.insert( { slab, lru_.begin() } );
+        residentBytes_ += slabBytes_;
+
+        // evict cold slabs, never the one just mapped
+        while ( ( residentBytes_ > options_.residentLimit )
+                && ( lru_.size() > 1 ) ) {
+            resident_.erase( lru_.back().index );
+            lru_.pop_back();
+            residentBytes_ -= slabBytes_;
+        }
+    }
+
+    char *base( lru_.front().file.data() );
+    return reinterpret_cast<Value_t*>
+        ( base + ( slot % slabBlocks_ )
+          * ( blockVolume * sizeof(Value_t) ) );
+}
+
+template <typename Value_t>
+void VolumeBlockFile<Value_t>::flushResident() const {
+    lru_.clear();
+    resident_.clear();
+    residentBytes_ = 0;
+}
+
+template <typename Value_t>
+Value_t VolumeBlockFile<Value_t>::get( int i, int j, int k ) const {
+    const auto & size_(this->size_);
+
+    if ( this->border_ == BorderType::BORDER_CONSTANT
+       && ( i < 0 || i >= size_(0)
+         || j < 0 || j >= size_(1)
+         || k < 0 || k >= size_(2) ))
+    {
+        return this->initValue_;
+    }
+
+    int ci(std::min(std::max(i,0), size_(0) - 1)),
+        cj(std::min(std::max(j,0), size_(1) - 1)),
+        ck(std::min(std::max(k,0), size_(2) - 1));
+
+    const Block_s & block( blocks_[ blockIndex( ci >> blockBits
+                                              , cj >> blockBits
+                                              , ck >> blockBits ) ] );
+    if ( block.slot == npos ) { return block.value; }
+
+    return blockData( block.slot )[ cellIndex( ci, cj, ck ) ];
+}
+
+template <typename Value_t>
+void VolumeBlockFile<Value_t>::set( int i, int j, int k
+                                  , const Value_t & value ) {
+    const auto & size_(this->size_);
+    if ( i < 0 || i >= size_(0) || j < 0
+       || j >= size_(1) || k < 0 || k >= size_(2) )
+    {
+        return;
+    }
+
+    Block_s & block( blocks_[ blockIndex( i >> blockBits
+                                        , j >> blockBits
+                                        , k >> blockBits ) ] );
+
+    if ( block.slot == npos ) {
+        if ( block.value == value ) { return; }
+
+        // materialize constant block into a fresh file record
+        block.slot = slotCount_++;
+        Value_t *data( blockData( block.slot ) );
+        std::fill( data, data + blockVolume, block.value );
+        data[ cellIndex( i, j, k ) ] = value;
+        return;
+    }
+
+    blockData( block.slot )[ cellIndex( i, j, k ) ] = value;
+}
+
+template <typename Value_t>
+bool VolumeBlockFile<Value_t>::constantBlock( int i, int j, int k, int size
+                                            , Value_t & value ) const {
+    // the whole block must fall into a single tile
+    if ( ( i >> blockBits ) != ( ( i + size - 1 ) >> blockBits )
+      || ( j >> blockBits ) != ( ( j + size - 1 ) >> blockBits )
+      || ( k >> blockBits ) != ( ( k + size - 1 ) >> blockBits ) ) {
+        return false;
+    }
+
+    const Block_s & block( blocks_[ blockIndex( i >> blockBits
+                                              , j >> blockBits
+                                              , k >> blockBits ) ] );
+    if ( block.slot != npos ) { return false; }
+
+    value = block.value;
+    return true;
+}
+
+} // namespace geometry
+
+#endif // geometry_volume_mmapped_hpp_included_
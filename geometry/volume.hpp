@@ -42,6 +42,8 @@
 #include "dbglog/dbglog.hpp"
 #include "geometry/pointcloud.hpp"
 #include "geometry/mesh.hpp"
+#include "geometry/pointindex.hpp"
+#include "geometry/perfcounters.hpp"
 #include <memory>
 #include "utility/progress.hpp"
 #include "utility/openmp.hpp"
@@ -54,7 +56,10 @@
 #include "geometry/detail/volume.mcubes.hpp"
 
 #include <boost/foreach.hpp>
+#include <cstdint>
 #include <set>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 //#include <opencv2/opencv.hpp>
 
@@ -315,6 +320,19 @@ public:
         return old;
     }
 
+    const Value_t & initValue() const { return initValue_; }
+
+    /** Constant-block query: returns true and fills value when the aligned
+     *  block [i,i+size) x [j,j+size) x [k,k+size) is known to hold a single
+     *  value. A dense container cannot tell without scanning, so the
+     *  default answers false; sparse containers override this at their
+     *  node granularity. False negatives are allowed, false positives are
+     *  not.
+     */
+    bool constantBlock( int, int, int, int, Value_t & ) const {
+        return false;
+    }
+
 protected:
     math::Size3i size_, capacity_;
     math::Point3i offset_;
@@ -322,6 +340,14 @@ protected:
     BorderType border_;
 };
 
+/** Dense volume container backed by a flat std::vector.
+ *
+ * Thread-safety guarantee: get() and set() touch only the addressed
+ * cell, so concurrent access to distinct cells from multiple threads
+ * is safe (no internal locking or lazy allocation). Structural
+ * operations (grow(), assignment) must not run concurrently with
+ * anything else.
+ */
 template <typename Value_t>
 class VolumeArray : public VolumeContainer<Value_t> {
 public:
@@ -343,10 +369,106 @@ public:
 
     void grow(const int axis, bool front = false);
 
+    /** Raw storage access for scanline algorithms (see scanlineSpan()).
+     *  Cell (i,j,k) lives at rawIndex(i,j,k); cells adjacent along axis
+     *  a are rawStride(a) elements apart. The z axis is the fastest
+     *  (unit stride), y and x follow at capacity granularity. No bounds
+     *  checking and no border handling -- callers stay inside the
+     *  volume proper.
+     */
+    Value_t * rawData() { return data.data(); }
+    const Value_t * rawData() const { return data.data(); }
+
+    std::size_t rawStride( int axis ) const {
+        const auto & capacity_(this->capacity_);
+        switch (axis) {
+        case 0: return std::size_t(capacity_(2)) * capacity_(1);
+        case 1: return std::size_t(capacity_(2));
+        default: return 1;
+        }
+    }
+
+    std::size_t rawIndex( int i, int j, int k ) const {
+        const auto & offset_(this->offset_);
+        return std::size_t(k + offset_(2))
+             + std::size_t(j + offset_(1)) * rawStride(1)
+             + std::size_t(i + offset_(0)) * rawStride(0);
+    }
+
 private:
     std::vector<Value_t> data;
 };
 
+/** Marks containers whose get()/set() may be called concurrently on
+ *  distinct cells. Scanline-parallel algorithms consult this trait to
+ *  decide whether to dispatch across threads.
+ */
+template <typename Container_t>
+struct VolumeContainerThreadSafe : std::false_type {};
+
+template <typename Value_t>
+struct VolumeContainerThreadSafe<VolumeArray<Value_t>> : std::true_type {};
+
+/** Raw view of one scanline in a dense container: a pointer to the
+ *  first cell plus a constant element stride. Offers the same
+ *  operator[] interface as Giterator_t, but dereferencing is plain
+ *  pointer arithmetic with no per-cell get()/set() call, so inner
+ *  loops walking a span vectorize.
+ */
+template <typename Value_t>
+struct VolumeSpan_t {
+    Value_t *data;
+    std::ptrdiff_t stride;
+
+    VolumeSpan_t() : data(nullptr), stride(0) {}
+    VolumeSpan_t( Value_t *data, std::ptrdiff_t stride )
+        : data(data), stride(stride) {}
+
+    bool valid() const { return data != nullptr; }
+
+    Value_t & operator[] ( int i ) const {
+        return data[ std::ptrdiff_t(i) * stride ];
+    }
+};
+
+/** Scanline raw access. A generic container exposes no raw storage, so
+ *  the generic overload returns an invalid span and callers fall back
+ *  to the per-cell get()/set() path.
+ */
+template <typename Value_t, class Container_t>
+VolumeSpan_t<Value_t> scanlineSpan(
+    const Giterator_t<Value_t, Container_t> & ) {
+    return VolumeSpan_t<Value_t>();
+}
+
+/** VolumeArray overload: for a unit-axis displacement the iterator's
+ *  whole scanline lives at a constant stride in the flat backing
+ *  vector (unit stride along z, the fastest axis), so it can be
+ *  exposed as a raw span. Any other displacement yields an invalid
+ *  span.
+ */
+template <typename Value_t>
+VolumeSpan_t<Value_t> scanlineSpan(
+    const Giterator_t<Value_t, VolumeArray<Value_t>> & it ) {
+    typedef typename VolumeBase_t::Displacement_s Displacement_s;
+
+    int axis;
+    if ( it.diff == Displacement_s( 1, 0, 0 ) ) {
+        axis = 0;
+    } else if ( it.diff == Displacement_s( 0, 1, 0 ) ) {
+        axis = 1;
+    } else if ( it.diff == Displacement_s( 0, 0, 1 ) ) {
+        axis = 2;
+    } else {
+        return VolumeSpan_t<Value_t>();
+    }
+
+    return VolumeSpan_t<Value_t>(
+        it.volume->rawData()
+            + it.volume->rawIndex( it.pos.x, it.pos.y, it.pos.z ),
+        std::ptrdiff_t(it.volume->rawStride( axis )) );
+}
+
 
 template <typename Value_t>
 class VolumeOctree : public VolumeContainer<Value_t>{
@@ -385,6 +507,12 @@ public:
             << "Grow not implemented for octree.";
     }
 
+    /** A block inside a SOLID node is constant; answers at octree node
+     *  granularity (size must be a power of two, the block aligned to it).
+     */
+    bool constantBlock( int i, int j, int k, int size
+                      , Value_t & value ) const;
+
     uint nodeCount();
     uint memUsed();
 
@@ -432,6 +560,88 @@ protected:
 };
 
 
+/** Flat two-level tile grid container. The volume is split into dense
+ *  16^3 blocks referenced from a dense block directory; blocks holding a
+ *  single value everywhere are elided to just that value (the state every
+ *  block starts in). get/set is a single directory lookup instead of an
+ *  octree descent, while memory stays proportional to the non-uniform
+ *  part of the volume — the sweet spot for mostly-uniform distance
+ *  fields too large for VolumeArray.
+ */
+template <typename Value_t>
+class VolumeTileGrid : public VolumeContainer<Value_t>{
+public:
+    typedef typename VolumeContainer<Value_t>::ValueType ValueType;
+    typedef typename VolumeContainer<Value_t>::Position_s Position_s;
+    typedef typename VolumeContainer<Value_t>::Displacement_s Displacement_s;
+    typedef typename VolumeContainer<Value_t>::BorderType BorderType;
+
+    VolumeTileGrid( const int sizeX, const int sizeY, const int sizeZ
+                  , const Value_t & initValue
+                  , const math::Size3i & capacity = math::Size3i()
+                  , const math::Point3i & offset = math::Point3i()
+                  , const BorderType & border
+                        = BorderType::BORDER_CONSTANT );
+
+    VolumeTileGrid( const VolumeTileGrid&) = delete;
+
+    VolumeTileGrid & operator=(const VolumeTileGrid&) = delete;
+
+    VolumeTileGrid( VolumeTileGrid &&) = default;
+
+    VolumeTileGrid& operator=(VolumeTileGrid &&) = default;
+
+    Value_t get( int i, int j, int k ) const;
+
+    void set( int i, int j, int k, const Value_t & value );
+
+    void grow(const int axis, bool front = false) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Grow not implemented for tile grid.";
+    }
+
+    /** Re-elide blocks that became uniform again after being
+     *  materialized by set(). Worth calling once after a write-heavy
+     *  phase (e.g. distance sweeps) to give memory back.
+     */
+    void compact();
+
+    /** A block falling into a single elided tile is constant. */
+    bool constantBlock( int i, int j, int k, int size
+                      , Value_t & value ) const;
+
+    uint blockCount() const;
+    uint memUsed() const;
+
+protected:
+    const static int blockBits = 4;
+    const static int blockSize = 1 << blockBits;
+    const static int blockMask = blockSize - 1;
+    const static int blockVolume = blockSize * blockSize * blockSize;
+
+    struct Block_s {
+        Value_t value;                    // constant value if data empty
+        std::unique_ptr<Value_t[]> data;  // dense block when materialized
+
+        Block_s( const Value_t & value ) : value( value ) {}
+    };
+
+    std::size_t blockIndex( int bi, int bj, int bk ) const {
+        return std::size_t(bk) + std::size_t(bj) * bSize_(2)
+            + std::size_t(bi) * bSize_(2) * bSize_(1);
+    }
+
+    static std::size_t cellIndex( int ci, int cj, int ck ) {
+        return std::size_t(ck & blockMask)
+            + (std::size_t(cj & blockMask) << blockBits)
+            + (std::size_t(ci & blockMask) << (2 * blockBits));
+    }
+
+    math::Size3i bSize_;
+    std::vector<Block_s> blocks_;
+};
+
+
 template <typename Value_t, typename Volume_t>
 class VolumeProxy : public VolumeContainer<Value_t>
 {
@@ -509,6 +719,21 @@ public :
     void fset( const double x, const double y, const double z,
         const Value_t & value );
 
+    /** Fused binary operation with another volume over the same grid:
+     *  result(i,j,k) = op(this(i,j,k), other(i,j,k)) -- e.g. std::min
+     *  for an SDF union, std::max for an intersection. Iterates in
+     *  aligned blocks and consults constantBlock() on both inputs: where
+     *  both sides are constant the operator runs once per block, and
+     *  blocks whose result equals the result volume's initial value are
+     *  skipped outright. For mostly-uniform fields only the mixed blocks
+     *  pay per-voxel call cost. The result volume is expected to be
+     *  freshly constructed (cells holding its initial value).
+     */
+    template <class Container2_t, class ContainerOut_t, typename Op>
+    void combine( const GeoVolume_t<Value_t, Container2_t> & other
+                , GeoVolume_t<Value_t, ContainerOut_t> & result
+                , const Op & op ) const;
+
     /** Find corresponding grid position. Default rounding (0) is closest
      * grid point (0), -1 specifies floor, 1 ceiling */
     Position_s geo2grid(
@@ -631,7 +856,61 @@ public :
           , const IsosurfaceAlgorithm_t algorithm = M_CUBES
           , const boost::optional<math::Extents3> &ext = boost::none);
 
+    /**
+     * Extract isosurface with marching cubes, slab by slab along the z
+     * axis. The volume is partitioned into z-slabs of slabThickness
+     * voxels; cubes of each slab are extracted in parallel, welded into a
+     * standalone indexed mesh and handed over to the sink as
+     * sink(geometry::Mesh&&, int k0, int k1) before the next slab starts.
+     * Peak memory is therefore bounded by the largest slab, not by the
+     * whole isosurface. Vertices on the plane shared by two consecutive
+     * slabs come out bit identical, so a sink that needs one connected
+     * mesh may weld slabs together by exact coordinate match.
+     */
+    template <typename MeshSink>
+    void isosurfaceCubesStreamed(
+            const Value_t & threshold
+          , const SurfaceOrientation_t orientation
+          , int slabThickness
+          , const MeshSink & sink );
+
+    /**
+     * Extract isosurface with marching cubes directly into an indexed
+     * mesh. Vertices shared along cell edges are welded on the fly via
+     * an edge-keyed hash, so the triangle soup and the coordinate-based
+     * welding pass of isosurfaceAsMesh are skipped entirely and peak
+     * memory is roughly halved. A pre-scan over the volume counts the
+     * output triangles, so all containers are reserved up front.
+     *
+     * Unlike the coordinate weld, the edge keys do not merge vertices
+     * from distinct edges that happen to interpolate to the same point
+     * (isosurface passing exactly through a cell corner); such meshes
+     * may contain a few duplicated vertices. Extraction is single
+     * threaded; prefer isosurfaceAsMesh when CPU-bound rather than
+     * memory-bound.
+     */
+    geometry::Mesh isosurfaceCubesIndexed(
+            const Value_t & threshold
+          , const SurfaceOrientation_t orientation = TO_MIN
+          , const boost::optional<math::Extents3> &ext = boost::none );
+
 private:
+    /** Marching cubes pass over cubes with z index in [k0, k1). */
+    std::vector<FPosition_s> isosurfaceCubesRange(
+            const Value_t & threshold,
+            const SurfaceOrientation_t orientation,
+            int k0, int k1,
+            const boost::optional<math::Extents3> &ext ) const;
+
+    /** Gathers the geo positions and values of the eight corners of the
+     *  cube at (i,j,k) in marching cubes vertex order. */
+    void cubeCorners( int i, int j, int k,
+                      FPosition_s * vertices, Value_t * values ) const;
+
+    /** Marching cubes case code of a cube; zero bits outside. */
+    int cubeCode( const Value_t * values, const Value_t & threshold,
+                  const SurfaceOrientation_t orientation ) const;
+
     void isoFromCube(
             std::vector<FPosition_s> & retval
             , const FPosition_s * vertices
@@ -687,16 +966,24 @@ public:
      * Create distance map from a bitfield. InitValue corresponds to the
      * maximum distance (infty). The lower this value, the more efficient
      * the memory representation.
+     *
+     * When parallel is set the sweeps run multi-threaded over a dense
+     * scratch field: z propagation goes plane by plane with rows
+     * distributed over threads, the in-plane xy propagation runs over
+     * whole planes in parallel. The result may differ from the serial
+     * scan within the usual 4SED approximation error, as the passes are
+     * no longer interleaved plane by plane.
      */
-    DistanceMap_t( const Bitfield_t & bitfield, const Value_t initValue );
+    DistanceMap_t( const Bitfield_t & bitfield, const Value_t initValue,
+                   bool parallel = false );
 
     /**
      * Create distance map from a pointcloud. InitValue corresponds to the
      * maximum distance (infty). The lower this value, the more efficient
-     * the memory representation.
+     * the memory representation. See above for the parallel mode.
      */
     DistanceMap_t( const PointCloud & cloud, float voxelSize,
-                   const Value_t initValue );
+                   const Value_t initValue, bool parallel = false );
 
 
 private:
@@ -746,26 +1033,43 @@ private:
         DistVectorField_t( int sizeX, int sizeY, int sizeZ,
             const DistVector_s & infty ) : VolumeOctree<DistVector_s>( sizeX,
             sizeY, sizeZ, infty ) {}
+    };
 
-        void set( const int x, const int y, const int z,
-              const DistVector_s & value ) {
-            DistVector_s oval = this->get( x, y, z );
-            if ( oval != value )
-                std::cout << "( " << x << ", " << y << ", " << z << ") <- ("
-                << value.distX << ", " << value.distY << ", " << value.distZ <<
-                " )\n";
-            VolumeOctree<DistVector_s>::set( x, y, z, value );
-        }
+    /** Dense scratch field for the parallel sweeps; the octree is not
+     *  safe for concurrent set() and its nodes would be split apart by
+     *  the propagation anyway. */
+    class DenseDistVectorField_t: public VolumeArray<DistVector_s> {
+
+    public:
+
+        DenseDistVectorField_t( int sizeX, int sizeY, int sizeZ,
+            const DistVector_s & infty ) : VolumeArray<DistVector_s>( sizeX,
+            sizeY, sizeZ, infty ) {}
     };
 
     typedef enum { ASC, DESC } Scandir_t;
 
-    static void scanXLine( DistVectorField_t & dvField,
+    template <class DVField>
+    static void seedBitfield( const Bitfield_t & bitfield,
+        DVField & dvField );
+    template <class DVField>
+    void seedCloud( const PointCloud & cloud, DVField & dvField );
+
+    template <class DVField>
+    static void scanXLine( DVField & dvField,
         int j, int k, const Scandir_t scandir );
-    static void scanXYPlane( DistVectorField_t & dvField,
+    template <class DVField>
+    static void scanXYPlane( DVField & dvField,
         int k, const Scandir_t scandir );
-    static void scanVolume( DistVectorField_t & dvField,
+    template <class DVField>
+    static void scanVolumeParallel( DVField & dvField,
         const Scandir_t scandir );
+
+    /** Shared tail of the constructors: runs the sweeps over the seeded
+     *  vector field and collects the scalar distances. */
+    template <class DVField>
+    void computeFrom( DVField & dvField, const Value_t & initValue,
+        bool parallel );
 };
 
 /** Class BitfieldReconstruction_t performs a volumetric reconstruction of
@@ -1179,6 +1483,32 @@ void VolumeOctree<Value_t>::set( int i, int j, int k, const Value_t & value ) {
     _root->set( _rootSize, Position_s( i, j, k ), value );
 }
 
+template <typename Value_t>
+bool VolumeOctree<Value_t>::constantBlock( int i, int j, int k, int size
+                                         , Value_t & value ) const {
+    Node_s * node( _root.get() );
+    int nodeSize( _rootSize );
+    Position_s pos( i, j, k );
+
+    for ( ;; ) {
+        if ( node->type == Node_s::SOLID ) {
+            value = node->value;
+            return true;
+        }
+
+        // gray node as fine as the block itself - not constant
+        if ( nodeSize <= size ) { return false; }
+
+        // aligned blocks smaller than the node fit into a single octant
+        typename Node_s::Octant_t octant(
+            node->findOctant( nodeSize, pos ) );
+
+        pos = node->toOctant( octant, nodeSize, pos );
+        node = node->subnodes[ octant ];
+        nodeSize >>= 1;
+    }
+}
+
 /* class VolumeOctree<Value_t>::Node_s */
 
 template <typename Value_t>
@@ -1281,6 +1611,135 @@ void VolumeOctree<Value_t>::Node_s::set( int nodeSize, const Position_s & pos,
     }
 }
 
+/* class VolumeTileGrid<Value_t> */
+
+template <typename Value_t>
+VolumeTileGrid<Value_t>::VolumeTileGrid( const int sizeX
+                    , const int sizeY, const int sizeZ
+                    , const Value_t & initValue
+                    , const math::Size3i & capacity
+                    , const math::Point3i & offset
+                    , const BorderType & border )
+    : VolumeContainer<Value_t>( sizeX, sizeY, sizeZ, initValue
+                              , capacity, offset, border)
+    , bSize_( (sizeX + blockMask) >> blockBits
+            , (sizeY + blockMask) >> blockBits
+            , (sizeZ + blockMask) >> blockBits )
+{
+    if (this->capacity_ != this->size_) {
+        LOGTHROW(err2, std::runtime_error)
+                << "Capacity handling not implemented in tile grid.";
+    }
+
+    const std::size_t nBlocks( std::size_t(bSize_(0))
+                             * bSize_(1) * bSize_(2) );
+    blocks_.reserve( nBlocks );
+    for ( std::size_t b(0); b < nBlocks; ++b ) {
+        blocks_.push_back( Block_s( initValue ) );
+    }
+}
+
+template <typename Value_t>
+Value_t VolumeTileGrid<Value_t>::get( int i, int j, int k ) const {
+    const auto & size_(this->size_);
+
+    if ( this->border_ == BorderType::BORDER_CONSTANT
+       && ( i < 0 || i >= size_(0)
+         || j < 0 || j >= size_(1)
+         || k < 0 || k >= size_(2) ))
+    {
+        return this->initValue_;
+    }
+
+    int ci(std::min(std::max(i,0), size_(0) - 1)),
+        cj(std::min(std::max(j,0), size_(1) - 1)),
+        ck(std::min(std::max(k,0), size_(2) - 1));
+
+    const Block_s & block( blocks_[ blockIndex( ci >> blockBits
+                                              , cj >> blockBits
+                                              , ck >> blockBits ) ] );
+    if ( !block.data ) { return block.value; }
+
+    return block.data[ cellIndex( ci, cj, ck ) ];
+}
+
+template <typename Value_t>
+void VolumeTileGrid<Value_t>::set( int i, int j, int k
+                                 , const Value_t & value ) {
+    const auto & size_(this->size_);
+    if ( i < 0 || i >= size_(0) || j < 0
+       || j >= size_(1) || k < 0 || k >= size_(2) )
+    {
+        return;
+    }
+
+    Block_s & block( blocks_[ blockIndex( i >> blockBits
+                                        , j >> blockBits
+                                        , k >> blockBits ) ] );
+
+    if ( !block.data ) {
+        if ( block.value == value ) { return; }
+
+        // materialize constant block
+        block.data.reset( new Value_t[ blockVolume ] );
+        std::fill( block.data.get(), block.data.get() + blockVolume
+                 , block.value );
+    }
+
+    block.data[ cellIndex( i, j, k ) ] = value;
+}
+
+template <typename Value_t>
+void VolumeTileGrid<Value_t>::compact() {
+    for ( Block_s & block : blocks_ ) {
+        if ( !block.data ) { continue; }
+
+        bool uniform( true );
+        for ( int c(1); c < blockVolume && uniform; ++c ) {
+            uniform = ( block.data[c] == block.data[0] );
+        }
+
+        if ( uniform ) {
+            block.value = block.data[0];
+            block.data.reset();
+        }
+    }
+}
+
+template <typename Value_t>
+bool VolumeTileGrid<Value_t>::constantBlock( int i, int j, int k, int size
+                                           , Value_t & value ) const {
+    // the whole block must fall into a single tile
+    if ( ( i >> blockBits ) != ( ( i + size - 1 ) >> blockBits )
+      || ( j >> blockBits ) != ( ( j + size - 1 ) >> blockBits )
+      || ( k >> blockBits ) != ( ( k + size - 1 ) >> blockBits ) ) {
+        return false;
+    }
+
+    const Block_s & block( blocks_[ blockIndex( i >> blockBits
+                                              , j >> blockBits
+                                              , k >> blockBits ) ] );
+    if ( block.data ) { return false; }
+
+    value = block.value;
+    return true;
+}
+
+template <typename Value_t>
+uint VolumeTileGrid<Value_t>::blockCount() const {
+    uint count( 0 );
+    for ( const Block_s & block : blocks_ ) {
+        count += bool( block.data );
+    }
+    return count;
+}
+
+template <typename Value_t>
+uint VolumeTileGrid<Value_t>::memUsed() const {
+    return blocks_.size() * sizeof( Block_s )
+        + blockCount() * blockVolume * sizeof( Value_t );
+}
+
 /* class GeoVolume_t */
 
 template <class Value_t,class Container_t>
@@ -1439,6 +1898,71 @@ typename VolumeBase_t::FPosition_s GeoVolume_t<Value_t, Container_t>::grid2geo(
             / this->container_.sizeZ() * ( _upper.z - _lower.z ) );
 }
 
+template <class Value_t,class Container_t>
+template <class Container2_t, class ContainerOut_t, typename Op>
+void GeoVolume_t<Value_t,Container_t>::combine(
+    const GeoVolume_t<Value_t, Container2_t> & other,
+    GeoVolume_t<Value_t, ContainerOut_t> & result,
+    const Op & op ) const {
+
+    const int sx( container_.sizeX() ), sy( container_.sizeY() )
+            , sz( container_.sizeZ() );
+
+    if ( other.container().sizeX() != sx
+      || other.container().sizeY() != sy
+      || other.container().sizeZ() != sz
+      || result.container().sizeX() != sx
+      || result.container().sizeY() != sy
+      || result.container().sizeZ() != sz ) {
+        LOGTHROW( err2, std::runtime_error )
+            << "Combined volumes differ in size.";
+    }
+
+    // block size matching both the tile grid and octree leaf alignment
+    const int bs( 16 );
+    const Value_t & skipValue( result.container().initValue() );
+
+    for ( int bi = 0; bi < sx; bi += bs )
+    for ( int bj = 0; bj < sy; bj += bs )
+    for ( int bk = 0; bk < sz; bk += bs ) {
+
+        const int ei( std::min( bi + bs, sx ) )
+                , ej( std::min( bj + bs, sy ) )
+                , ek( std::min( bk + bs, sz ) );
+
+        // partial border blocks always take the per-voxel path
+        const bool full( ei == bi + bs && ej == bj + bs && ek == bk + bs );
+
+        Value_t ca, cb;
+        const bool constA(
+            full && container_.constantBlock( bi, bj, bk, bs, ca ) );
+        const bool constB(
+            full && other.container().constantBlock( bi, bj, bk, bs, cb ) );
+
+        if ( constA && constB ) {
+            const Value_t v( op( ca, cb ) );
+            if ( v == skipValue ) { continue; }
+
+            for ( int i = bi; i < ei; i++ )
+                for ( int j = bj; j < ej; j++ )
+                    for ( int k = bk; k < ek; k++ )
+                        result.set( i, j, k, v );
+            continue;
+        }
+
+        for ( int i = bi; i < ei; i++ )
+            for ( int j = bj; j < ej; j++ )
+                for ( int k = bk; k < ek; k++ ) {
+                    const Value_t a(
+                        constA ? ca : container_.get( i, j, k ) );
+                    const Value_t b(
+                        constB ? cb : other.get( i, j, k ) );
+                    const Value_t v( op( a, b ) );
+                    if ( v != skipValue ) { result.set( i, j, k, v ); }
+                }
+    }
+}
+
 template <class Value_t, class Container_t>
 template <typename Filter1>
 void ScalarField_t<Value_t, Container_t>::downscale(int factor, float cutOffPeriod){
@@ -1481,10 +2005,8 @@ void ScalarField_t<Value_t, Container_t>::downscale(int factor, float cutOffPeri
 
     LOG( info2 )<<"Collecting filtered data.";
 
-    typedef typename VolumeBase_t::Displacement_s Displacement_s;
     // typedef typename VolumeBase_t::Position_s Position_s;
     typedef typename VolumeBase_t::FPosition_s FPosition_s;
-    typedef Giterator_t<Value_t,Container_t> Giterator_t;
 
     float shift = ((factor-1)*this->voxelSize())/2;
 
@@ -1515,51 +2037,31 @@ void ScalarField_t<Value_t, Container_t>::downscale(int factor, float cutOffPeri
     ScalarField_t<Value_t,Container_t> tmp( ll, newVoxel, volSize
                                           , 0, capacity, offset);
 
-    Displacement_s dispNew[3];
-
-    dispNew[0] = Displacement_s(1,0,0);
-    dispNew[1] = Displacement_s(0,1,0);
-    dispNew[2] = Displacement_s(0,0,1);
-    Displacement_s dispOrig[3];
-    dispOrig[0] = Displacement_s(factor,0,0);
-    dispOrig[1] = Displacement_s(0,factor,0);
-    dispOrig[2] = Displacement_s(0,0,factor);
-
-    typename VolumeBase_t::Position_s pos(0,0,0);
-
-    /**
-     * NB: gend implementation is flawed. That is why xitN<=xendN must be used
-     * here. Imagine sizeX = 9 and displ = (2,0,0), pos = (0,0,0).             >
-     *
-     * End iterator is then 8 which is valid last item in the array!
-     * Fix the iterators, when there is enough time. All their usage needs to be
-     * checked.
-     */
-
-    Giterator_t xitN( tmp.container(), pos, dispNew[0] );
-    Giterator_t xendN = Giterator_t::gend( xitN );
-    Giterator_t xitO( this->container_, pos, dispOrig[0] );
-    Giterator_t xendO = Giterator_t::gend( xitO );
-
-    while(xitN!=xendN && xitO<=xendO){ // bug -- see NB
-        Giterator_t yitN( tmp.container(), xitN.pos, dispNew[1] );
-        Giterator_t yendN = Giterator_t::gend( yitN );
-        Giterator_t yitO( this->container_, xitO.pos, dispOrig[1] );
-        Giterator_t yendO = Giterator_t::gend( yitO );
-
-        while(yitN!=yendN && yitO<=yendO){ // bug -- see NB
-            Giterator_t zitN( tmp.container(), yitN.pos, dispNew[2] );
-            Giterator_t zendN = Giterator_t::gend( zitN );
-            Giterator_t zitO( this->container_, yitO.pos, dispOrig[2] );
-            Giterator_t zendO = Giterator_t::gend( zitO );
-
-            while(zitN!=zendN && zitO<=zendO){ // bug -- see NB
-                zitN.setValue(zitO.value());
-                ++zitN; ++zitO;
+    // number of copied cells per axis: source index i*factor must stay
+    // inside the original volume, destination index inside the new one
+    // (this matches the former `it <= gend` iterator walk, which had to
+    // compensate for the flawed gend -- one past the last *stride*, not
+    // the last cell)
+    const int copyX(std::min(volSize(0)
+                             , (this->container_.sizeX() - 1) / factor + 1));
+    const int copyY(std::min(volSize(1)
+                             , (this->container_.sizeY() - 1) / factor + 1));
+    const int copyZ(std::min(volSize(2)
+                             , (this->container_.sizeZ() - 1) / factor + 1));
+
+    // independent cells; parallel when both containers allow
+    // concurrent access to distinct cells
+    const bool threadSafe(VolumeContainerThreadSafe<Container_t>::value);
+
+    UTILITY_OMP(parallel for schedule( dynamic, 4 ) if(threadSafe))
+    for (int x = 0; x < copyX; ++x) {
+        for (int y = 0; y < copyY; ++y) {
+            for (int z = 0; z < copyZ; ++z) {
+                tmp.container().set(x, y, z
+                    , this->container_.get(x * factor, y * factor
+                                           , z * factor));
             }
-            ++yitN; ++yitO;
         }
-        ++xitN; ++xitO;
     }
     *this = std::move(tmp);
 
@@ -2006,19 +2508,12 @@ void ScalarField_t<Value_t, Container_t>::isoFromTetrahedron(
 }
 
 template<typename Value_t, class Container_t>
-void ScalarField_t<Value_t, Container_t>::isoFromCube(
-        std::vector<typename VolumeBase_t::FPosition_s> & retval
-        , const typename VolumeBase_t::FPosition_s * vertices
-        , const Value_t * values
+int ScalarField_t<Value_t, Container_t>::cubeCode(
+        const Value_t * values
         , const Value_t & threshold, const SurfaceOrientation_t orientation)
 const
 {
-    typedef typename VolumeBase_t::FPosition_s FPosition_s;
-
-    int cubeIndex;
-    FPosition_s vertexList[12];
-
-    cubeIndex = 0;
+    int cubeIndex(0);
     if(orientation == TO_MIN){
         if (values[0] < threshold) cubeIndex |= 1;
         if (values[1] < threshold) cubeIndex |= 2;
@@ -2038,6 +2533,54 @@ const
         if (values[6] > threshold) cubeIndex |= 64;
         if (values[7] > threshold) cubeIndex |= 128;
     }
+    return cubeIndex;
+}
+
+template<typename Value_t, class Container_t>
+void ScalarField_t<Value_t, Container_t>::cubeCorners(
+        int i, int j, int k
+        , typename VolumeBase_t::FPosition_s * vertices
+        , Value_t * values ) const
+{
+    vertices[0] = this->grid2geo(
+        typename VolumeOctree<Value_t>::Position_s( i, j, k ) );
+    values[0] = this->get( i, j, k );
+    vertices[1] = this->grid2geo(
+        typename VolumeOctree<Value_t>::Position_s( i + 1, j, k ) );
+    values[1] = this->get( i + 1, j, k );
+    vertices[2] = this->grid2geo(
+        typename VolumeOctree<Value_t>::Position_s( i + 1, j + 1, k ) );
+    values[2] = this->get( i + 1, j + 1, k );
+    vertices[3] = this->grid2geo(
+        typename VolumeOctree<Value_t>::Position_s( i, j + 1, k ) );
+    values[3] = this->get( i, j + 1, k );
+    vertices[4] = this->grid2geo(
+        typename VolumeOctree<Value_t>::Position_s( i, j, k + 1 ) );
+    values[4] = this->get( i, j, k + 1 );
+    vertices[5] = this->grid2geo(
+        typename VolumeOctree<Value_t>::Position_s( i + 1, j, k + 1 ) );
+    values[5] = this->get( i + 1, j, k + 1 );
+    vertices[6] = this->grid2geo(
+        typename VolumeOctree<Value_t>::Position_s( i + 1, j + 1, k + 1 ) );
+    values[6] = this->get( i + 1, j + 1, k + 1 );
+    vertices[7] = this->grid2geo(
+        typename VolumeOctree<Value_t>::Position_s( i, j + 1, k + 1 ) );
+    values[7] = this->get( i, j + 1, k + 1 );
+}
+
+template<typename Value_t, class Container_t>
+void ScalarField_t<Value_t, Container_t>::isoFromCube(
+        std::vector<typename VolumeBase_t::FPosition_s> & retval
+        , const typename VolumeBase_t::FPosition_s * vertices
+        , const Value_t * values
+        , const Value_t & threshold, const SurfaceOrientation_t orientation)
+const
+{
+    typedef typename VolumeBase_t::FPosition_s FPosition_s;
+
+    FPosition_s vertexList[12];
+
+    const int cubeIndex(cubeCode(values, threshold, orientation));
 
     if (marchingcubes::edgeTable[cubeIndex] == 0)
         return;
@@ -2094,6 +2637,18 @@ ScalarField_t<Value_t, Container_t>::isosurfaceCubes(
       const Value_t & threshold
     , const SurfaceOrientation_t orientation
     , const boost::optional<math::Extents3> &ext ) const
+{
+    return isosurfaceCubesRange( threshold, orientation
+                               , -1, this->container_.sizeZ(), ext );
+}
+
+template <typename Value_t, class Container_t>
+std::vector<typename VolumeBase_t::FPosition_s>
+ScalarField_t<Value_t, Container_t>::isosurfaceCubesRange(
+      const Value_t & threshold
+    , const SurfaceOrientation_t orientation
+    , int k0, int k1
+    , const boost::optional<math::Extents3> &ext ) const
 {
     typedef typename VolumeBase_t::FPosition_s FPosition_s;
     // typedef typename VolumeBase_t::Position_s Position_s;
@@ -2104,34 +2659,11 @@ ScalarField_t<Value_t, Container_t>::isosurfaceCubes(
     UTILITY_OMP(parallel for schedule( dynamic, 5 ))
     for ( int i = -1; i < this->container_.sizeX(); i++ )
         for ( int j = -1; j < this->container_.sizeY(); j++ )
-            for ( int k = -1; k < this->container_.sizeZ(); k++ ) {
+            for ( int k = k0; k < k1; k++ ) {
                 typename VolumeBase_t::FPosition_s vertices[8];
                 Value_t values[8];
 
-                vertices[0] = this->grid2geo(
-                    typename VolumeOctree<Value_t>::Position_s( i, j, k ) );
-                values[0] = this->get( i, j, k );
-                vertices[1] = this->grid2geo(
-                    typename VolumeOctree<Value_t>::Position_s( i + 1, j, k ) );
-                values[1] = this->get( i + 1, j, k );
-                vertices[2] = this->grid2geo(
-                    typename VolumeOctree<Value_t>::Position_s( i+1, j + 1, k ) );
-                values[2] = this->get( i+1, j + 1, k );
-                vertices[3] = this->grid2geo(
-                    typename VolumeOctree<Value_t>::Position_s( i, j + 1, k ) );
-                values[3] = this->get( i, j + 1, k );
-                vertices[4] = this->grid2geo(
-                    typename VolumeOctree<Value_t>::Position_s( i, j, k + 1 ) );
-                values[4] = this->get( i, j, k + 1 );
-                vertices[5] = this->grid2geo(
-                    typename VolumeOctree<Value_t>::Position_s( i + 1, j, k + 1 ) );
-                values[5] = this->get( i + 1, j, k + 1 );
-                vertices[6] = this->grid2geo(
-                    typename VolumeOctree<Value_t>::Position_s( i+1, j + 1, k + 1 ) );
-                values[6] = this->get( i + 1, j + 1, k + 1 );
-                vertices[7] = this->grid2geo(
-                    typename VolumeOctree<Value_t>::Position_s( i, j + 1, k + 1 ) );
-                values[7] = this->get( i, j + 1 , k + 1 );
+                cubeCorners( i, j, k, vertices, values );
 
                 // if all vertices are outside extents, skip the cube
                 if (ext) {
@@ -2258,35 +2790,16 @@ ScalarField_t<Value_t, Container_t>::isosurfaceTetrahedrons(
     return retval;
 }
 
-/** Cannot be made const since there is a manipulation with border
- *  condition. *sigh*
+/** Weld a marching cubes/tetrahedrons triangle soup (consecutive point
+ *  triples) into an indexed mesh. Degenerate faces and faces with
+ *  non-finite vertices are dropped.
  */
-template <typename Value_t, class Container_t>
-geometry::Mesh ScalarField_t<Value_t, Container_t>::isosurfaceAsMesh(
-              const Value_t & threshold
-            , const SurfaceOrientation_t orientation
-            , const IsosurfaceAlgorithm_t algorithm
-            , const boost::optional<math::Extents3> &ext)
+inline geometry::Mesh weldTriangleSoup(
+        const std::vector<VolumeBase_t::FPosition_s> &vertices)
 {
-
-    typedef typename VolumeBase_t::FPosition_s FPosition_s;
-
-    const auto oldBorderType
-        (this->container_.setBorderType(BorderType::BORDER_REPLICATE));
-    std::vector<FPosition_s> vertices;
-    switch(algorithm){
-    case M_CUBES:
-        vertices = this->isosurfaceCubes(threshold,orientation,ext);
-        break;
-    case M_TETRAHEDRONS:
-        vertices = this->isosurfaceTetrahedrons(threshold,orientation,ext);
-        break;
-    }
-    this->container_.setBorderType(oldBorderType);
-
     geometry::Mesh ret;
 
-    std::map<math::Point3,uint> vidMap;
+    HashedPointIndex<math::Point3> vidMap;
     uint numNaNs = 0;
 
     //reconstruct faces
@@ -2302,14 +2815,10 @@ geometry::Mesh ScalarField_t<Value_t, Container_t>::isosurfaceAsMesh(
                       std::isfinite(pVertex(1)) &&
                       std::isfinite(pVertex(2));
 
-            auto it = vidMap.find(pVertex);
-            if(it==vidMap.end()){
-                vidMap.insert(std::make_pair(pVertex,ret.vertices.size()));
-                indices[vertex]=ret.vertices.size();
+            indices[vertex] = vidMap.assign(pVertex);
+            if(indices[vertex]==ret.vertices.size()){
                 ret.vertices.push_back(pVertex);
-                continue;
             }
-            indices[vertex]=it->second;
         }
         if(indices[0] == indices[1]
                 || indices[0] == indices[2]
@@ -2329,6 +2838,210 @@ geometry::Mesh ScalarField_t<Value_t, Container_t>::isosurfaceAsMesh(
     return ret;
 }
 
+/** Cannot be made const since there is a manipulation with border
+ *  condition. *sigh*
+ */
+template <typename Value_t, class Container_t>
+geometry::Mesh ScalarField_t<Value_t, Container_t>::isosurfaceAsMesh(
+              const Value_t & threshold
+            , const SurfaceOrientation_t orientation
+            , const IsosurfaceAlgorithm_t algorithm
+            , const boost::optional<math::Extents3> &ext)
+{
+    GEOMETRY_PERF_TIMER(perf::Timer::isosurface);
+
+    typedef typename VolumeBase_t::FPosition_s FPosition_s;
+
+    const auto oldBorderType
+        (this->container_.setBorderType(BorderType::BORDER_REPLICATE));
+    std::vector<FPosition_s> vertices;
+    switch(algorithm){
+    case M_CUBES:
+        vertices = this->isosurfaceCubes(threshold,orientation,ext);
+        break;
+    case M_TETRAHEDRONS:
+        vertices = this->isosurfaceTetrahedrons(threshold,orientation,ext);
+        break;
+    }
+    this->container_.setBorderType(oldBorderType);
+
+    return weldTriangleSoup(vertices);
+}
+
+template <typename Value_t, class Container_t>
+template <typename MeshSink>
+void ScalarField_t<Value_t, Container_t>::isosurfaceCubesStreamed(
+              const Value_t & threshold
+            , const SurfaceOrientation_t orientation
+            , int slabThickness
+            , const MeshSink & sink )
+{
+    const auto oldBorderType
+        (this->container_.setBorderType(BorderType::BORDER_REPLICATE));
+
+    const int sizeZ(this->container_.sizeZ());
+    for ( int k0 = -1; k0 < sizeZ; k0 += slabThickness ) {
+        const int k1(std::min(k0 + slabThickness, sizeZ));
+
+        sink(weldTriangleSoup(
+                 isosurfaceCubesRange(threshold, orientation
+                                      , k0, k1, boost::none))
+             , k0, k1);
+    }
+
+    this->container_.setBorderType(oldBorderType);
+}
+
+template <typename Value_t, class Container_t>
+geometry::Mesh ScalarField_t<Value_t, Container_t>::isosurfaceCubesIndexed(
+              const Value_t & threshold
+            , const SurfaceOrientation_t orientation
+            , const boost::optional<math::Extents3> &ext)
+{
+    typedef typename VolumeBase_t::FPosition_s FPosition_s;
+
+    // canonical cell edge per cube edge: cell offset, axis and the two
+    // cube corners the isovertex is interpolated between
+    static const int edgeCell[12][6] = {
+        { 0, 0, 0,  0,  0, 1 },
+        { 1, 0, 0,  1,  1, 2 },
+        { 0, 1, 0,  0,  2, 3 },
+        { 0, 0, 0,  1,  3, 0 },
+        { 0, 0, 1,  0,  4, 5 },
+        { 1, 0, 1,  1,  5, 6 },
+        { 0, 1, 1,  0,  6, 7 },
+        { 0, 0, 1,  1,  7, 4 },
+        { 0, 0, 0,  2,  0, 4 },
+        { 1, 0, 0,  2,  1, 5 },
+        { 1, 1, 0,  2,  2, 6 },
+        { 0, 1, 0,  2,  3, 7 }
+    };
+
+    const auto oldBorderType
+        (this->container_.setBorderType(BorderType::BORDER_REPLICATE));
+
+    const int sizeX(this->container_.sizeX());
+    const int sizeY(this->container_.sizeY());
+    const int sizeZ(this->container_.sizeZ());
+
+    // pre-scan: count output triangles so everything is reserved up
+    // front; the optional extents filter is ignored here, so with ext
+    // set this is only an upper bound
+    std::size_t faceCount(0);
+
+    UTILITY_OMP(parallel for schedule( dynamic, 5 ) reduction( + : faceCount ))
+    for ( int i = -1; i < sizeX; i++ )
+        for ( int j = -1; j < sizeY; j++ )
+            for ( int k = -1; k < sizeZ; k++ ) {
+                Value_t values[8];
+                values[0] = this->get( i, j, k );
+                values[1] = this->get( i + 1, j, k );
+                values[2] = this->get( i + 1, j + 1, k );
+                values[3] = this->get( i, j + 1, k );
+                values[4] = this->get( i, j, k + 1 );
+                values[5] = this->get( i + 1, j, k + 1 );
+                values[6] = this->get( i + 1, j + 1, k + 1 );
+                values[7] = this->get( i, j + 1, k + 1 );
+
+                const int cubeIndex(cubeCode(values, threshold, orientation));
+                for (uint t = 0;
+                     marchingcubes::triTable[cubeIndex][t] != -1; t += 3)
+                    faceCount++;
+            }
+
+    geometry::Mesh ret;
+    ret.faces.reserve(faceCount);
+    // on a closed triangulated surface vertices ~ faces / 2
+    ret.vertices.reserve(faceCount / 2 + 1);
+
+    std::unordered_map<std::uint64_t, uint> isoVertices;
+    isoVertices.reserve(faceCount / 2 + 1);
+
+    uint numNaNs = 0;
+
+    // fill pass: emit indexed triangles, welding through the edge map
+    for ( int i = -1; i < sizeX; i++ )
+        for ( int j = -1; j < sizeY; j++ )
+            for ( int k = -1; k < sizeZ; k++ ) {
+                FPosition_s vertices[8];
+                Value_t values[8];
+
+                cubeCorners( i, j, k, vertices, values );
+
+                const int cubeIndex(cubeCode(values, threshold, orientation));
+
+                if (marchingcubes::edgeTable[cubeIndex] == 0)
+                    continue;
+
+                // if all vertices are outside extents, skip the cube
+                if (ext) {
+                    bool skip(true);
+                    for (uint c(0); (c < 8) && skip; ++c) {
+                        const auto &v(vertices[c]);
+                        skip = !(inside(*ext, v.x, v.y, v.z));
+                    }
+
+                    if (skip) continue;
+                }
+
+                // vertex index per active cube edge
+                uint edgeIndex[12];
+                for (uint e = 0; e < 12; e++) {
+                    if (!(marchingcubes::edgeTable[cubeIndex] & (1 << e)))
+                        continue;
+
+                    const int *ec(edgeCell[e]);
+                    const std::uint64_t key
+                        ( (std::uint64_t(ec[3]) << 60)
+                        | (std::uint64_t(i + 1 + ec[0]) << 40)
+                        | (std::uint64_t(j + 1 + ec[1]) << 20)
+                        | std::uint64_t(k + 1 + ec[2]) );
+
+                    auto res(isoVertices.emplace(key, ret.vertices.size()));
+                    if (res.second) {
+                        const FPosition_s p
+                            (interpolate(vertices[ec[4]], values[ec[4]]
+                                         , vertices[ec[5]], values[ec[5]]
+                                         , threshold));
+                        ret.vertices.push_back(math::Point3(p.x, p.y, p.z));
+                    }
+                    edgeIndex[e] = res.first->second;
+                }
+
+                for (uint t = 0;
+                     marchingcubes::triTable[cubeIndex][t] != -1; t += 3) {
+                    const uint a(edgeIndex
+                                 [marchingcubes::triTable[cubeIndex][t + 0]]);
+                    const uint b(edgeIndex
+                                 [marchingcubes::triTable[cubeIndex][t + 1]]);
+                    const uint c(edgeIndex
+                                 [marchingcubes::triTable[cubeIndex][t + 2]]);
+
+                    bool finite = true;
+                    for (const uint v : { a, b, c }) {
+                        const auto &p(ret.vertices[v]);
+                        finite &= std::isfinite(p(0)) && std::isfinite(p(1))
+                            && std::isfinite(p(2));
+                    }
+                    if (!finite) {
+                        numNaNs++;
+                        continue;
+                    }
+
+                    ret.addFace(a, b, c);
+                }
+            }
+
+    if (numNaNs > 0) {
+        LOG(warn4) << "Extracted isosurface mesh has " << numNaNs
+                   << " NaN points.";
+    }
+
+    this->container_.setBorderType(oldBorderType);
+
+    return ret;
+}
+
 
 template<typename Value_t, class Container_t>
 geometry::Mesh ScalarField_t<Value_t, Container_t>::getQuadsAsMesh( const Value_t & threshold
@@ -2358,48 +3071,28 @@ geometry::Mesh ScalarField_t<Value_t, Container_t>::getQuadsAsMesh( const Value_
 
 template <typename Value_t>
 DistanceMap_t<Value_t>::DistanceMap_t( const Bitfield_t & bitfield,
-    const Value_t initValue )
+    const Value_t initValue, bool parallel )
     : ScalarField_t<Value_t, VolumeOctree<Value_t>>( bitfield.lower(), bitfield.upper(),
       bitfield.voxelSize(), initValue ) {
 
     // initialize vector distance field (Danielsson's 4SED algorithm)
-    DistVectorField_t dvField( this->container().sizeX(), this->container().sizeY(), this->container().sizeZ(),
-        initValue / this->_voxelSize );
-
-    for ( int i = 0; i < dvField.sizeX(); i++ )
-        for ( int j = 0; j < dvField.sizeY(); j++ )
-            for ( int k = 0; k < dvField.sizeZ(); k++ )
-                if ( bitfield.get( i, j, k ) )
-                    dvField.set( i, j, k, DistVector_s( 0.0, 0.0, 0.0 ) );
-
-    // perform scanning
-    //std::cout << "Z ASC\n";
-    for ( int k = 1; k < dvField.sizeZ(); k++ )
-        scanXYPlane( dvField, k, ASC );
-    //std::cout << "Z DESC\n";
-    for ( int k = dvField.sizeZ() - 2; k >= 0; k-- )
-        scanXYPlane( dvField, k, DESC );
-
-    // compute distance map based on the vector field
-    for ( int i = 0; i < dvField.sizeX(); i++ )
-        for ( int j = 0; j < dvField.sizeY(); j++ )
-            for ( int k = 0; k < dvField.sizeZ(); k++ ) {
-
-                DistVector_s dv( dvField.get( i, j, k ) );
-                Value_t dist = this->_voxelSize * sqrt(
-                    math::sqr( dv.distX ) + math::sqr( dv.distY ) + math::sqr( dv.distZ ) );
-
-                if ( dist < initValue )
-                    this->set( i, j, k, dist );
-            }
-
-    // all done
+    if ( parallel ) {
+        DenseDistVectorField_t dvField( this->container().sizeX(), this->container().sizeY(), this->container().sizeZ(),
+            initValue / this->_voxelSize );
+        seedBitfield( bitfield, dvField );
+        computeFrom( dvField, initValue, true );
+    } else {
+        DistVectorField_t dvField( this->container().sizeX(), this->container().sizeY(), this->container().sizeZ(),
+            initValue / this->_voxelSize );
+        seedBitfield( bitfield, dvField );
+        computeFrom( dvField, initValue, false );
+    }
 }
 
 
 template <typename Value_t>
 DistanceMap_t<Value_t>::DistanceMap_t( const PointCloud & cloud,
-    float voxelSize, const Value_t initValue )
+    float voxelSize, const Value_t initValue, bool parallel )
     : ScalarField_t<Value_t, VolumeOctree<Value_t>>( cloud.lower(), cloud.upper(),
       voxelSize, initValue ) {
 
@@ -2409,8 +3102,37 @@ DistanceMap_t<Value_t>::DistanceMap_t( const PointCloud & cloud,
                  << ", " << this->container().sizeZ() << " )";
 
     // initialize vector distance field (Danielsson's 4SED algorithm)
-    DistVectorField_t dvField( this->container().sizeX(), this->container().sizeY(), this->container().sizeZ(),
-        initValue / this->_voxelSize );
+    if ( parallel ) {
+        DenseDistVectorField_t dvField( this->container().sizeX(), this->container().sizeY(), this->container().sizeZ(),
+            initValue / this->_voxelSize );
+        seedCloud( cloud, dvField );
+        computeFrom( dvField, initValue, true );
+    } else {
+        DistVectorField_t dvField( this->container().sizeX(), this->container().sizeY(), this->container().sizeZ(),
+            initValue / this->_voxelSize );
+        seedCloud( cloud, dvField );
+        computeFrom( dvField, initValue, false );
+    }
+}
+
+
+template <typename Value_t>
+template <class DVField>
+void DistanceMap_t<Value_t>::seedBitfield( const Bitfield_t & bitfield,
+    DVField & dvField ) {
+
+    for ( int i = 0; i < dvField.sizeX(); i++ )
+        for ( int j = 0; j < dvField.sizeY(); j++ )
+            for ( int k = 0; k < dvField.sizeZ(); k++ )
+                if ( bitfield.get( i, j, k ) )
+                    dvField.set( i, j, k, DistVector_s( 0.0, 0.0, 0.0 ) );
+}
+
+
+template <typename Value_t>
+template <class DVField>
+void DistanceMap_t<Value_t>::seedCloud( const PointCloud & cloud,
+    DVField & dvField ) {
 
     BOOST_FOREACH( math::Point3 point, cloud ) {
 
@@ -2438,14 +3160,24 @@ DistanceMap_t<Value_t>::DistanceMap_t( const PointCloud & cloud,
                                 , curVal.distZ ) ) );
             }
     }
+}
+
+
+template <typename Value_t>
+template <class DVField>
+void DistanceMap_t<Value_t>::computeFrom( DVField & dvField,
+    const Value_t & initValue, bool parallel ) {
 
     // perform scanning
-    //std::cout << "Z ASC\n";
-    for ( int k = 1; k < dvField.sizeZ(); k++ )
-        scanXYPlane( dvField, k, ASC );
-    //std::cout << "Z DESC\n";
-    for ( int k = dvField.sizeZ() - 2; k >= 0; k-- )
-        scanXYPlane( dvField, k, DESC );
+    if ( parallel ) {
+        scanVolumeParallel( dvField, ASC );
+        scanVolumeParallel( dvField, DESC );
+    } else {
+        for ( int k = 1; k < dvField.sizeZ(); k++ )
+            scanXYPlane( dvField, k, ASC );
+        for ( int k = dvField.sizeZ() - 2; k >= 0; k-- )
+            scanXYPlane( dvField, k, DESC );
+    }
 
     // compute distance map based on the vector field
     for ( int i = 0; i < dvField.sizeX(); i++ )
@@ -2465,7 +3197,55 @@ DistanceMap_t<Value_t>::DistanceMap_t( const PointCloud & cloud,
 
 
 template <typename Value_t>
-void DistanceMap_t<Value_t>::scanXYPlane( DistVectorField_t & dvField,
+template <class DVField>
+void DistanceMap_t<Value_t>::scanVolumeParallel( DVField & dvField,
+    const Scandir_t scandir ) {
+
+    const int sizeX( dvField.sizeX() ), sizeY( dvField.sizeY() )
+            , sizeZ( dvField.sizeZ() );
+
+    // z propagation couples consecutive planes: planes go in sequence,
+    // the rows of a plane are distributed over threads
+    if ( scandir == ASC ) {
+        for ( int k = 1; k < sizeZ; k++ ) {
+            UTILITY_OMP(parallel for schedule( static ))
+            for ( int j = 0; j < sizeY; j++ )
+                for ( int i = 0; i < sizeX; i++ )
+                    dvField.set( i, j, k, min(
+                        dvField.get( i, j, k ),
+                        dvField.get( i, j, k - 1 )
+                            + DistVector_s( 0, 0, 1 ) ) );
+        }
+    } else {
+        for ( int k = sizeZ - 2; k >= 0; k-- ) {
+            UTILITY_OMP(parallel for schedule( static ))
+            for ( int j = 0; j < sizeY; j++ )
+                for ( int i = 0; i < sizeX; i++ )
+                    dvField.set( i, j, k, min(
+                        dvField.get( i, j, k ),
+                        dvField.get( i, j, k + 1 )
+                            + DistVector_s( 0, 0, 1 ) ) );
+        }
+    }
+
+    // the in-plane xy propagation touches only its own plane: all planes
+    // run in parallel; the static schedule hands each thread a
+    // contiguous block of planes, so threads never write neighboring
+    // (cache-line-sharing) voxels
+    UTILITY_OMP(parallel for schedule( static ))
+    for ( int k = 0; k < sizeZ; k++ ) {
+        for ( int j = 1; j < sizeY; j++ )
+            scanXLine( dvField, j, k, ASC );
+
+        for ( int j = sizeY - 2; j >= 0; j-- )
+            scanXLine( dvField, j, k, DESC );
+    }
+}
+
+
+template <typename Value_t>
+template <class DVField>
+void DistanceMap_t<Value_t>::scanXYPlane( DVField & dvField,
     int k, const Scandir_t scandir ) {
 
     // z propagation
@@ -2497,7 +3277,8 @@ void DistanceMap_t<Value_t>::scanXYPlane( DistVectorField_t & dvField,
 }
 
 template <typename Value_t>
-void DistanceMap_t<Value_t>::scanXLine( DistVectorField_t & dvField,
+template <class DVField>
+void DistanceMap_t<Value_t>::scanXLine( DVField & dvField,
     int j, int k, const Scandir_t scandir ) {
 
     // y propagation
@@ -35,6 +35,8 @@
 #ifndef geometry_volumeop_hpp_included_
 #define geometry_volumeop_hpp_included_
 
+#include <cstdint>
+
 #include "geometry/volume.hpp"
 #include "math/geometry_core.hpp"
 #include "utility/enum-io.hpp"
@@ -130,6 +132,210 @@ UTILITY_GENERATE_ENUM_IO(StructuralElement::SEShape,
                          ((SPHERE)("sphere"))
                          )
 
+/** Bit-packed occupancy volume: 64 voxels per word along the x axis.
+ *
+ * Purpose-built for boolean morphology; erosion/dilatation overloads
+ * below process whole words with shifts and ANDs/ORs instead of one
+ * generic get() per structural-element offset. Bits beyond sizeX in
+ * the last word of each row are kept zero.
+ *
+ * Not safe for concurrent set() calls (voxels share words); the
+ * word-parallel kernels below split work along whole rows.
+ */
+class BitmaskVolume {
+public:
+    BitmaskVolume(int sizeX, int sizeY, int sizeZ, bool initValue = false)
+        : sizeX_(sizeX), sizeY_(sizeY), sizeZ_(sizeZ)
+        , wordsX_((sizeX + 63) / 64)
+        , data_(std::size_t(wordsX_) * sizeY * sizeZ
+                , initValue ? ~std::uint64_t(0) : 0)
+    {
+        if (initValue) { clearTails(); }
+    }
+
+    int sizeX() const { return sizeX_; }
+    int sizeY() const { return sizeY_; }
+    int sizeZ() const { return sizeZ_; }
+
+    /** Words per x row. */
+    int wordsX() const { return wordsX_; }
+
+    bool get(int i, int j, int k) const {
+        return (row(j, k)[i >> 6] >> (i & 63)) & 1;
+    }
+
+    void set(int i, int j, int k, bool value) {
+        auto &word(row(j, k)[i >> 6]);
+        const auto bit(std::uint64_t(1) << (i & 63));
+        if (value) { word |= bit; } else { word &= ~bit; }
+    }
+
+    std::uint64_t* row(int j, int k) {
+        return data_.data()
+            + (std::size_t(k) * sizeY_ + j) * wordsX_;
+    }
+
+    const std::uint64_t* row(int j, int k) const {
+        return data_.data()
+            + (std::size_t(k) * sizeY_ + j) * wordsX_;
+    }
+
+private:
+    void clearTails() {
+        const int used(sizeX_ - 64 * (wordsX_ - 1));
+        if (used >= 64) { return; }
+        const std::uint64_t mask((std::uint64_t(1) << used) - 1);
+        for (std::size_t i(wordsX_ - 1); i < data_.size(); i += wordsX_) {
+            data_[i] &= mask;
+        }
+    }
+
+    int sizeX_, sizeY_, sizeZ_;
+    int wordsX_;
+    std::vector<std::uint64_t> data_;
+};
+
+/** Packs a generic volume into a bitmask: cells above threshold become
+ *  full voxels.
+ */
+template <class Container_t>
+BitmaskVolume packBitmask(const Container_t &container
+                          , const typename Container_t::ValueType &threshold)
+{
+    BitmaskVolume bitmask(container.sizeX(), container.sizeY()
+                          , container.sizeZ());
+    for (int z = 0; z < container.sizeZ(); ++z) {
+        for (int y = 0; y < container.sizeY(); ++y) {
+            for (int x = 0; x < container.sizeX(); ++x) {
+                if (container.get(x, y, z) > threshold) {
+                    bitmask.set(x, y, z, true);
+                }
+            }
+        }
+    }
+    return bitmask;
+}
+
+/** Writes a bitmask back into a generic volume as full/empty values.
+ */
+template <class Value_t, class Container_t>
+void unpackBitmask(const BitmaskVolume &bitmask, Container_t &container
+                   , const Value_t &full, const Value_t &empty)
+{
+    for (int z = 0; z < bitmask.sizeZ(); ++z) {
+        for (int y = 0; y < bitmask.sizeY(); ++y) {
+            for (int x = 0; x < bitmask.sizeX(); ++x) {
+                container.set(x, y, z
+                              , bitmask.get(x, y, z) ? full : empty);
+            }
+        }
+    }
+}
+
+namespace detail {
+
+/** Copies a bitmask row shifted by dx voxels: output bit x takes input
+ *  bit (x + dx). Bits whose source lies outside [0, sizeX) take the
+ *  fill value (1 for erosion, 0 for dilatation), matching the scalar
+ *  kernels that skip out-of-volume offsets.
+ */
+inline void shiftBitmaskRow(const std::uint64_t *src, std::uint64_t *dst
+                            , int words, int sizeX, int dx, bool fill)
+{
+    const std::uint64_t fillWord(fill ? ~std::uint64_t(0) : 0);
+    const int wd(dx >> 6); // floor division, also for negative dx
+    const int sh(dx & 63);
+
+    auto srcWord([&](int i) -> std::uint64_t {
+        if ((i < 0) || (i >= words)) { return fillWord; }
+        std::uint64_t w(src[i]);
+        // tail bits at and beyond sizeX take the fill value too
+        if (i == words - 1) {
+            const int used(sizeX - 64 * i);
+            if (used < 64) {
+                const std::uint64_t mask((std::uint64_t(1) << used) - 1);
+                w = fill ? (w | ~mask) : (w & mask);
+            }
+        }
+        return w;
+    });
+
+    for (int w = 0; w < words; ++w) {
+        dst[w] = sh
+            ? ((srcWord(w + wd) >> sh) | (srcWord(w + wd + 1) << (64 - sh)))
+            : srcWord(w + wd);
+    }
+}
+
+} // namespace detail
+
+/** Word-parallel erosion on a bit-packed occupancy volume; 64 voxels
+ *  per AND. Semantically identical to the generic erosion above with a
+ *  boolean value type.
+ */
+inline void erosion(BitmaskVolume &container, const StructuralElement &se)
+{
+    BitmaskVolume result(container);
+    const int words(container.wordsX());
+    const int sizeX(container.sizeX());
+
+    UTILITY_OMP(parallel for schedule( dynamic, 5 ))
+    for (int z = 0; z < container.sizeZ(); ++z) {
+        std::vector<std::uint64_t> shifted(words);
+        for (int y = 0; y < container.sizeY(); ++y) {
+            auto *dstRow(result.row(y, z));
+            for (const auto &offset : se.offsets()) {
+                const int sy(y + offset(1)), sz(z + offset(2));
+                if ((sy < 0) || (sy >= container.sizeY())
+                    || (sz < 0) || (sz >= container.sizeZ()))
+                {
+                    continue;
+                }
+                detail::shiftBitmaskRow(container.row(sy, sz)
+                                        , shifted.data(), words, sizeX
+                                        , offset(0), true);
+                for (int w = 0; w < words; ++w) {
+                    dstRow[w] &= shifted[w];
+                }
+            }
+        }
+    }
+    container = std::move(result);
+}
+
+/** Word-parallel dilatation on a bit-packed occupancy volume; 64
+ *  voxels per OR.
+ */
+inline void dilatation(BitmaskVolume &container, const StructuralElement &se)
+{
+    BitmaskVolume result(container);
+    const int words(container.wordsX());
+    const int sizeX(container.sizeX());
+
+    UTILITY_OMP(parallel for schedule( dynamic, 5 ))
+    for (int z = 0; z < container.sizeZ(); ++z) {
+        std::vector<std::uint64_t> shifted(words);
+        for (int y = 0; y < container.sizeY(); ++y) {
+            auto *dstRow(result.row(y, z));
+            for (const auto &offset : se.offsets()) {
+                const int sy(y + offset(1)), sz(z + offset(2));
+                if ((sy < 0) || (sy >= container.sizeY())
+                    || (sz < 0) || (sz >= container.sizeZ()))
+                {
+                    continue;
+                }
+                detail::shiftBitmaskRow(container.row(sy, sz)
+                                        , shifted.data(), words, sizeX
+                                        , offset(0), false);
+                for (int w = 0; w < words; ++w) {
+                    dstRow[w] |= shifted[w];
+                }
+            }
+        }
+    }
+    container = std::move(result);
+}
+
 
 
 //filtering
@@ -156,7 +362,13 @@ void filter(
     std::vector<VolumeBase_t::Position_s> poss
         = Giterator::iteratorPositions( container, diff );
 
-    BOOST_FOREACH( VolumeBase_t::Position_s pos, poss ) {
+    // scanlines are independent; containers guaranteeing cell-level
+    // thread safety get them distributed across threads
+    const bool threadSafe(VolumeContainerThreadSafe<Container_t>::value);
+
+    UTILITY_OMP(parallel for schedule( dynamic, 20 ) if(threadSafe))
+    for ( int p = 0; p < int(poss.size()); ++p ) {
+        VolumeBase_t::Position_s pos = poss[p];
 
         Giterator sit( container, pos, diff );
         Giterator send = Giterator::gend( sit );
@@ -164,6 +376,18 @@ void filter(
 
         int rowSize = send - sit;
 
+        // dense containers expose the scanline as a raw span; the
+        // convolution then runs on pointers and vectorizes
+        VolumeSpan_t<ValueType> ssp( scanlineSpan( sit ) );
+        VolumeSpan_t<ValueType> dsp( scanlineSpan( dit ) );
+
+        if ( ssp.valid() && dsp.valid() ) {
+            for ( int x = 0; x < rowSize; x++ ) {
+                dsp[x] = (ValueType) filter.convolute( ssp, x, rowSize );
+            }
+            continue;
+        }
+
         for ( int x = 0; x < rowSize; x++ ) {
             dit.setValue( filter.convolute( sit, x, rowSize ) );
             ++sit; ++dit;
@@ -213,7 +437,13 @@ void filterInplace(
     std::vector<VolumeBase_t::Position_s> poss
         = Giterator::iteratorPositions( container, diff );
 
-    for( auto pos: poss ) {
+    // each scanline is filtered into its own line buffer first, so
+    // thread-safe containers can process them concurrently
+    const bool threadSafe(VolumeContainerThreadSafe<Container_t>::value);
+
+    UTILITY_OMP(parallel for schedule( dynamic, 20 ) if(threadSafe))
+    for( int p = 0; p < int(poss.size()); ++p ) {
+        VolumeBase_t::Position_s pos = poss[p];
 
         Giterator sit( container, pos, diff );
         Giterator send = Giterator::gend( sit );
@@ -268,6 +498,24 @@ void filterInplace(
         int rowSize = send - sit;
 
         std::vector<ValueType> filtered(rowSize);
+
+        // unit-axis displacements walk the flat backing vector at a
+        // constant stride; the raw span turns the convolution and the
+        // write-back into vectorizable pointer loops
+        VolumeSpan_t<ValueType> span( scanlineSpan( sit ) );
+
+        if ( span.valid() ) {
+            for ( int x = 0; x < rowSize; x++ ) {
+                filtered[x] = (ValueType)std::min(
+                    std::max(filter.convolute( span, x, rowSize ),min),max);
+            }
+
+            for ( int x = 0; x < rowSize; x++ ) {
+                span[x] = filtered[x];
+            }
+            continue;
+        }
+
         auto dit = filtered.begin();
 
         for ( int x = 0; x < rowSize; x++ ) {
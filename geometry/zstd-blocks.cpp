@@ -0,0 +1,303 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <boost/version.hpp>
+
+#if BOOST_VERSION >= 107000
+#  include <boost/iostreams/filtering_stream.hpp>
+#  include <boost/iostreams/filter/zstd.hpp>
+#  include <boost/iostreams/device/array.hpp>
+#  include <boost/iostreams/device/back_inserter.hpp>
+#endif
+
+#include <dbglog/dbglog.hpp>
+
+#include "utility/binaryio.hpp"
+#include "utility/openmp.hpp"
+
+#include "error.hpp"
+#include "zstd-blocks.hpp"
+
+namespace bin = utility::binaryio;
+
+#if BOOST_VERSION >= 107000
+namespace bio = boost::iostreams;
+#endif
+
+namespace geometry {
+
+namespace {
+
+const unsigned VERSION = 1;
+
+/** Container layout, all offsets from stream start:
+ *
+ *      0  char[8]   magic
+ *      8  uint32    version (1)
+ *     12  uint32    block size (raw bytes per frame)
+ *     16  uint64    total raw size
+ *     24  uint32    frame count
+ *     28  uint32[frameCount]  compressed frame sizes (the seek index)
+ *      .  frames, back to back; every frame is an independent zstd
+ *         stream of one blockSize-long slice of the raw data (the last
+ *         slice is short)
+ */
+
+#if BOOST_VERSION >= 107000
+
+std::string compressFrame(const char *data, std::size_t size, int level)
+{
+    std::string out;
+    {
+        bio::filtering_ostream os;
+        os.push(bio::zstd_compressor
+                (bio::zstd_params(std::uint32_t(level))));
+        os.push(bio::back_inserter(out));
+        os.write(data, size);
+        // destructor closes the chain and finishes the frame
+    }
+    return out;
+}
+
+bool decompressFrame(const char *data, std::size_t size
+                     , char *out, std::size_t rawSize)
+{
+    try {
+        bio::filtering_istream is;
+        is.push(bio::zstd_decompressor());
+        is.push(bio::array_source(data, size));
+        is.read(out, rawSize);
+        return (std::size_t(is.gcount()) == rawSize);
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+struct ContainerHeader {
+    std::size_t blockSize;
+    std::uint64_t rawSize;
+    std::size_t frameCount;
+};
+
+ContainerHeader readHeader(std::istream &in
+                           , const boost::filesystem::path &path)
+{
+    char magic[8];
+    std::uint32_t version, blockSize, frameCount;
+    std::uint64_t rawSize;
+
+    bin::read(in, magic);
+    if (std::memcmp(magic, ZSTD_BLOCKS_MAGIC, sizeof(magic))) {
+        LOGTHROW(err1, BadFileFormat)
+            << "File " << path << " is not a zstd block container.";
+    }
+
+    bin::read(in, version);
+    if (version != VERSION) {
+        LOGTHROW(err1, VersionError) << "File " << path
+            << " has unsupported version (" << version << ").";
+    }
+
+    bin::read(in, blockSize);
+    bin::read(in, rawSize);
+    bin::read(in, frameCount);
+
+    if (rawSize && !blockSize) {
+        LOGTHROW(err1, BadFileFormat)
+            << "File " << path << " has corrupt zstd block header.";
+    }
+    const std::uint64_t expected
+        (rawSize ? ((rawSize + blockSize - 1) / blockSize) : 0);
+    if (expected != frameCount) {
+        LOGTHROW(err1, BadFileFormat)
+            << "File " << path << " has corrupt zstd block header.";
+    }
+
+    ContainerHeader header;
+    header.blockSize = blockSize;
+    header.rawSize = rawSize;
+    header.frameCount = frameCount;
+    return header;
+}
+
+int resolveThreads(int nThreads)
+{
+    if (!nThreads) {
+        nThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    return nThreads;
+}
+
+/** Decodes the frames covering the first limit raw bytes.
+ */
+std::string readBlocks(std::istream &in
+                       , const boost::filesystem::path &path
+                       , std::uint64_t limit, int nThreads)
+{
+    const auto header(readHeader(in, path));
+
+    const auto want(std::size_t(std::min(limit, header.rawSize)));
+    const std::size_t useFrames
+        (want ? ((want + header.blockSize - 1) / header.blockSize) : 0);
+
+    // seek index
+    std::vector<std::uint32_t> frameSizes(header.frameCount);
+    for (auto &size : frameSizes) { bin::read(in, size); }
+
+    // used frames sit back to back right behind the index
+    std::vector<std::size_t> frameStart(useFrames);
+    std::size_t compressedSize(0);
+    for (std::size_t i = 0; i < useFrames; ++i) {
+        frameStart[i] = compressedSize;
+        compressedSize += frameSizes[i];
+    }
+
+    std::vector<char> compressed(compressedSize);
+    in.read(compressed.data(), compressedSize);
+    if (std::size_t(in.gcount()) != compressedSize) {
+        LOGTHROW(err1, BadFileFormat)
+            << "File " << path << " is truncated.";
+    }
+
+    std::string raw(want, '\0');
+    std::vector<char> failed(useFrames, 0);
+
+    nThreads = resolveThreads(nThreads);
+    const auto frames(std::int64_t(useFrames));
+
+    UTILITY_OMP(parallel for schedule(dynamic) num_threads(nThreads))
+    for (std::int64_t i = 0; i < frames; ++i) {
+        const auto rawBegin(std::size_t(i) * header.blockSize);
+        const auto rawLength(std::min(header.blockSize, want - rawBegin));
+        if (!decompressFrame(compressed.data() + frameStart[i]
+                             , frameSizes[i]
+                             , &raw[0] + rawBegin, rawLength))
+        {
+            failed[i] = 1;
+        }
+    }
+
+    for (std::size_t i = 0; i < useFrames; ++i) {
+        if (failed[i]) {
+            LOGTHROW(err1, BadFileFormat)
+                << "File " << path << " has corrupt zstd frame "
+                << i << ".";
+        }
+    }
+
+    return raw;
+}
+
+#endif // BOOST_VERSION >= 107000
+
+} // namespace
+
+#if BOOST_VERSION >= 107000
+
+void writeZstdBlocks(std::ostream &out, const char *data, std::size_t size
+                     , const ZstdBlocksOptions &options)
+{
+    if (!options.blockSize) {
+        LOGTHROW(err1, std::runtime_error)
+            << "Invalid zstd block size (0).";
+    }
+
+    const auto blockSize(options.blockSize);
+    const std::size_t frames
+        (size ? ((size + blockSize - 1) / blockSize) : 0);
+
+    std::vector<std::string> compressed(frames);
+
+    const int nThreads(resolveThreads(options.nThreads));
+    const auto nf(std::int64_t(frames));
+
+    UTILITY_OMP(parallel for schedule(dynamic) num_threads(nThreads))
+    for (std::int64_t i = 0; i < nf; ++i) {
+        const auto begin(std::size_t(i) * blockSize);
+        const auto length(std::min(blockSize, size - begin));
+        compressed[i] = compressFrame(data + begin, length, options.level);
+    }
+
+    bin::write(out, ZSTD_BLOCKS_MAGIC);
+    bin::write(out, std::uint32_t(VERSION));
+    bin::write(out, std::uint32_t(blockSize));
+    bin::write(out, std::uint64_t(size));
+    bin::write(out, std::uint32_t(frames));
+    for (const auto &frame : compressed) {
+        bin::write(out, std::uint32_t(frame.size()));
+    }
+    for (const auto &frame : compressed) {
+        out.write(frame.data(), frame.size());
+    }
+}
+
+std::string readZstdBlocks(std::istream &in
+                           , const boost::filesystem::path &path)
+{
+    return readBlocks(in, path
+                      , std::numeric_limits<std::uint64_t>::max(), 0);
+}
+
+std::string readZstdBlocksPrefix(std::istream &in, std::size_t size
+                                 , const boost::filesystem::path &path)
+{
+    // a prefix spans a frame or two -> no point spinning up workers
+    return readBlocks(in, path, size, 1);
+}
+
+#else // BOOST_VERSION >= 107000
+
+void writeZstdBlocks(std::ostream&, const char*, std::size_t
+                     , const ZstdBlocksOptions&)
+{
+    LOGTHROW(err2, std::runtime_error)
+        << "Zstd support requires Boost >= 1.70.";
+}
+
+std::string readZstdBlocks(std::istream&, const boost::filesystem::path&)
+{
+    LOGTHROW(err2, std::runtime_error)
+        << "Zstd support requires Boost >= 1.70.";
+    throw;
+}
+
+std::string readZstdBlocksPrefix(std::istream&, std::size_t
+                                 , const boost::filesystem::path&)
+{
+    LOGTHROW(err2, std::runtime_error)
+        << "Zstd support requires Boost >= 1.70.";
+    throw;
+}
+
+#endif // BOOST_VERSION >= 107000
+
+} // namespace geometry
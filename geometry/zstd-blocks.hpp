@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/** Zstd block container: raw data cut into fixed-size blocks, every
+ *  block compressed into an independent zstd frame, frame sizes kept in
+ *  an index up front. Independent frames compress and decompress in
+ *  parallel and a reader interested only in a prefix of the raw data
+ *  (typically a fixed-size header) decodes just the first frame.
+ */
+
+#ifndef geometry_zstd_blocks_hpp_included_
+#define geometry_zstd_blocks_hpp_included_
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+
+#include "utility/gccversion.hpp"
+
+namespace geometry {
+
+/** Container magic; first 8 bytes of every container.
+ */
+const char ZSTD_BLOCKS_MAGIC[8] = {'Z', 'S', 'T', 'D', '.', 'B', 'L', 'K'};
+
+/** Tuning knobs for the zstd block container.
+ */
+struct ZstdBlocksOptions {
+    /** Raw bytes per frame. */
+    std::size_t blockSize;
+
+    /** Zstd compression level. */
+    int level;
+
+    /** Worker thread count; 0 means all hardware threads. */
+    int nThreads;
+
+    ZstdBlocksOptions() : blockSize(1 << 20), level(19), nThreads(0) {}
+};
+
+/** Writes data as a zstd block container; frames are compressed by a
+ *  worker pool.
+ */
+void writeZstdBlocks(std::ostream &out, const char *data, std::size_t size
+                     , const ZstdBlocksOptions &options = ZstdBlocksOptions())
+#ifndef GEOMETRY_HAS_BIO
+    UTILITY_FUNCTION_ERROR("Zstd support is available only when compiled with Boost.IOStreams.")
+#endif
+    ;
+
+/** Reads a whole zstd block container; frames are decompressed by a
+ *  worker pool.
+ * \param path used only for logging
+ */
+std::string readZstdBlocks(std::istream &in
+                           , const boost::filesystem::path &path = "unknown")
+#ifndef GEOMETRY_HAS_BIO
+    UTILITY_FUNCTION_ERROR("Zstd support is available only when compiled with Boost.IOStreams.")
+#endif
+    ;
+
+/** Reads the first size raw bytes from a zstd block container, decoding
+ *  only the frames that cover them. Returns less when the container
+ *  holds less.
+ * \param path used only for logging
+ */
+std::string readZstdBlocksPrefix(std::istream &in, std::size_t size
+                                 , const boost::filesystem::path &path
+                                 = "unknown")
+#ifndef GEOMETRY_HAS_BIO
+    UTILITY_FUNCTION_ERROR("Zstd support is available only when compiled with Boost.IOStreams.")
+#endif
+    ;
+
+} // namespace geometry
+
+#endif // geometry_zstd_blocks_hpp_included_